@@ -20,15 +20,20 @@ struct Region
     float blendStrength;
     float startHeight;
     vec4 tint;              ///< rgb: tint, a: tintStrength
+    vec4 moisture;          ///< xy: moisture range the region grows in
 };
 
 uniform sampler2DArray texArray;
+uniform sampler2D channelMap;   ///< rgb: temperature, moisture, detail
 
 layout(binding=1) uniform TerrainUBO {
     float minHeight;
     float maxHeight;
     int regionCount;
-    float __pad;
+    int useChannels;
+    float temperatureShift; ///< Height shift of the regions per unit of cold
+    float detailStrength;   ///< Height shift of the regions by the detail mask
+    vec2 __pad;
     Region regions[REGION_MAX_COUNT];
 } terrain;
 
@@ -83,7 +88,13 @@ void main()
     vec3 blendAxis = abs(inNormal);
     blendAxis /= blendAxis.x + blendAxis.y + blendAxis.z;
 
-    const float kHeightPercent = InverseLerp(terrain.minHeight, terrain.maxHeight, inPos.y);
+    // Cold regions take the regions of higher altitudes, the detail mask
+    //  breaks up the region borders
+    const vec3 kChannels = terrain.useChannels != 0 ? texture(channelMap, inUV).rgb
+                                                    : vec3(0.5);
+    const float kHeightPercent = InverseLerp(terrain.minHeight, terrain.maxHeight, inPos.y)
+                               + (0.5 - kChannels.r) * terrain.temperatureShift
+                               + (kChannels.b - 0.5) * terrain.detailStrength;
 
     vec3 color = vec3(0);
     const int kRegionCount = min(terrain.regionCount, REGION_MAX_COUNT);
@@ -97,9 +108,17 @@ void main()
         const vec3 kBaseColor = mix(kTextureColor, region.tint.rgb, region.tint.a);
 
         const float kBlendStrengthHalf = region.blendStrength/2;
+        // Outside of its moisture range the region below shows through
+        const float kMoistureWeight =
+            InverseLerp(region.moisture.x - kBlendStrengthHalf - EPSILON,
+                        region.moisture.x, kChannels.g) *
+            (1.0 - InverseLerp(region.moisture.y,
+                               region.moisture.y + kBlendStrengthHalf + EPSILON,
+                               kChannels.g));
         const float kWeight = InverseLerp(-kBlendStrengthHalf - EPSILON,
                                            kBlendStrengthHalf,
-                                           kHeightPercent - region.startHeight);
+                                           kHeightPercent - region.startHeight)
+                            * kMoistureWeight;
         color = mix(color, kBaseColor, kWeight);
     }
 
@@ -9,14 +9,73 @@ layout(location = 1) out vec3 outNormal;
 layout(location = 2) out vec2 outUV;
 
 uniform mat4 MVP;
+// Instances per side of the grid of periodic tiles, 1 draws the tile once
+uniform int tileInstances;
+// World size of a tile, the offset between the instances
+uniform vec2 tileSize;
+
+// The mesh is the unscaled grid, vertices one unit apart and the heights of
+//  the map, see Terrain::GenerateVertices
+uniform float tileScale;
+uniform float heightScale;
+// Vertices per side of the drawn grid
+uniform vec2 gridSize;
+uniform int useFallOff;
+uniform vec2 fallOffEdges;
+
+// Lowers the heights towards the edges, the normals follow its slope
+void ApplyFallOff(inout float height, inout vec2 slope)
+{
+    // Distance from the center like the former falloff map of the samples
+    const vec2 kDist = inUV * (gridSize - 1.0) / gridSize * 2.0 - 1.0;
+    const vec2 kAbsDist = abs(kDist);
+    const float kWidth = fallOffEdges.y - fallOffEdges.x;
+    const float t = clamp((max(kAbsDist.x, kAbsDist.y) - fallOffEdges.x) / kWidth,
+                          0.0, 1.0);
+
+    height -= t * t * (3.0 - 2.0 * t);
+    if (height <= 0.0 || height >= 1.0)
+    {
+        // Flat where clamped
+        height = clamp(height, 0.0, 1.0);
+        slope = vec2(0.0);
+        return;
+    }
+
+    // Derivative of the smoothstep per vertex, the distance to the edge
+    //  changes only along the dominant axis
+    const float kDeriv = 6.0 * t * (1.0 - t) / kWidth;
+    if (kAbsDist.x >= kAbsDist.y)
+        slope.x -= kDeriv * sign(kDist.x) * 2.0 / gridSize.x;
+    else
+        slope.y -= kDeriv * sign(kDist.y) * 2.0 / gridSize.y;
+}
 
 void main()
 {
-    const vec4 kWorldPos = MVP * vec4(inPos, 1.0);
+    // Height change per vertex, the normals of a height map point up
+    vec2 slope = -inNormal.xz / inNormal.y;
+    float height = inPos.y;
+    if (useFallOff != 0)
+        ApplyFallOff(height, slope);
+
+    // Normals transform with the inverse scale, which keeps the slope in
+    //  world units
+    const vec3 kNormal = normalize(vec3(-slope.x * heightScale / tileScale, 1.0,
+                                        -slope.y * heightScale / tileScale));
+
+    // Grid of instances centered at the origin
+    const int kCount = max(tileInstances, 1);
+    const vec2 kCell = vec2(gl_InstanceID % kCount, gl_InstanceID / kCount);
+    const vec2 kOffset = (kCell - 0.5 * float(kCount - 1)) * tileSize;
+    const vec3 kPos = vec3(inPos.x * tileScale, height * heightScale, inPos.z * tileScale)
+                    + vec3(kOffset.x, 0.0, kOffset.y);
+
+    const vec4 kWorldPos = MVP * vec4(kPos, 1.0);
     gl_Position = kWorldPos;
 
     // TODO model
-    outPos = inPos.xyz;
-    outNormal = inNormal;
+    outPos = kPos;
+    outNormal = kNormal;
     outUV = inUV;
 }
@@ -0,0 +1,196 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "AutoTuner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "JobSystem.h"
+#include "scene/ProceduralTexture2D.h"
+#include "scene/Terrain.h"
+
+
+static constexpr uint32_t s_kRuns = 3;  ///< Per candidate, the fastest counts
+
+// Narrow tiles keep a row batch in L1, wide ones amortize the row setup
+static const glm::uvec2 s_kTileSizes[] = {
+    { 32, 32 }, { 64, 16 }, { 64, 64 }, { 128, 8 }, { 128, 32 },
+    { 256, 4 }, { 256, 16 }, { 0, 0 }
+};
+static const uint32_t s_kVerticesPerTask[] = { 4096, 16384, 65536, 262144 };
+
+/** @return 0, the powers of two below the thread count and the count itself */
+static std::vector<uint32_t> GetWorkerCounts(uint32_t hardwareThreads)
+{
+    std::vector<uint32_t> counts{ 0 };
+    for (uint32_t count = 1; count < hardwareThreads - 1; count *= 2)
+        counts.push_back(count);
+
+    // The waiting thread executes tasks too
+    for (const uint32_t kCount : { hardwareThreads - 1, hardwareThreads })
+        if (kCount > counts.back())
+            counts.push_back(kCount);
+    return counts;
+}
+
+// =============================================================================
+
+AutoTuner::Config AutoTuner::Calibrate(const ProceduralTexture2D& noiseMap,
+                                       const glm::uvec2& size)
+{
+    JobSystem& jobs = JobSystem::Get();
+    const uint32_t kWorkerCount = jobs.GetWorkerCount();
+
+    Config config;
+    config.tileSize = noiseMap.GetTileSize();
+    config.mapSize = size;
+    config.hardwareThreads = std::max(std::thread::hardware_concurrency(), 1U);
+
+    // The noise kernels are timed, not the hits of the layer cache
+    ProceduralTexture2D noise(size.x, size.y);
+    noise.CopySettings(noiseMap);
+    noise.SetLayerCacheMode(ProceduralTexture2D::LayerCacheMode::Off);
+    noise.TimeGeneration(1);
+
+    std::unique_ptr<Terrain> terrain = Terrain::CreateUniq(size, noise.GetValues());
+    terrain->SetGradientMap(&noise.GetGradients());
+
+    const auto kTimeMesh = [&terrain]() {
+        double fastest = std::numeric_limits<double>::max();
+        for (uint32_t i = 0; i < s_kRuns; ++i)
+        {
+            const auto kStart = std::chrono::steady_clock::now();
+            terrain->GenerateMesh();
+            const std::chrono::duration<double, std::milli> kDuration =
+                std::chrono::steady_clock::now() - kStart;
+            fastest = std::min(fastest, kDuration.count());
+        }
+        return fastest;
+    };
+
+    double fastest = std::numeric_limits<double>::max();
+    for (const uint32_t kWorkers : GetWorkerCounts(config.hardwareThreads))
+    {
+        jobs.SetWorkerCount(kWorkers);
+        const double kDuration = noise.TimeGeneration(s_kRuns) + kTimeMesh();
+        if (kDuration < fastest)
+        {
+            fastest = kDuration;
+            config.workerCount = kWorkers;
+        }
+    }
+    jobs.SetWorkerCount(config.workerCount);
+
+    config.noiseMs = std::numeric_limits<double>::max();
+    for (const glm::uvec2& kTileSize : s_kTileSizes)
+    {
+        noise.SetTileSize(kTileSize);
+        const double kDuration = noise.TimeGeneration(s_kRuns);
+        if (kDuration < config.noiseMs)
+        {
+            config.noiseMs = kDuration;
+            config.tileSize = kTileSize;
+        }
+    }
+
+    config.meshMs = std::numeric_limits<double>::max();
+    for (const uint32_t kVertices : s_kVerticesPerTask)
+    {
+        terrain->SetVerticesPerTask(kVertices);
+        const double kDuration = kTimeMesh();
+        if (kDuration < config.meshMs)
+        {
+            config.meshMs = kDuration;
+            config.verticesPerTask = kVertices;
+        }
+    }
+
+    jobs.SetWorkerCount(kWorkerCount);
+    config.valid = true;
+    return config;
+}
+
+std::string AutoTuner::GetDefaultPath()
+{
+    static constexpr auto s_kFileName = "autotune.cfg";
+
+    std::filesystem::path directory;
+#ifdef _WIN32
+    if (const char* kAppData = std::getenv("APPDATA"))
+        directory = kAppData;
+#else
+    if (const char* kConfigHome = std::getenv("XDG_CONFIG_HOME"); kConfigHome && *kConfigHome)
+        directory = kConfigHome;
+    else if (const char* kHome = std::getenv("HOME"))
+        directory = std::filesystem::path(kHome) / ".config";
+#endif
+    if (directory.empty())
+        return s_kFileName;
+    return (directory / "terrain" / s_kFileName).string();
+}
+
+bool AutoTuner::Load(const std::string& path, Config& config)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    Config loaded;
+    std::string key;
+    while (file >> key)
+    {
+        if (key == "workerCount")
+            file >> loaded.workerCount;
+        else if (key == "tileSize")
+            file >> loaded.tileSize.x >> loaded.tileSize.y;
+        else if (key == "verticesPerTask")
+            file >> loaded.verticesPerTask;
+        else if (key == "noiseMs")
+            file >> loaded.noiseMs;
+        else if (key == "meshMs")
+            file >> loaded.meshMs;
+        else if (key == "mapSize")
+            file >> loaded.mapSize.x >> loaded.mapSize.y;
+        else if (key == "hardwareThreads")
+            file >> loaded.hardwareThreads;
+        else // Comments and unknown keys
+            file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+
+    // A malformed value stops the loop before the end
+    if (!file.eof() ||
+        loaded.hardwareThreads != std::max(std::thread::hardware_concurrency(), 1U))
+        return false;
+
+    loaded.valid = true;
+    config = loaded;
+    return true;
+}
+
+bool AutoTuner::Save(const std::string& path, const Config& config)
+{
+    const std::filesystem::path kDirectory = std::filesystem::path(path).parent_path();
+    std::error_code error;
+    if (!kDirectory.empty())
+        std::filesystem::create_directories(kDirectory, error);
+
+    std::ofstream file(path);
+    file << "# Written by the calibration, delete it to calibrate again\n"
+         << "workerCount " << config.workerCount << '\n'
+         << "tileSize " << config.tileSize.x << ' ' << config.tileSize.y << '\n'
+         << "verticesPerTask " << config.verticesPerTask << '\n'
+         << "noiseMs " << config.noiseMs << '\n'
+         << "meshMs " << config.meshMs << '\n'
+         << "mapSize " << config.mapSize.x << ' ' << config.mapSize.y << '\n'
+         << "hardwareThreads " << config.hardwareThreads << '\n';
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,56 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <string>
+
+#include <glm/glm.hpp>
+
+class ProceduralTexture2D;
+
+
+/**
+ * @brief Picks the worker count of the job system, the tile size of the noise
+ *  and the task grain of the mesh by timing the generation on this machine.
+ *  The values do not depend on them, only the throughput does.
+ */
+class AutoTuner
+{
+public:
+    struct Config
+    {
+        uint32_t workerCount{ 0 };
+        glm::uvec2 tileSize{ 256, 16 };     ///< See ProceduralTexture2D::SetTileSize
+        uint32_t verticesPerTask{ 65536 };  ///< See Terrain::SetVerticesPerTask
+
+        double noiseMs{ 0.0 };  ///< Of the calibration map with the config
+        double meshMs{ 0.0 };
+        glm::uvec2 mapSize{ 0 };            ///< Of the calibration map
+        uint32_t hardwareThreads{ 0 };      ///< Of the machine calibrated on
+        bool valid{ false };
+    };
+
+    /**
+     * @brief Times the noise with the settings of noiseMap and the mesh for
+     *  maps of the size, first across the worker counts, then across the
+     *  tile sizes and the grains with the fastest count. Runs on the calling
+     *  thread, about a second for a 1024x1024 map on one core, the worker
+     *  count is restored.
+     */
+    static Config Calibrate(const ProceduralTexture2D& noiseMap, const glm::uvec2& size);
+
+    /**
+     * @return autotune.cfg in the configuration directory of the user,
+     *  %APPDATA%/terrain on Windows, $XDG_CONFIG_HOME/terrain or
+     *  ~/.config/terrain elsewhere, the working directory without them
+     */
+    static std::string GetDefaultPath();
+
+    /** @return False if the file is missing, invalid or of another machine */
+    static bool Load(const std::string& path, Config& config);
+    /** @brief Creates the directory of the path first */
+    static bool Save(const std::string& path, const Config& config);
+};
@@ -0,0 +1,145 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#include "scene/ProceduralTexture2D.h"
+#include "scene/Terrain.h"
+
+
+static constexpr uint32_t s_kRuns = 3;  ///< Per path, the fastest counts
+static constexpr size_t s_kSampleCount = 1 << 20;
+
+/** @return Fastest of the runs of NoiseN over the samples, in ms */
+template <typename Noise>
+static double TimeNoiseN(const Noise& noise, const std::vector<float>& xs,
+                         const std::vector<float>& ys, std::vector<float>& out)
+{
+    double fastest = std::numeric_limits<double>::max();
+    for (uint32_t i = 0; i < s_kRuns; ++i)
+    {
+        const auto kStart = std::chrono::steady_clock::now();
+        noise.NoiseN(xs.data(), ys.data(), out.data(), xs.size());
+        const std::chrono::duration<double, std::milli> kDuration =
+            std::chrono::steady_clock::now() - kStart;
+        fastest = std::min(fastest, kDuration.count());
+    }
+    return fastest;
+}
+
+// =============================================================================
+
+std::vector<Benchmark::Result> Benchmark::TimeEvaluationModes(const ProceduralTexture2D& noiseMap,
+                                                              const glm::uvec2& size)
+{
+    using Dimension = ProceduralTexture2D::NoiseDimension;
+    using Mode = ProceduralTexture2D::EvaluationMode;
+    static const char* kModeNames[] = { "per sample", "batch", "row", "split cell" };
+
+    // The noise kernels are timed, not the hits of the layer cache
+    ProceduralTexture2D noise(size.x, size.y);
+    noise.CopySettings(noiseMap);
+    noise.SetLayerCacheMode(ProceduralTexture2D::LayerCacheMode::Off);
+
+    std::vector<Result> results;
+    for (const Dimension kDimension : { Dimension::Noise2D, Dimension::Noise3D })
+    {
+        noise.SetNoiseDimension(kDimension);
+        for (const Mode kMode : { Mode::PerSample, Mode::Batch, Mode::Row, Mode::Split })
+        {
+            noise.SetEvaluationMode(kMode);
+            results.push_back({ std::string(kDimension == Dimension::Noise2D ? "2D " : "3D ") +
+                                    kModeNames[static_cast<int>(kMode)],
+                                noise.TimeGeneration(s_kRuns) });
+        }
+    }
+    return results;
+}
+
+std::vector<Benchmark::Result> Benchmark::TimeBases(const ProceduralTexture2D& noiseMap,
+                                                    const glm::uvec2& size)
+{
+    static const char* kBasisNames[] = { "Perlin", "Simplex", "Worley" };
+
+    // Spread over the lattice period, a few samples per cell
+    std::vector<float> xs(s_kSampleCount), ys(s_kSampleCount), out(s_kSampleCount);
+    for (size_t i = 0; i < s_kSampleCount; ++i)
+    {
+        xs[i] = static_cast<float>(i % 1024) * 0.25f;
+        ys[i] = static_cast<float>(i / 1024) * 0.25f;
+    }
+
+    PerlinNoise<float> perlin(noiseMap.GetSeed());
+    SimplexNoise<float> simplex(noiseMap.GetSeed());
+    WorleyNoise<float> worley(noiseMap.GetSeed());
+
+    std::vector<Result> results;
+    const int kBest = static_cast<int>(PerlinSIMD::GetBestISA());
+    for (int isa = static_cast<int>(PerlinSIMD::ISA::Scalar); isa <= kBest; ++isa)
+    {
+        const PerlinSIMD::ISA kISA = static_cast<PerlinSIMD::ISA>(isa);
+        perlin.SetISA(kISA);
+        simplex.SetISA(kISA);
+        worley.SetISA(kISA);
+
+        const std::string kSuffix = std::string(" NoiseN 1M, ") + PerlinSIMD::GetISAName(kISA);
+        results.push_back({ kBasisNames[0] + kSuffix, TimeNoiseN(perlin, xs, ys, out) });
+        results.push_back({ kBasisNames[1] + kSuffix, TimeNoiseN(simplex, xs, ys, out) });
+        results.push_back({ kBasisNames[2] + kSuffix, TimeNoiseN(worley, xs, ys, out) });
+    }
+
+    ProceduralTexture2D noise(size.x, size.y);
+    noise.CopySettings(noiseMap);
+    noise.SetLayerCacheMode(ProceduralTexture2D::LayerCacheMode::Off);
+    for (const NoiseBasis kBasis : { NoiseBasis::Perlin, NoiseBasis::Simplex, NoiseBasis::Worley })
+    {
+        noise.SetNoiseBasis(kBasis);
+        results.push_back({ std::string(kBasisNames[static_cast<int>(kBasis)]) + " map",
+                            noise.TimeGeneration(s_kRuns) });
+    }
+    return results;
+}
+
+std::vector<Benchmark::Result> Benchmark::TimeMesh(const ProceduralTexture2D& noiseMap,
+                                                   const glm::uvec2& size)
+{
+    ProceduralTexture2D noise(size.x, size.y);
+    noise.CopySettings(noiseMap);
+    noise.SetLayerCacheMode(ProceduralTexture2D::LayerCacheMode::Off);
+    noise.SetGenerateGradients(true);
+    noise.TimeGeneration(1);
+
+    std::unique_ptr<Terrain> terrain = Terrain::CreateUniq(size, noise.GetValues());
+
+    std::vector<Result> results;
+    for (const bool kGradients : { false, true })
+    {
+        terrain->SetGradientMap(kGradients ? &noise.GetGradients() : nullptr);
+
+        Result result{ kGradients ? "Mesh, gradient normals" : "Mesh, face normals",
+                       std::numeric_limits<double>::max() };
+        for (uint32_t i = 0; i < s_kRuns; ++i)
+        {
+            const auto kStart = std::chrono::steady_clock::now();
+            terrain->GenerateMesh();
+            terrain->UpdateVAO();
+            const std::chrono::duration<double, std::milli> kDuration =
+                std::chrono::steady_clock::now() - kStart;
+            result.ms = std::min(result.ms, kDuration.count());
+        }
+
+        for (const Terrain::StageTraffic& kTraffic : terrain->GetMemoryTraffic())
+        {
+            result.bytesRead += kTraffic.bytesRead;
+            result.bytesWritten += kTraffic.bytesWritten;
+        }
+        results.push_back(result);
+    }
+    return results;
+}
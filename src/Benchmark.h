@@ -0,0 +1,49 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class ProceduralTexture2D;
+
+
+/**
+ * @brief Times the alternative paths of the generation against each other on
+ *  this machine, with the settings of the noise map and the worker count set.
+ *  Runs on the calling thread and blocks for a few seconds, see AutoTuner for
+ *  the timings the configuration is picked from.
+ */
+class Benchmark
+{
+public:
+    struct Result
+    {
+        std::string name;
+        double ms{ 0.0 };   ///< Fastest of the runs
+        /** @brief By the stages of the mesh, see Terrain::GetMemoryTraffic */
+        uint64_t bytesRead{ 0 };
+        uint64_t bytesWritten{ 0 };
+    };
+
+    /** @brief Generation of maps of the size by each evaluation mode, 2D and 3D */
+    static std::vector<Result> TimeEvaluationModes(const ProceduralTexture2D& noiseMap,
+                                                   const glm::uvec2& size);
+    /**
+     * @brief Batch evaluation of 1M 2D samples by each basis and instruction
+     *  set, then the generation of maps of the size by each basis
+     */
+    static std::vector<Result> TimeBases(const ProceduralTexture2D& noiseMap,
+                                         const glm::uvec2& size);
+    /**
+     * @brief Mesh generation and upload of maps of the size, the normals
+     *  from the faces and from the gradients. Needs the OpenGL context.
+     */
+    static std::vector<Result> TimeMesh(const ProceduralTexture2D& noiseMap,
+                                        const glm::uvec2& size);
+};
@@ -13,6 +13,9 @@ static void HelpMarker(const char* desc);
 static void ShowTexture(uint32_t texture_id, const glm::uvec2& texSize, 
                               const float w, const float h);
 
+/** @return True if the graph was edited */
+static bool ShowNoiseGraphEditor(NoiseGraph& graph);
+
 void ProceduralTerrain::ShowInterface()
 {
     if (!ImGui::Begin("Procedural Terrain Controls", NULL))
@@ -28,6 +31,44 @@ void ProceduralTerrain::ShowInterface()
             m_Window->SetVSync(vsync);
 
         ImGui::Checkbox(" Wireframe", &m_RenderWireframe);
+
+        bool triangleStrips = m_Terrain->GetUseTriangleStrips();
+        // The back terrain and the preview copy it with the settings
+        if (ImGui::Checkbox(" Triangle strips", &triangleStrips))
+            m_Terrain->UseTriangleStrips(triangleStrips);
+        HelpMarker("Draws the rows of quads as strips with primitive restart "
+                   "instead of a list of triangles, the same triangles from "
+                   "a third of the indices");
+
+        // Read back every frame, the calibration sets it too
+        int workerCount = static_cast<int>(JobSystem::Get().GetWorkerCount());
+        const int kMaxWorkerCount = static_cast<int>(
+            glm::max(std::thread::hardware_concurrency(), 1U)) * 2;
+        if (ImGui::SliderInt(" Worker threads", &workerCount, 0, kMaxWorkerCount))
+            SetWorkerCount(static_cast<uint32_t>(workerCount));
+        HelpMarker("Threads of the job system generating the noise and the "
+                   "terrain, 0 runs everything on the main thread");
+        int verticesPerTask = static_cast<int>(m_Terrain->GetVerticesPerTask());
+        if (ImGui::DragInt(" Vertices per task", &verticesPerTask, 256.0f, 1, 1 << 20))
+            m_Terrain->SetVerticesPerTask(static_cast<uint32_t>(verticesPerTask));
+        HelpMarker("Grain of the terrain mesh tasks, the mesh does not depend "
+                   "on it");
+        if (ImGui::Checkbox(" Background generation", &m_AsyncGeneration) &&
+            !m_AsyncGeneration)
+            CancelGeneration();
+        HelpMarker("Generates the noise map and the terrain on a worker while "
+                   "the previous ones are rendered, newer settings cancel the "
+                   "running generation. Without worker threads it runs on the "
+                   "main thread in slices of the frame budget, the compute "
+                   "shader backend generates on the render thread");
+        ImGui::SliderFloat(" Frame budget (ms)", &m_FrameBudget, 0.5f, 16.0f, "%.1f");
+        HelpMarker("Time given to the background generation each frame when "
+                   "there are no worker threads");
+        ImGui::Checkbox(" Progressive preview", &m_ProgressivePreview);
+        HelpMarker("While a setting is dragged, the terrain shows the noise at "
+                   "1/8 and then 1/4 of the resolution first. Each level keeps "
+                   "the samples of the previous one, and so does the full one "
+                   "in the batch and per-sample modes");
     }
 
     if (ImGui::CollapsingHeader("Camera Settings"))
@@ -71,57 +112,89 @@ void ProceduralTerrain::ShowInterface()
         {
             static bool optionsChanged = false;
             static bool autoUpdate = false;
-            static bool useFallOffMap = false;
             
             static int terrainSize = m_Terrain->GetSize().x;
             static int terrainLastSize = terrainSize;
-            static float tileScale = m_Terrain->GetTileScale();
-            static float heightScale = m_Terrain->GetHeightScale();
-            static float edge0 = m_Terrain->GetFallOffMapEdge0();
-            static float edge1 = m_Terrain->GetFallOffMapEdge1();
+            static int instanceGrid = static_cast<int>(m_Terrain->GetInstanceGrid());
+
+            float tileScale = m_Terrain->GetTileScale();
+            float heightScale = m_Terrain->GetHeightScale();
+            bool useFallOffMap = m_Terrain->GetUseFallOffMap();
+            float edge0 = m_Terrain->GetFallOffMapEdge0();
+            float edge1 = m_Terrain->GetFallOffMapEdge1();
 
             // (?) Resizes the terrain along with its height map
             optionsChanged |= ImGui::SliderInt("Terrain size", &terrainSize, 4, 2048);
-            // (?) Scales the size of a terrain tile
-            optionsChanged |= ImGui::SliderFloat("Tile scale", &tileScale, 0.01f, 1.f);
-            // (?) Scales the height values of terrain's height map
-            optionsChanged |= ImGui::SliderFloat("Height scale", &heightScale, 1.f, 32.f);
-            optionsChanged |= ImGui::Checkbox(" Use Falloff Map", &useFallOffMap);
+
+            // Applied by the vertex shader, the mesh stays
+            if (ImGui::SliderFloat("Tile scale", &tileScale, 0.01f, 1.f))
+                m_Terrain->SetTileScale(tileScale);
+            HelpMarker("Scales the size of a terrain tile");
+            if (ImGui::SliderFloat("Height scale", &heightScale, 1.f, 32.f))
+            {
+                m_Terrain->SetHeightScale(heightScale);
+                m_TerrainChanged = true;    // Height range of the regions
+            }
+            HelpMarker("Scales the height values of terrain's height map");
+            if (ImGui::Checkbox(" Use Falloff Map", &useFallOffMap))
+                m_Terrain->UseFallOffMap(useFallOffMap);
             if (useFallOffMap)
             {
-                optionsChanged |=
-                    ImGui::SliderFloat("Edge0", &edge0, 0.f, edge1-0.01);
-                optionsChanged |=
-                    ImGui::SliderFloat("Edge1", &edge1, edge0+0.01, 2.f);
+                if (ImGui::SliderFloat("Edge0", &edge0, 0.f, edge1-0.01))
+                    m_Terrain->SetFallOffMapEdge0(edge0);
+                if (ImGui::SliderFloat("Edge1", &edge1, edge0+0.01, 2.f))
+                    m_Terrain->SetFallOffMapEdge1(edge1);
             }
 
+            // Drawn every frame, not part of the generated mesh
+            if (ImGui::SliderInt("Tile instances", &instanceGrid, 1, 8))
+                m_Terrain->SetInstanceGrid(static_cast<uint32_t>(instanceGrid));
+            HelpMarker("Draws a grid of copies of the terrain sharing its "
+                       "vertex and index buffers. Seamless with periodic "
+                       "noise, the falloff map breaks the seams");
+
             ImGui::NewLine();
             const bool kGeneratePressed = ImGui::Button("Generate");
 
             // TODO if noiseMapChanged as well
             if ( optionsChanged && (kGeneratePressed || autoUpdate) )
             {
-                if (terrainSize != terrainLastSize)
+                m_TerrainSize = glm::uvec2(terrainSize, terrainSize);
+
+                if (UseAsyncGeneration())
+                    RequestGeneration(false, true, ImGui::IsAnyItemActive());
+                else
                 {
-                    m_NoiseMap->SetSize(glm::uvec2(terrainSize, terrainSize));
-                    m_NoiseMap->GenerateValues();
-                    m_Terrain->SetSize(glm::uvec2(terrainSize, terrainSize));
+                    CancelGeneration();
+                    if (terrainSize != terrainLastSize)
+                    {
+                        m_NoiseMap->SetSize(m_TerrainSize);
+                        m_NoiseMap->GenerateValues();
+                        m_Terrain->SetSize(m_TerrainSize);
+                    }
 
-                    terrainLastSize = terrainSize;
+                    m_NoiseMap->ReadBackValues();
+                    GenerateTerrainMesh(*m_Terrain, *m_NoiseMap);
+                    m_Terrain->UpdateVAO();
+                    m_TerrainChanged = true;
                 }
 
-                m_Terrain->SetTileScale(tileScale);
-                m_Terrain->SetHeightScale(heightScale);
-                m_Terrain->UseFallOffMap(useFallOffMap);
-                m_Terrain->SetFallOffMapEdge0(edge0);
-                m_Terrain->SetFallOffMapEdge1(edge1);
-                m_Terrain->Generate();
-
+                terrainLastSize = terrainSize;
                 optionsChanged = false;
-                m_TerrainChanged = true;
             }
             ImGui::SameLine();
             ImGui::Checkbox("Auto", &autoUpdate);
+
+            static int normalsParity = -1;
+            if (ImGui::Button("Check normals"))
+                normalsParity = m_Terrain->CheckNormals() ? 1 : 0;
+            HelpMarker("Compares the normals gathered per vertex with the ones "
+                       "scattered over the triangles of the index buffer");
+            if (normalsParity >= 0)
+            {
+                ImGui::SameLine();
+                ImGui::Text("%s", normalsParity ? "Identical" : "Gather and scatter differ");
+            }
         }
         ImGui::Separator();
 
@@ -130,18 +203,181 @@ void ProceduralTerrain::ShowInterface()
             static bool optionsChanged = false;
             static float scale = m_NoiseMap->GetScale();
             static int32_t seed = m_NoiseMap->GetSeed();
-            static float offset = m_NoiseMap->GetOffset();
+            static glm::vec3 offset = m_NoiseMap->GetOffset();
             static int octaves = m_NoiseMap->GetOctaves();
             static float gain = m_NoiseMap->GetGain();
             static float lacunarity = m_NoiseMap->GetLacunarity();
+            static int dimension = static_cast<int>(m_NoiseMap->GetNoiseDimension());
+            static int basis = static_cast<int>(m_NoiseMap->GetNoiseBasis());
+            static int cellFunction = static_cast<int>(m_NoiseMap->GetCellFunction());
+            static int cellDistance = static_cast<int>(m_NoiseMap->GetCellDistance());
+            static bool analyticNormals = m_NoiseMap->GetGenerateGradients();
+            static int evaluation = static_cast<int>(m_NoiseMap->GetEvaluationMode());
+            glm::ivec2 tileSize = m_NoiseMap->GetTileSize();
+            static int layerCache = static_cast<int>(m_NoiseMap->GetLayerCacheMode());
+            static int layerCacheBudget = static_cast<int>(m_NoiseMap->GetLayerCacheBudget());
+            static int octavePrecision = static_cast<int>(m_NoiseMap->GetOctavePrecision());
+            static float targetSpacing = m_NoiseMap->GetTargetSpacing();
+            static bool generateChannels = m_NoiseMap->GetGenerateChannels();
+            static int channelOctaves[ProceduralTexture2D::CHANNEL_COUNT] = {
+                m_NoiseMap->GetChannelOctaves(ProceduralTexture2D::Channel::Temperature),
+                m_NoiseMap->GetChannelOctaves(ProceduralTexture2D::Channel::Moisture),
+                m_NoiseMap->GetChannelOctaves(ProceduralTexture2D::Channel::Detail)
+            };
+            static int backend = static_cast<int>(m_NoiseMap->GetBackend());
+            static bool periodic = m_NoiseMap->GetPeriodic();
+            static int tilePeriod = static_cast<int>(m_NoiseMap->GetTilePeriod());
+            static bool useNoiseGraph = m_NoiseMap->GetUseNoiseGraph();
+            static NoiseGraph noiseGraph = m_NoiseMap->GetNoiseGraph();
 
             optionsChanged |= ImGui::DragInt("Seed", &seed);
             optionsChanged |= ImGui::DragFloat("Scale", &scale, 0.1f, 0.001f);
-            optionsChanged |= ImGui::DragFloat("Offset", &offset, 1.0f, -10000.f, 10000.f);
+            optionsChanged |= ImGui::DragFloat3("Offset", &offset.x, 1.0f, -10000.f, 10000.f, "%.0f");
+            HelpMarker("Offset of the samples along x, y and z, z only moves "
+                       "the 3D noise. Panning along x and y by whole samples "
+                       "moves the previous values, only the exposed rows and "
+                       "columns are evaluated");
             // TODO (?)
             optionsChanged |= ImGui::SliderInt("Octaves", &octaves, 1, 32);
             optionsChanged |= ImGui::DragFloat("Gain (Persistence)", &gain, 0.01f, 0.f, 1.f);
             optionsChanged |= ImGui::DragFloat("Lacunarity", &lacunarity, 0.01f, 1.f, 100.f);
+            static const char* kOctavePrecisions[] = { "Exact", "16-bit", "8-bit" };
+            optionsChanged |= ImGui::Combo("Octave precision", &octavePrecision,
+                                           kOctavePrecisions, IM_ARRAYSIZE(kOctavePrecisions));
+            HelpMarker("Drops the octaves whose amplitudes cannot change the "
+                       "height by half a step of the precision");
+            optionsChanged |= ImGui::DragFloat("Target spacing", &targetSpacing,
+                                               0.05f, 0.f, 64.f);
+            HelpMarker("Octaves with a wavelength below twice the spacing, in "
+                       "samples, fade out, 0 keeps all of them");
+            // 3D samples the z = 0 slice of the 3D lattice, kept for comparison
+            static const char* kDimensions[] = { "2D", "3D (z-slice)" };
+            optionsChanged |= ImGui::Combo("Dimension", &dimension, kDimensions,
+                                           IM_ARRAYSIZE(kDimensions));
+            static const char* kBases[] = { "Perlin", "Simplex", "Worley" };
+            optionsChanged |= ImGui::Combo("Basis", &basis, kBases, IM_ARRAYSIZE(kBases));
+            HelpMarker("Simplex touches 3 corners per sample in 2D instead of 4 "
+                       "and has fewer axis-aligned artefacts. Worley is the "
+                       "distance to the nearest feature points, for plateaus, "
+                       "cracked rock and islands");
+            if (basis == static_cast<int>(NoiseBasis::Worley))
+            {
+                static const char* kCellFunctions[] = { "F1", "F2", "F2 - F1" };
+                optionsChanged |= ImGui::Combo("Cell function", &cellFunction,
+                                               kCellFunctions, IM_ARRAYSIZE(kCellFunctions));
+                static const char* kCellDistances[] = { "Euclidean", "Manhattan", "Chebyshev" };
+                optionsChanged |= ImGui::Combo("Cell distance", &cellDistance,
+                                               kCellDistances, IM_ARRAYSIZE(kCellDistances));
+            }
+            optionsChanged |= ImGui::Checkbox(" Analytic normals", &analyticNormals);
+            HelpMarker("Generates the noise derivatives, terrain normals are "
+                       "computed from them instead of from the triangles");
+            optionsChanged |= ImGui::Checkbox(" Noise channels", &generateChannels);
+            HelpMarker("Generates temperature, moisture and a detail mask with "
+                       "the same settings in the traversal of the height, the "
+                       "regions are selected with them");
+            if (generateChannels)
+            {
+                static const char* kChannelNames[] = { "Temperature octaves",
+                                                       "Moisture octaves",
+                                                       "Detail octaves" };
+                for (uint32_t c = 0; c < ProceduralTexture2D::CHANNEL_COUNT; ++c)
+                    optionsChanged |= ImGui::SliderInt(kChannelNames[c], &channelOctaves[c],
+                                                       1, octaves);
+                ShowTexture(m_NoiseMap->GetChannelTexture()->GetID(),
+                            m_NoiseMap->GetSize(), 128, 128);
+            }
+            optionsChanged |= ImGui::Checkbox(" Periodic", &periodic);
+            HelpMarker("Wraps the lattice of each octave, so the map tiles "
+                       "exactly at its edges. Simplex is replaced by Perlin, "
+                       "the evaluation mode and the layer cache are unused");
+            if (periodic)
+            {
+                optionsChanged |= ImGui::DragInt("Tile period", &tilePeriod, 1.0f, 0, 4096);
+                HelpMarker("Period in samples, 0 repeats the first row and "
+                           "column at the opposite edges");
+                if (basis == static_cast<int>(NoiseBasis::Simplex))
+                    ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.4f, 1.0f),
+                                       "Simplex has no square lattice to wrap, "
+                                       "Perlin is used while periodic");
+                ImGui::Text("Seam error: %g", m_NoiseMap->GetSeamError());
+            }
+            optionsChanged |= ImGui::Checkbox(" Noise graph", &useNoiseGraph);
+            HelpMarker("Generates the heights with a graph of sources, "
+                       "combiners, warps and curves instead of the settings "
+                       "above, evaluated tile by tile in one pass. The octave "
+                       "precision and target spacing still apply");
+            if (useNoiseGraph && ImGui::TreeNode("Graph"))
+            {
+                optionsChanged |= ShowNoiseGraphEditor(noiseGraph);
+
+                const NoiseProgram& kProgram = m_NoiseMap->GetNoiseProgram();
+                if (!m_NoiseMap->GetNoiseGraphError().empty())
+                    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s",
+                                       m_NoiseMap->GetNoiseGraphError().c_str());
+                else
+                    ImGui::Text("%u instructions, %u registers per tile",
+                                kProgram.GetInstructionCount(),
+                                kProgram.GetRegisterCount());
+                ImGui::TreePop();
+            }
+
+            static const char* kBackends[] = { "CPU", "Compute shader" };
+            optionsChanged |= ImGui::Combo("Backend", &backend, kBackends,
+                                           IM_ARRAYSIZE(kBackends));
+            HelpMarker("Generates the 2D Perlin fractal noise on the GPU, the "
+                       "values are read back when the terrain is generated. "
+                       "Other settings fall back to the CPU");
+            if (backend == static_cast<int>(ProceduralTexture2D::Backend::Compute))
+            {
+                static float parityError = -1.0f;
+                if (!m_ComputeBackendError.empty())
+                    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s",
+                                       m_ComputeBackendError.c_str());
+                else if (!m_NoiseMap->IsComputeGenerated())
+                    ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.4f, 1.0f), "CPU: %s",
+                                       m_NoiseMap->GetComputeFallbackReason().c_str());
+                if (ImGui::Button("Check parity"))
+                    parityError = m_NoiseMap->MeasureComputeParity();
+                ImGui::SameLine();
+                if (parityError >= 0.0f)
+                    ImGui::Text("Max difference to the CPU: %g", parityError);
+            }
+
+            static const char* kEvaluationModes[] = { "Per sample", "Batch", "Row",
+                                                      "Split cell" };
+            optionsChanged |= ImGui::Combo("Evaluation", &evaluation, kEvaluationModes,
+                                           IM_ARRAYSIZE(kEvaluationModes));
+            HelpMarker("Noise entry point used for the rows, compare their "
+                       "timings in the metrics window. Split cell keeps the "
+                       "precision at large offsets. The layer cache is only "
+                       "used by Batch");
+            optionsChanged |= ImGui::DragInt2("Tile size", glm::value_ptr(tileSize),
+                                              1.0f, 0, 4096);
+            HelpMarker("Samples per task of the job system, 0 selects the full "
+                       "width or a row count per task. The row modes always "
+                       "use full rows. The values do not depend on it");
+            static float simdError = -1.0f;
+            if (ImGui::Button("Check SIMD"))
+                simdError = m_NoiseMap->MeasureSIMDParity();
+            ImGui::SameLine();
+            if (simdError >= 0.0f)
+                ImGui::Text("%s %s, max difference to the scalar noise: %g",
+                            PerlinSIMD::GetISAName(PerlinSIMD::GetBestISA()),
+                            simdError <= PerlinSIMD::PERLIN_SIMD_MAX_ERROR ? "within bound"
+                                                                           : "exceeds bound",
+                            simdError);
+            static const char* kLayerCacheModes[] = { "Off", "Float", "16-bit" };
+            optionsChanged |= ImGui::Combo("Layer cache", &layerCache, kLayerCacheModes,
+                                           IM_ARRAYSIZE(kLayerCacheModes));
+            HelpMarker("Keeps the noise of each octave, changing the gain or "
+                       "the octaves then only re-weights the cached layers. "
+                       "Filling it makes a full generation about a fifth slower");
+            optionsChanged |= ImGui::DragInt("Cache budget (MiB)", &layerCacheBudget,
+                                             1.0f, 0, 4096);
+            ImGui::Text("Cached: %u layers, %.1f MiB",
+                        m_NoiseMap->GetCachedLayerCount(),
+                        m_NoiseMap->GetLayerCacheSize() / (1024.0f * 1024.0f));
 
             ShowTexture(m_NoiseMap->GetTexture()->GetID(), m_NoiseMap->GetSize(), 128, 128);
 
@@ -166,19 +402,58 @@ void ProceduralTerrain::ShowInterface()
                 m_NoiseMap->SetOffset(offset);
                 m_NoiseMap->SetGain(gain);
                 m_NoiseMap->SetLacunarity(lacunarity);
-
-                m_NoiseMap->GenerateValues();
-                m_NoiseMap->UpdateTexture();
+                m_NoiseMap->SetOctavePrecision(
+                    static_cast<ProceduralTexture2D::OctavePrecision>(octavePrecision));
+                m_NoiseMap->SetTargetSpacing(targetSpacing);
+                m_NoiseMap->SetNoiseDimension(
+                    static_cast<ProceduralTexture2D::NoiseDimension>(dimension));
+                m_NoiseMap->SetNoiseBasis(static_cast<NoiseBasis>(basis));
+                m_NoiseMap->SetCellFunction(static_cast<WorleySIMD::CellFunction>(cellFunction));
+                m_NoiseMap->SetCellDistance(static_cast<WorleySIMD::CellDistance>(cellDistance));
+                m_NoiseMap->SetGenerateGradients(analyticNormals);
+                m_NoiseMap->SetGenerateChannels(generateChannels);
+                for (uint32_t c = 0; c < ProceduralTexture2D::CHANNEL_COUNT; ++c)
+                    m_NoiseMap->SetChannelOctaves(
+                        static_cast<ProceduralTexture2D::Channel>(c), channelOctaves[c]);
+                m_NoiseMap->SetPeriodic(periodic);
+                m_NoiseMap->SetTilePeriod(static_cast<uint32_t>(tilePeriod));
+                m_Terrain->SetPeriodic(periodic && tilePeriod == 0);
+                m_NoiseMap->SetUseNoiseGraph(useNoiseGraph);
+                if (useNoiseGraph)
+                    m_NoiseMap->SetNoiseGraph(noiseGraph);
+                m_NoiseMap->SetBackend(static_cast<ProceduralTexture2D::Backend>(backend));
+                m_NoiseMap->SetEvaluationMode(
+                    static_cast<ProceduralTexture2D::EvaluationMode>(evaluation));
+                m_NoiseMap->SetTileSize(glm::max(tileSize, glm::ivec2(0)));
+                m_NoiseMap->SetLayerCacheMode(
+                    static_cast<ProceduralTexture2D::LayerCacheMode>(layerCache));
+                m_NoiseMap->SetLayerCacheBudget(static_cast<size_t>(layerCacheBudget));
+
+                if (UseAsyncGeneration())
+                    RequestGeneration(true, autoUpdateTerrain, ImGui::IsAnyItemActive());
+                else
+                {
+                    CancelGeneration();
+                    m_NoiseMap->GenerateValues();
+                    m_NoiseMap->UpdateTexture();
+                    m_NoiseMapChanged = true;
+                }
 
                 optionsChanged = false;
-                m_NoiseMapChanged = true;
             }
 
             if ( m_NoiseMapChanged && ( kUpdateTerrainPressed || autoUpdateTerrain ) )
             {
-                m_Terrain->Generate();
+                if (UseAsyncGeneration())
+                    RequestGeneration(false, true);
+                else
+                {
+                    m_NoiseMap->ReadBackValues();
+                    GenerateTerrainMesh(*m_Terrain, *m_NoiseMap);
+                    m_Terrain->UpdateVAO();
+                    m_TerrainChanged = true;
+                }
                 m_NoiseMapChanged = false;
-                m_TerrainChanged = true;
             }
 
             ImGui::TreePop();
@@ -206,6 +481,12 @@ void ProceduralTerrain::ShowInterface()
             static const std::string kStrMaxRegionCount =
                 std::to_string(s_kMaxRegionCount);
             ImGui::LabelText(kStrMaxRegionCount.c_str(), "Maximum number of regions:");
+            m_TerrainChanged |=
+                ImGui::DragFloat("Temperature shift", &m_TemperatureShift, 0.01f, 0.0f, 1.0f);
+            HelpMarker("Cold areas take the regions of higher altitudes, needs "
+                       "the noise channels");
+            m_TerrainChanged |=
+                ImGui::DragFloat("Detail strength", &m_DetailStrength, 0.005f, 0.0f, 1.0f);
             ImGui::PopItemWidth();
 
             ImGui::Separator();
@@ -255,6 +536,8 @@ void ProceduralTerrain::ShowInterface()
                     changed |= ImGui::DragFloat("Tint Strength", &region.tintStrength, 0.01f, 0.0f, 1.0f);
                     changed |= ImGui::DragFloat("Blend range", &region.blendStrength, 0.01f, 0.0f, 1.0f);
                     changed |= ImGui::DragFloat("Texture Scale", &region.scale, 0.1f, 0.0f, 100.0f);
+                    changed |= ImGui::DragFloatRange2("Moisture", &region.moisture.x,
+                                                      &region.moisture.y, 0.01f, 0.0f, 1.0f);
 
                     ImGui::PopItemWidth();
                     ImGui::TreePop();
@@ -353,9 +636,120 @@ void ProceduralTerrain::StatusWindow()
     // frametime and FPS
     ImGui::Text("ProceduralTerrain average %.3f ms/frame (%.1f FPS)", 
                 1000.0f / io.Framerate, io.Framerate);
-    ImGui::Text("%u vertices, %u indices (%u triangles)", 
-                m_Terrain->GetVertexCount(), m_Terrain->GetIndexCount(),
+    ImGui::Text("%u vertices, %llu indices (%u triangles)", 
+                m_Terrain->GetVertexCount(),
+                static_cast<unsigned long long>(m_Terrain->GetIndexCount()),
                 m_Terrain->GetTriangleCount());
+    if (const GridIndexBuffer* kIndices = m_Terrain->GetIndexBuffer())
+        ImGui::Text("Index band: %u %s indices, %zu cached buffers of %.1f KB",
+                    kIndices->GetIndexCount(), kIndices->Is16Bit() ? "16 bit" : "32 bit",
+                    GridIndexBuffer::GetCacheCount(),
+                    GridIndexBuffer::GetCacheBytes() / 1024.0);
+    if (const StreamingVertexBuffer* kVertices = m_Terrain->GetVertexBuffer())
+        ImGui::Text("Vertex ring: %u segments of %.1f MB, %u uploads stalled, %u allocations",
+                    StreamingVertexBuffer::SEGMENT_COUNT,
+                    kVertices->GetSegmentSize() / (1024.0 * 1024.0),
+                    kVertices->GetStallCount(), kVertices->GetReallocationCount());
+    const auto& kOctaveStats = m_NoiseMap->GetOctaveStats();
+    ImGui::Text("%u of %u octaves evaluated (%u faded), skipped: "
+                "%u below precision, %u below spacing",
+                kOctaveStats.evaluated, kOctaveStats.selected, kOctaveStats.faded,
+                kOctaveStats.belowPrecision, kOctaveStats.belowSpacing);
+
+    ImGui::Text("Background generation: %s, latency %.1f ms, %u dropped",
+                !IsGenerationRunning() ? "idle" : m_CancelGeneration ? "cancelling" :
+                m_RunningGeneration.stride > 1 ? "preview" : "running",
+                m_GenerationLatency, m_DroppedGenerations);
+    if (m_SlicedGeneration)
+        ImGui::Text("Sliced: %s %.0f%%, slice %u took %.2f ms",
+                    m_SlicedGeneration->GetStage(),
+                    m_SlicedGeneration->GetStageProgress() * 100.0f,
+                    m_SlicedGeneration->GetSliceCount(), m_LastSliceDuration);
+
+    if (m_Tuning.valid)
+        ImGui::Text("Calibrated: %u workers, tiles %ux%u, %u vertices per task "
+                    "(%ux%u map: noise %.2f ms, mesh %.2f ms)",
+                    m_Tuning.workerCount, m_Tuning.tileSize.x, m_Tuning.tileSize.y,
+                    m_Tuning.verticesPerTask, m_Tuning.mapSize.x, m_Tuning.mapSize.y,
+                    m_Tuning.noiseMs, m_Tuning.meshMs);
+    else
+        ImGui::Text("Not calibrated, the defaults are used");
+    ImGui::SameLine();
+    if (ImGui::Button("Calibrate"))
+        Calibrate();
+
+    const JobSystem::Stats kJobStats = JobSystem::Get().GetStats();
+    ImGui::Text("Job system: %u workers, %llu tasks executed, %llu stolen",
+                JobSystem::Get().GetWorkerCount(),
+                static_cast<unsigned long long>(kJobStats.executed),
+                static_cast<unsigned long long>(kJobStats.stolen));
+    if (ImGui::BeginTable("Job timings", 3,
+                          ImGuiTableFlags_Resizable |
+                          ImGuiTableFlags_BordersOuter |
+                          ImGuiTableFlags_BordersV))
+    {
+        std::lock_guard<std::mutex> lock(m_JobTimingMutex);
+        for (const auto& [kName, kTiming] : m_JobTimings)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f ms", kTiming.durationMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u tasks", kTiming.taskCount);
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", kName.c_str());
+        }
+        ImGui::EndTable();
+    }
+    if (ImGui::Button("Reset job timings"))
+    {
+        std::lock_guard<std::mutex> lock(m_JobTimingMutex);
+        m_JobTimings.clear();
+    }
+
+    ImGui::Text("Memory traffic of the last terrain generation");
+    if (ImGui::BeginTable("Terrain memory traffic", 3,
+                          ImGuiTableFlags_Resizable |
+                          ImGuiTableFlags_BordersOuter |
+                          ImGuiTableFlags_BordersV))
+    {
+        for (const Terrain::StageTraffic& kTraffic : m_Terrain->GetMemoryTraffic())
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f MB read", kTraffic.bytesRead / 1e6);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f MB written", kTraffic.bytesWritten / 1e6);
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", kTraffic.stage);
+        }
+        ImGui::EndTable();
+    }
+
+    if (ImGui::Button("Run benchmark"))
+        RunBenchmark();
+    HelpMarker("Times the alternative paths of the generation against each "
+               "other with the current settings, for a few seconds");
+    if (!m_BenchmarkResults.empty() &&
+        ImGui::BeginTable("Benchmark", 3,
+                          ImGuiTableFlags_Resizable |
+                          ImGuiTableFlags_BordersOuter |
+                          ImGuiTableFlags_BordersV))
+    {
+        for (const Benchmark::Result& kResult : m_BenchmarkResults)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f ms", kResult.ms);
+            ImGui::TableNextColumn();
+            if (kResult.bytesRead + kResult.bytesWritten > 0)
+                ImGui::Text("%.1f MB read, %.1f MB written",
+                            kResult.bytesRead / 1e6, kResult.bytesWritten / 1e6);
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", kResult.name.c_str());
+        }
+        ImGui::EndTable();
+    }
 
     ImGui::Text("Profiling data");
     if ( ImGui::BeginTable("Profiling data", 2,
@@ -378,6 +772,144 @@ void ProceduralTerrain::StatusWindow()
     ImGui::End();
 }
 
+static bool ShowNoiseGraphEditor(NoiseGraph& graph)
+{
+    bool changed = false;
+    std::vector<NoiseNode>& nodes = graph.GetNodes();
+
+    static const auto kTypeName = [](void*, int index, const char** name) {
+        *name = GetNoiseNodeTypeName(static_cast<NoiseNodeType>(index));
+        return true;
+    };
+    static const char* kBases[] = { "Perlin", "Simplex", "Worley" };
+    static const char* kCellFunctions[] = { "F1", "F2", "F2 - F1" };
+    static const char* kCellDistances[] = { "Euclidean", "Manhattan", "Chebyshev" };
+    static const char* kInputLabels[] = { "Input 0", "Input 1", "Input 2" };
+
+    // Inputs select earlier nodes, entry 0 unsets them
+    std::vector<const char*> nodeNames = { "-" };
+    for (const NoiseNode& kNode : nodes)
+        nodeNames.push_back(kNode.name.c_str());
+
+    int removed = -1;
+    for (int i = 0; i < static_cast<int>(nodes.size()); ++i)
+    {
+        NoiseNode& node = nodes[i];
+        ImGui::PushID(i);
+        if (ImGui::TreeNode("Node", "%s = %s", node.name.c_str(),
+                            GetNoiseNodeTypeName(node.type)))
+        {
+            char name[32] = {};
+            node.name.copy(name, sizeof(name) - 1);
+            if (ImGui::InputText("Name", name, sizeof(name)))
+            {
+                node.name = name;
+                changed = true;
+            }
+
+            int type = static_cast<int>(node.type);
+            if (ImGui::Combo("Type", &type, kTypeName, nullptr,
+                             static_cast<int>(NoiseNodeType::Count)))
+            {
+                node.type = static_cast<NoiseNodeType>(type);
+                changed = true;
+            }
+
+            for (uint32_t k = 0; k < GetNoiseNodeInputCount(node.type); ++k)
+            {
+                int input = node.inputs[k] + 1;
+                if (ImGui::Combo(kInputLabels[k], &input, nodeNames.data(), i + 1))
+                {
+                    node.inputs[k] = input - 1;
+                    changed = true;
+                }
+            }
+
+            if (IsNoiseNodeSource(node.type))
+            {
+                int basis = static_cast<int>(node.basis);
+                if (ImGui::Combo("Basis", &basis, kBases, IM_ARRAYSIZE(kBases)))
+                {
+                    node.basis = static_cast<NoiseBasis>(basis);
+                    changed = true;
+                }
+                if (node.basis == NoiseBasis::Worley)
+                {
+                    int function = static_cast<int>(node.cellFunction);
+                    int distance = static_cast<int>(node.cellDistance);
+                    changed |= ImGui::Combo("Cell function", &function, kCellFunctions,
+                                            IM_ARRAYSIZE(kCellFunctions));
+                    changed |= ImGui::Combo("Cell distance", &distance, kCellDistances,
+                                            IM_ARRAYSIZE(kCellDistances));
+                    node.cellFunction = static_cast<WorleySIMD::CellFunction>(function);
+                    node.cellDistance = static_cast<WorleySIMD::CellDistance>(distance);
+                }
+                changed |= ImGui::DragInt("Seed", &node.seed);
+                changed |= ImGui::DragFloat("Scale", &node.scale, 0.1f, 0.001f, 10000.f);
+                changed |= ImGui::SliderInt("Octaves", &node.octaves, 1, 32);
+                changed |= ImGui::DragFloat("Gain", &node.gain, 0.01f, 0.f, 1.f);
+                changed |= ImGui::DragFloat("Lacunarity", &node.lacunarity, 0.01f, 1.f, 100.f);
+            }
+
+            const auto kParamNames = GetNoiseNodeParamNames(node.type);
+            if (kParamNames[0])
+                changed |= ImGui::DragFloat(kParamNames[0], &node.a, 0.01f);
+            if (kParamNames[1])
+                changed |= ImGui::DragFloat(kParamNames[1], &node.b, 0.01f);
+
+            if (ImGui::Button("Remove"))
+                removed = i;
+            ImGui::TreePop();
+        }
+        ImGui::PopID();
+    }
+
+    if (removed >= 0)
+    {
+        graph.RemoveNode(static_cast<uint32_t>(removed));
+        changed = true;
+    }
+
+    static int addType = static_cast<int>(NoiseNodeType::Fbm);
+    ImGui::Combo("##AddType", &addType, kTypeName, nullptr,
+                 static_cast<int>(NoiseNodeType::Count));
+    ImGui::SameLine();
+    if (ImGui::Button("Add node"))
+    {
+        graph.AddNode(static_cast<NoiseNodeType>(addType));
+        changed = true;
+    }
+
+    nodeNames[0] = "(last)";
+    int output = graph.GetOutput() + 1;
+    if (ImGui::Combo("Output", &output, nodeNames.data(),
+                     static_cast<int>(nodeNames.size())))
+    {
+        graph.SetOutput(output - 1);
+        changed = true;
+    }
+
+    // Recipe, one node per line, see NoiseGraph::ToRecipe
+    static char recipe[4096] = {};
+    static std::string recipeError;
+    if (ImGui::Button("Export recipe"))
+    {
+        const std::string kRecipe = graph.ToRecipe();
+        kRecipe.copy(recipe, sizeof(recipe) - 1);
+        recipe[std::min(kRecipe.size(), sizeof(recipe) - 1)] = '\0';
+        recipeError.clear();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Load recipe"))
+        changed |= graph.FromRecipe(recipe, recipeError);
+    ImGui::InputTextMultiline("##Recipe", recipe, sizeof(recipe),
+                              ImVec2(-1.0f, ImGui::GetTextLineHeight() * 8));
+    if (!recipeError.empty())
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", recipeError.c_str());
+
+    return changed;
+}
+
 static void HelpMarker(const char* desc)
 {
     ImGui::SameLine();
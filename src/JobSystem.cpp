@@ -0,0 +1,348 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "ResumableTask.h"
+
+
+// Queue of the calling thread, workers only use the queues of their pool
+static thread_local const JobSystem* s_Owner = nullptr;
+static thread_local uint32_t s_WorkerIndex = 0;
+
+/** @brief Chunks of a ParallelFor, taken by the caller and the helper tasks */
+struct ParallelJob
+{
+    const std::function<void(uint32_t, uint32_t)>* function{ nullptr };
+    uint32_t count{ 0 };
+    uint32_t grain{ 1 };
+    uint32_t chunkCount{ 0 };
+
+    std::atomic<uint32_t> nextChunk{ 0 };
+    std::atomic<uint32_t> pendingChunks{ 0 };
+    std::mutex mutex;
+    std::condition_variable finished;
+};
+
+/**
+ * @brief Runs chunks of the job until none are left. The function is only
+ *  called for a taken chunk, the caller of ParallelFor is still waiting then.
+ */
+static void RunChunks(ParallelJob& job)
+{
+    for (uint32_t chunk = job.nextChunk++; chunk < job.chunkCount; chunk = job.nextChunk++)
+    {
+        const uint32_t kBegin = chunk * job.grain;
+        (*job.function)(kBegin, std::min(kBegin + job.grain, job.count));
+
+        if (--job.pendingChunks == 0)
+        {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            job.finished.notify_all();
+        }
+    }
+}
+
+// =============================================================================
+
+JobSystem& JobSystem::Get()
+{
+    static JobSystem s_JobSystem;
+    return s_JobSystem;
+}
+
+uint32_t JobSystem::GetDefaultWorkerCount()
+{
+    const uint32_t kThreads = std::thread::hardware_concurrency();
+    return kThreads > 1 ? kThreads - 1 : 0;
+}
+
+JobSystem::JobSystem(uint32_t workerCount)
+{
+    StartWorkers(workerCount);
+}
+
+JobSystem::~JobSystem()
+{
+    StopWorkers();
+}
+
+void JobSystem::SetWorkerCount(uint32_t workerCount)
+{
+    if (workerCount == GetWorkerCount())
+        return;
+
+    StopWorkers();
+    StartWorkers(workerCount);
+}
+
+void JobSystem::StartWorkers(uint32_t workerCount)
+{
+    m_Stopping = false;
+
+    m_Queues.clear();
+    for (uint32_t i = 0; i < workerCount + 1; ++i)
+        m_Queues.push_back(std::make_unique<Queue>());
+
+    m_WorkerCount = workerCount;
+    for (uint32_t i = 0; i < workerCount; ++i)
+        m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+void JobSystem::StopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_WakeMutex);
+        m_Stopping = true;
+    }
+    m_WakeCondition.notify_all();
+
+    for (auto& worker : m_Workers)
+        worker.join();
+    m_Workers.clear();
+    m_WorkerCount = 0;
+
+    // Tasks queued by other threads without workers left
+    while (TaskRef task = Acquire(GetQueueIndex()))
+        Execute(task, GetQueueIndex());
+}
+
+void JobSystem::WorkerLoop(uint32_t worker)
+{
+    s_Owner = this;
+    s_WorkerIndex = worker;
+
+    for (;;)
+    {
+        if (TaskRef task = Acquire(worker))
+        {
+            Execute(task, worker);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_WakeMutex);
+        m_WakeCondition.wait(lock, [this]() {
+            return m_Stopping || m_QueuedCount.load() > 0;
+        });
+        if (m_Stopping && m_QueuedCount.load() == 0)
+            return;
+    }
+}
+
+uint32_t JobSystem::GetQueueIndex() const
+{
+    return s_Owner == this ? s_WorkerIndex : GetWorkerCount();
+}
+
+JobSystem::TaskRef JobSystem::Submit(const char* name, TaskFunction function,
+                                     std::initializer_list<TaskRef> dependencies)
+{
+    TaskRef task = std::make_shared<Task>();
+    task->function = std::move(function);
+    task->name = name;
+
+    // One extra dependency while registering, so it cannot be queued by a
+    //  dependency finishing in the meantime
+    task->pendingDependencies = 1;
+    for (const TaskRef& dependency : dependencies)
+    {
+        if (!dependency)
+            continue;
+
+        std::lock_guard<std::mutex> lock(dependency->mutex);
+        if (!dependency->done)
+        {
+            dependency->dependents.push_back(task);
+            ++task->pendingDependencies;
+        }
+    }
+
+    if (--task->pendingDependencies == 0)
+    {
+        if (GetWorkerCount() == 0)
+            Execute(task, GetQueueIndex());
+        else
+            Enqueue(task);
+    }
+    return task;
+}
+
+void JobSystem::Enqueue(const TaskRef& task)
+{
+    Queue& queue = *m_Queues[GetQueueIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(task);
+    }
+
+    // Taking the lock orders the count with a worker about to sleep
+    {
+        std::lock_guard<std::mutex> lock(m_WakeMutex);
+        ++m_QueuedCount;
+    }
+    m_WakeCondition.notify_one();
+}
+
+JobSystem::TaskRef JobSystem::Acquire(uint32_t worker)
+{
+    const uint32_t kQueueCount = static_cast<uint32_t>(m_Queues.size());
+
+    // Newest task of the own queue, its data is likely still in the cache
+    {
+        Queue& queue = *m_Queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            TaskRef task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            --m_QueuedCount;
+            return task;
+        }
+    }
+
+    // Oldest task of another queue, usually the largest piece of work left
+    for (uint32_t i = 1; i < kQueueCount; ++i)
+    {
+        Queue& queue = *m_Queues[(worker + i) % kQueueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            TaskRef task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            --m_QueuedCount;
+            ++m_Stolen;
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::Execute(const TaskRef& task, uint32_t worker)
+{
+    std::shared_ptr<const ProfileHook> hook;
+    {
+        std::lock_guard<std::mutex> lock(m_HookMutex);
+        hook = m_ProfileHook;
+    }
+
+    if (hook)
+    {
+        const auto kStart = std::chrono::steady_clock::now();
+        task->function();
+        const std::chrono::duration<double, std::milli> kDuration =
+            std::chrono::steady_clock::now() - kStart;
+        (*hook)({ task->name, worker, kDuration.count() });
+    }
+    else
+        task->function();
+
+    // Releases the captures
+    task->function = nullptr;
+    ++m_Executed;
+
+    std::vector<TaskRef> dependents;
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->done = true;
+        dependents.swap(task->dependents);
+    }
+    task->finished.notify_all();
+
+    for (const TaskRef& dependent : dependents)
+    {
+        if (--dependent->pendingDependencies != 0)
+            continue;
+
+        if (GetWorkerCount() == 0)
+            Execute(dependent, worker);
+        else
+            Enqueue(dependent);
+    }
+}
+
+void JobSystem::Wait(const TaskRef& task)
+{
+    if (!task)
+        return;
+
+    std::unique_lock<std::mutex> lock(task->mutex);
+    task->finished.wait(lock, [&task]() { return task->done.load(); });
+}
+
+bool JobSystem::IsDone(const TaskRef& task)
+{
+    return !task || task->done;
+}
+
+void JobSystem::ParallelFor(const char* name, uint32_t count, uint32_t grain,
+                            const std::function<void(uint32_t, uint32_t)>& function)
+{
+    if (count == 0)
+        return;
+
+    grain = std::max(grain, 1U);
+    if (GetWorkerCount() == 0 || count <= grain)
+    {
+        // Chunk by chunk, so that a resumable task may pause in between
+        for (uint32_t begin = 0; begin < count; begin += grain)
+        {
+            const uint32_t kEnd = std::min(begin + grain, count);
+            function(begin, kEnd);
+            ResumableTask::Yield(name, static_cast<float>(kEnd) / count);
+        }
+        return;
+    }
+
+    // The helpers may start after the loop finished, they own the job and
+    //  find no chunk left then
+    const auto kJob = std::make_shared<ParallelJob>();
+    kJob->function = &function;
+    kJob->count = count;
+    kJob->grain = grain;
+    kJob->chunkCount = (count + grain - 1) / grain;
+    kJob->pendingChunks = kJob->chunkCount;
+
+    const uint32_t kHelperCount = std::min(GetWorkerCount(), kJob->chunkCount - 1);
+    for (uint32_t i = 0; i < kHelperCount; ++i)
+        Submit(name, [kJob]() { RunChunks(*kJob); });
+
+    RunChunks(*kJob);
+    {
+        std::unique_lock<std::mutex> lock(kJob->mutex);
+        kJob->finished.wait(lock, [&kJob]() { return kJob->pendingChunks.load() == 0; });
+    }
+    ResumableTask::Yield(name, 1.0f);
+}
+
+void JobSystem::ParallelFor2D(const char* name, const glm::uvec2& size,
+                              const glm::uvec2& tileSize,
+                              const std::function<void(const glm::uvec2&, const glm::uvec2&)>& function)
+{
+    const glm::uvec2 kTile = glm::max(tileSize, glm::uvec2(1));
+    const glm::uvec2 kTiles = (size + kTile - 1U) / kTile;
+
+    ParallelFor(name, kTiles.x * kTiles.y, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const glm::uvec2 kBegin = glm::uvec2(i % kTiles.x, i / kTiles.x) * kTile;
+            function(kBegin, glm::min(kBegin + kTile, size));
+        }
+    });
+}
+
+void JobSystem::SetProfileHook(ProfileHook hook)
+{
+    std::lock_guard<std::mutex> lock(m_HookMutex);
+    m_ProfileHook = hook ? std::make_shared<const ProfileHook>(std::move(hook)) : nullptr;
+}
+
+JobSystem::Stats JobSystem::GetStats() const
+{
+    return { m_Executed.load(), m_Stolen.load() };
+}
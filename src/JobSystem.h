@@ -0,0 +1,154 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+
+/**
+ * @brief Work-stealing thread pool shared by the generation stages. Every
+ *  worker owns a queue, it pushes and pops its own tasks at the back and
+ *  steals from the front of the other queues when it runs out. Waiting for
+ *  a task blocks without running other tasks, so the render thread never
+ *  picks up a long background task. ParallelFor runs the chunks of its own
+ *  loop on the calling thread while waiting, so tasks may run parallel loops,
+ *  but they must not Wait for the tasks they submit. With 0 workers
+ *  everything runs on the calling thread.
+ */
+class JobSystem
+{
+public:
+    struct Task;
+    using TaskRef = std::shared_ptr<Task>;
+    using TaskFunction = std::function<void()>;
+
+    /** @brief Timing of an executed task, see SetProfileHook */
+    struct TaskProfile
+    {
+        const char* name;
+        uint32_t worker;        ///< Index of the worker, GetWorkerCount() for other threads
+        double durationMs;
+    };
+    using ProfileHook = std::function<void(const TaskProfile&)>;
+
+    struct Stats
+    {
+        uint64_t executed{ 0 };
+        uint64_t stolen{ 0 };
+    };
+
+    /** @return Pool shared by the application */
+    static JobSystem& Get();
+
+    /** @return Workers to use by default, one hardware thread is left to the caller */
+    static uint32_t GetDefaultWorkerCount();
+
+    explicit JobSystem(uint32_t workerCount = GetDefaultWorkerCount());
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * @brief Restarts the workers, waits for the queued tasks first. No other
+     *  thread may submit or wait for tasks meanwhile, the caller cancels and
+     *  waits for the generation, see ProceduralTerrain::StopGeneration
+     */
+    void SetWorkerCount(uint32_t workerCount);
+    uint32_t GetWorkerCount() const { return m_WorkerCount.load(); }
+
+    /**
+     * @brief Queues the function, it runs once all dependencies finished
+     * @param name Static string, reported to the profile hook
+     */
+    TaskRef Submit(const char* name, TaskFunction function,
+                   std::initializer_list<TaskRef> dependencies = {});
+
+    /** @brief Blocks until the task finished, see the class description */
+    void Wait(const TaskRef& task);
+    static bool IsDone(const TaskRef& task);
+
+    /**
+     * @brief Calls function(begin, end) over [0,count) in chunks of grain
+     *  items across the workers and waits for them. The calling thread takes
+     *  chunks as well, only of this loop, until none are left. Yields to the running
+     *  ResumableTask, if any, between the chunks run serially and after the
+     *  parallel ones.
+     */
+    void ParallelFor(const char* name, uint32_t count, uint32_t grain,
+                     const std::function<void(uint32_t, uint32_t)>& function);
+
+    /**
+     * @brief Calls function(begin, end) for the tiles of tileSize covering
+     *  size, end is exclusive and clamped to the size
+     */
+    void ParallelFor2D(const char* name, const glm::uvec2& size, const glm::uvec2& tileSize,
+                       const std::function<void(const glm::uvec2&, const glm::uvec2&)>& function);
+
+    /** @brief Called after every task, from the thread that executed it */
+    void SetProfileHook(ProfileHook hook);
+
+    Stats GetStats() const;
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<TaskRef> tasks;
+    };
+
+    void StartWorkers(uint32_t workerCount);
+    void StopWorkers();
+    void WorkerLoop(uint32_t worker);
+
+    void Enqueue(const TaskRef& task);
+    /** @return A task of the own queue or stolen from another one */
+    TaskRef Acquire(uint32_t worker);
+    void Execute(const TaskRef& task, uint32_t worker);
+    /** @return Index of the calling thread's queue */
+    uint32_t GetQueueIndex() const;
+
+    std::vector<std::thread> m_Workers;
+    /** @brief Of m_Workers, read by the tasks and the other threads */
+    std::atomic<uint32_t> m_WorkerCount{ 0 };
+    /** @brief One per worker, the last one is shared by the other threads */
+    std::vector<std::unique_ptr<Queue>> m_Queues;
+
+    std::mutex m_WakeMutex;
+    std::condition_variable m_WakeCondition;
+    std::atomic<uint32_t> m_QueuedCount{ 0 };
+    bool m_Stopping{ false };
+
+    std::mutex m_HookMutex;
+    std::shared_ptr<const ProfileHook> m_ProfileHook;
+
+    std::atomic<uint64_t> m_Executed{ 0 };
+    std::atomic<uint64_t> m_Stolen{ 0 };
+};
+
+/** @brief Unit of work, see JobSystem::Submit */
+struct JobSystem::Task
+{
+    JobSystem::TaskFunction function;
+    const char* name{ "" };
+
+    std::atomic<uint32_t> pendingDependencies{ 0 };
+    std::atomic<bool> done{ false };
+
+    std::mutex mutex;
+    std::condition_variable finished;   ///< Notified with done set, see Wait
+    std::vector<TaskRef> dependents;    ///< Queued when this task finished
+};
@@ -6,6 +6,8 @@
 #include "ProceduralTerrain.h"
 #include "ResourceManager.h"
 
+#include <algorithm>
+
 
 static void ResizeCallback(GLFWwindow*, int, int);
 static void MouseMoveCallback(GLFWwindow*, double, double);
@@ -15,16 +17,92 @@ static void KeyPressedCallback(GLFWwindow*, int, int, int, int);
 ProceduralTerrain::ProceduralTerrain()
     : Application()
 {
+    InstallJobProfileHook();
+
     CreateShaders();
     CreateTextures();
     CreateSceneObjects();
+
+    // Calibrated on request, see Calibrate
+    if (AutoTuner::Load(AutoTuner::GetDefaultPath(), m_Tuning))
+        ApplyTuning();
 }
 
 ProceduralTerrain::~ProceduralTerrain()
 {
+    CancelGeneration();
+    JobSystem::Get().Wait(m_GenerationTask);
+    m_SlicedGeneration.reset();
+
+    // The cached indices would outlive the context as statics, they are
+    //  dropped with the terrains while it is current
+    m_PreviewTerrain.reset();
+    m_BackTerrain.reset();
+    m_Terrain.reset();
+    GridIndexBuffer::ReleaseUnused();
+
+    JobSystem::Get().SetProfileHook(nullptr);
     ResourceManager::ClearAll();
 }
 
+void ProceduralTerrain::InstallJobProfileHook()
+{
+    JobSystem::Get().SetProfileHook([this](const JobSystem::TaskProfile& profile) {
+        std::lock_guard<std::mutex> lock(m_JobTimingMutex);
+        JobTiming& timing = m_JobTimings[profile.name];
+        timing.durationMs += profile.durationMs;
+        ++timing.taskCount;
+    });
+}
+
+void ProceduralTerrain::Calibrate()
+{
+    SGL_PROFILE_SCOPE();
+
+    // The worker count changes under the generation otherwise
+    StopGeneration();
+
+    m_Tuning = AutoTuner::Calibrate(*m_NoiseMap,
+                                    glm::min(m_TerrainSize, glm::uvec2(s_kMaxCalibrationSize)));
+    AutoTuner::Save(AutoTuner::GetDefaultPath(), m_Tuning);
+    ApplyTuning();
+
+    std::lock_guard<std::mutex> lock(m_JobTimingMutex);
+    m_JobTimings.clear();
+}
+
+void ProceduralTerrain::SetWorkerCount(uint32_t workerCount)
+{
+    if (workerCount == JobSystem::Get().GetWorkerCount())
+        return;
+
+    // Restarting the workers would join the generation running on one
+    StopGeneration();
+    JobSystem::Get().SetWorkerCount(workerCount);
+}
+
+void ProceduralTerrain::RunBenchmark()
+{
+    SGL_PROFILE_SCOPE();
+
+    StopGeneration();
+
+    const glm::uvec2 kSize = glm::min(m_TerrainSize, glm::uvec2(s_kMaxCalibrationSize));
+    m_BenchmarkResults = Benchmark::TimeEvaluationModes(*m_NoiseMap, kSize);
+    for (const auto& kTime : { Benchmark::TimeBases, Benchmark::TimeMesh })
+    {
+        const std::vector<Benchmark::Result> kResults = kTime(*m_NoiseMap, kSize);
+        m_BenchmarkResults.insert(m_BenchmarkResults.end(), kResults.begin(), kResults.end());
+    }
+}
+
+void ProceduralTerrain::ApplyTuning()
+{
+    JobSystem::Get().SetWorkerCount(m_Tuning.workerCount);
+    m_NoiseMap->SetTileSize(m_Tuning.tileSize);
+    m_Terrain->SetVerticesPerTask(m_Tuning.verticesPerTask);
+}
+
 void ProceduralTerrain::CreateShaders()
 {
     CreateSkyboxShader();
@@ -66,6 +144,8 @@ void ProceduralTerrain::SetupPreRenderStates()
 
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE);
+    // Ends the terrain's triangle strips at the largest index of the type
+    glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 
     m_TexArray->Bind();
@@ -77,6 +157,8 @@ void ProceduralTerrain::SetupPreRenderStates()
 
 void ProceduralTerrain::Update(float dt)
 {
+    UpdateGeneration();
+
     m_Camera->Update(dt);
 
     m_ProjViewMat = m_Camera->GetProjMat() * m_Camera->GetViewMat();
@@ -86,8 +168,32 @@ void ProceduralTerrain::Render()
 {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    // The preview stands in for the terrain until the generation is swapped in
+    const Terrain& terrain = m_ShowPreview ? *m_PreviewTerrain : *m_Terrain;
+
+    // The preview has the world size of the generation with fewer vertices.
+    //  The size of the next level is set before its mesh is uploaded.
+    const glm::vec2 kGridSize(terrain.GetUploadedSize());
+    const float kTileScale = !m_ShowPreview ? m_Terrain->GetTileScale() :
+        m_Terrain->GetTileScale() * static_cast<float>(m_TerrainSize.x - 1) / (kGridSize.x - 1.0f);
+
+    // The scales and the falloff of the terrain settings apply to the mesh
+    //  in the vertex shader, see Terrain::GenerateVertices
     m_TerrainShader->Use();
     m_TerrainShader->SetMat4("MVP", m_ProjViewMat * glm::mat4(1.0));
+    m_TerrainShader->SetInt("channelMap", 1);
+    m_TerrainShader->SetInt("tileInstances", static_cast<int>(m_Terrain->GetInstanceGrid()));
+    m_TerrainShader->SetVec2("tileSize", (kGridSize - 1.0f) * kTileScale);
+    m_TerrainShader->SetFloat("tileScale", kTileScale);
+    m_TerrainShader->SetFloat("heightScale", m_Terrain->GetHeightScale());
+    m_TerrainShader->SetVec2("gridSize", kGridSize);
+    m_TerrainShader->SetInt("useFallOff", m_Terrain->GetUseFallOffMap() ? 1 : 0);
+    m_TerrainShader->SetVec2("fallOffEdges", glm::vec2(m_Terrain->GetFallOffMapEdge0(),
+                                                       m_Terrain->GetFallOffMapEdge1()));
+
+    glActiveTexture(GL_TEXTURE1);
+    m_NoiseMap->GetChannelTexture()->Bind();
+    glActiveTexture(GL_TEXTURE0);
 
     if (m_TerrainChanged)
         UpdateTerrainUBO();
@@ -96,11 +202,11 @@ void ProceduralTerrain::Render()
         UpdateLightingUBO();
 
     if (!m_RenderWireframe)
-        m_Terrain->Render();
+        terrain.Render();
     else
     {
         glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
-            m_Terrain->Render();
+            terrain.Render();
         glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
     }
 
@@ -196,9 +302,15 @@ void ProceduralTerrain::CreateProceduralTexture()
     SGL_FUNCTION();
     m_NoiseMap = ProceduralTexture2D::Create(m_TextureSize.x, m_TextureSize.y);
     m_NoiseMap->SetScale(220.0);
+    m_NoiseMap->InitComputeBackend(sgl::LoadTextFile(s_kNoiseCS),
+                                   m_ComputeBackendError);
 
     m_NoiseMap->GenerateValues();
     m_NoiseMap->UpdateTexture();
+
+    m_BackNoiseMap = ProceduralTexture2D::Create(m_TextureSize.x, m_TextureSize.y);
+    m_BackNoiseMap->SetCancelFlag(&m_CancelGeneration);
+    m_BackNoiseMap->CopyValues(*m_NoiseMap);
 }
 
 std::vector<sgl::STBData> ProceduralTerrain::LoadTerrainTextures() const
@@ -246,14 +358,268 @@ void ProceduralTerrain::CreateTerrain()
 {
     SGL_FUNCTION();
     
+    m_NoiseMap->ReadBackValues();
+
     m_Terrain = Terrain::CreateUniq(
         m_TextureSize,
         m_NoiseMap->GetValues()
     );
+    m_Terrain->SetGradientMap(&m_NoiseMap->GetGradients());
 
     m_Terrain->SetTileScale(0.05);
     m_Terrain->SetHeightScale(10.0);
     m_Terrain->Generate();
+    m_Terrain->SetHeightMapVersion(m_NoiseMap->GetValueVersion());
+    m_TerrainSize = m_TextureSize;
+
+    m_BackTerrain = Terrain::CreateUniq(
+        m_TextureSize,
+        m_BackNoiseMap->GetValues()
+    );
+    m_BackTerrain->SetGradientMap(&m_BackNoiseMap->GetGradients());
+
+    // Bound to the preview of the back noise map, which needs heights first
+    const uint32_t kStride = s_kPreviewStrides.front();
+    m_BackNoiseMap->GeneratePreview(kStride);
+    m_PreviewTerrain = Terrain::CreateUniq(
+        ProceduralTexture2D::GetPreviewSize(m_TextureSize, kStride),
+        m_BackNoiseMap->GetPreviewValues()
+    );
+}
+
+// =============================================================================
+
+void ProceduralTerrain::GenerateTerrainMesh(Terrain& terrain,
+                                            const ProceduralTexture2D& noiseMap)
+{
+    glm::ivec2 shift;
+    if (noiseMap.GetValueShift(terrain.GetHeightMapVersion(), shift))
+        terrain.GenerateMesh(shift);
+    else
+        terrain.GenerateMesh();
+
+    terrain.SetHeightMapVersion(noiseMap.GetValueVersion());
+}
+
+bool ProceduralTerrain::UseAsyncGeneration() const
+{
+    // The compute shader needs the OpenGL context of the render thread
+    return m_AsyncGeneration &&
+           m_NoiseMap->GetBackend() != ProceduralTexture2D::Backend::Compute;
+}
+
+void ProceduralTerrain::RequestGeneration(bool noise, bool terrain, bool preview)
+{
+    // The running generation is superseded, its work is redone by the
+    //  pending one
+    if (IsGenerationRunning() && !m_CancelGeneration)
+    {
+        m_CancelGeneration = true;
+        ++m_DroppedGenerations;
+
+        m_PendingGeneration.noise |= m_RunningGeneration.noise;
+        m_PendingGeneration.terrain |= m_RunningGeneration.terrain;
+    }
+
+    m_PendingGeneration.noise |= noise;
+    m_PendingGeneration.terrain |= terrain;
+    m_PendingGeneration.preview = preview;
+    m_PendingGeneration.time = std::chrono::steady_clock::now();
+}
+
+void ProceduralTerrain::CancelGeneration()
+{
+    if (IsGenerationRunning() && !m_CancelGeneration)
+    {
+        m_CancelGeneration = true;
+        ++m_DroppedGenerations;
+    }
+    m_PendingGeneration = {};
+
+    // No full generation follows the preview
+    m_ShowPreview = false;
+}
+
+void ProceduralTerrain::StopGeneration()
+{
+    // The work of a cancelled generation is already pending
+    const bool kRunning = IsGenerationRunning() && !m_CancelGeneration;
+    const bool kNoise = m_PendingGeneration.noise || (kRunning && m_RunningGeneration.noise);
+    const bool kTerrain = m_PendingGeneration.terrain || (kRunning && m_RunningGeneration.terrain);
+
+    CancelGeneration();
+    JobSystem::Get().Wait(m_GenerationTask);
+    m_GenerationTask = nullptr;
+    m_SlicedGeneration.reset();
+
+    // Started again by the next UpdateGeneration
+    if (kNoise || kTerrain)
+        RequestGeneration(kNoise, kTerrain);
+}
+
+void ProceduralTerrain::UpdateGeneration()
+{
+    if (m_SlicedGeneration)
+    {
+        // A cancelled generation returns within the slice
+        const auto kStart = std::chrono::steady_clock::now();
+        const bool kDone = m_SlicedGeneration->Resume(
+            std::chrono::duration_cast<ResumableTask::Clock::duration>(
+                std::chrono::duration<float, std::milli>(m_FrameBudget)));
+        const std::chrono::duration<float, std::milli> kDuration =
+            std::chrono::steady_clock::now() - kStart;
+        m_LastSliceDuration = kDuration.count();
+
+        if (!kDone)
+            return;
+
+        if (!m_CancelGeneration)
+            FinishGeneration();
+        m_SlicedGeneration = nullptr;
+    }
+
+    if (m_GenerationTask)
+    {
+        if (!JobSystem::IsDone(m_GenerationTask))
+            return;
+
+        if (!m_CancelGeneration)
+            FinishGeneration();
+        m_GenerationTask = nullptr;
+    }
+
+    if (m_PendingGeneration.noise || m_PendingGeneration.terrain)
+        StartGeneration();
+}
+
+void ProceduralTerrain::StartGeneration()
+{
+    SGL_PROFILE_SCOPE();
+
+    m_RunningGeneration = m_PendingGeneration;
+    m_PendingGeneration = {};
+    m_CancelGeneration = false;
+
+    // A new size needs new values
+    const bool kNoise = m_RunningGeneration.noise || m_TerrainSize != m_NoiseMap->GetSize();
+    const bool kTerrain = m_RunningGeneration.terrain;
+    m_RunningGeneration.noise = kNoise;
+
+    // The back buffers are only touched by the task from here on
+    if (kNoise)
+    {
+        m_BackNoiseMap->CopySettings(*m_NoiseMap);
+        m_BackNoiseMap->SetSize(m_TerrainSize);
+    }
+    else
+    {
+        m_NoiseMap->ReadBackValues();
+        m_BackNoiseMap->CopyValues(*m_NoiseMap);
+    }
+
+    if (kTerrain)
+    {
+        m_BackTerrain->CopySettings(*m_Terrain);
+        m_BackTerrain->SetSize(m_TerrainSize);
+    }
+
+    // The coarsest level the map is large enough for, while dragging
+    if (m_RunningGeneration.stride == 0)
+    {
+        m_RunningGeneration.stride = 1;
+        if (kNoise && kTerrain && m_RunningGeneration.preview && m_ProgressivePreview)
+        {
+            const auto kStride = std::find_if(s_kPreviewStrides.begin(), s_kPreviewStrides.end(),
+                                              [this](uint32_t stride) {
+                return m_BackNoiseMap->CanGeneratePreview(stride);
+            });
+            if (kStride != s_kPreviewStrides.end())
+                m_RunningGeneration.stride = *kStride;
+        }
+    }
+
+    const uint32_t kStride = m_RunningGeneration.stride;
+    if (kStride > 1)
+    {
+        // Drawn at the same world size as the terrain, see Render
+        const glm::uvec2 kGrid = ProceduralTexture2D::GetPreviewSize(m_TerrainSize, kStride);
+        m_PreviewTerrain->CopySettings(*m_Terrain);
+        m_PreviewTerrain->SetSize(kGrid);
+
+        SubmitGeneration("Preview generation", [this, kStride]() {
+            m_BackNoiseMap->GeneratePreview(kStride);
+            if (!m_CancelGeneration)
+                m_PreviewTerrain->GenerateMesh();
+        });
+        return;
+    }
+
+    SubmitGeneration("Background generation", [this, kNoise, kTerrain]() {
+        if (kNoise)
+            m_BackNoiseMap->GenerateValuesInBackground();
+        if (kTerrain && !m_CancelGeneration)
+            GenerateTerrainMesh(*m_BackTerrain, *m_BackNoiseMap);
+    });
+}
+
+void ProceduralTerrain::SubmitGeneration(const char* name, std::function<void()> function)
+{
+    // Without workers the task would run at once and stall the frame
+    if (JobSystem::Get().GetWorkerCount() == 0)
+        m_SlicedGeneration = std::make_unique<ResumableTask>(std::move(function));
+    else
+        m_GenerationTask = JobSystem::Get().Submit(name, std::move(function));
+}
+
+bool ProceduralTerrain::IsGenerationRunning() const
+{
+    if (m_SlicedGeneration)
+        return !m_SlicedGeneration->IsDone();
+    return m_GenerationTask && !JobSystem::IsDone(m_GenerationTask);
+}
+
+void ProceduralTerrain::FinishGeneration()
+{
+    SGL_PROFILE_SCOPE();
+
+    if (m_RunningGeneration.stride > 1)
+    {
+        m_PreviewTerrain->UpdateVAO();
+        m_PreviewRange = glm::vec2(m_BackNoiseMap->GetMinValue(), m_BackNoiseMap->GetMaxValue());
+        m_ShowPreview = true;
+        m_TerrainChanged = true;
+
+        // The next level follows, unless newer settings are pending
+        if (!m_PendingGeneration.noise)
+        {
+            const auto kNext = std::find(s_kPreviewStrides.begin(), s_kPreviewStrides.end(),
+                                         m_RunningGeneration.stride) + 1;
+            GenerationRequest next = m_RunningGeneration;
+            next.terrain |= m_PendingGeneration.terrain;
+            next.stride = kNext < s_kPreviewStrides.end() ? *kNext : 1;
+            m_PendingGeneration = next;
+        }
+        return;
+    }
+
+    if (m_RunningGeneration.noise)
+    {
+        m_NoiseMap->SwapValues(*m_BackNoiseMap);
+        m_NoiseMap->UpdateTexture();
+        m_NoiseMapChanged = !m_RunningGeneration.terrain;
+    }
+
+    if (m_RunningGeneration.terrain)
+    {
+        m_Terrain->SwapMesh(*m_BackTerrain);
+        m_Terrain->UpdateVAO();
+        m_ShowPreview = false;
+    }
+    m_TerrainChanged = true;
+
+    const std::chrono::duration<float, std::milli> kLatency =
+        std::chrono::steady_clock::now() - m_RunningGeneration.time;
+    m_GenerationLatency = kLatency.count();
 }
 
 void ProceduralTerrain::CreateTerrainUBO()
@@ -365,15 +731,21 @@ void ProceduralTerrain::OnKeyPressed(GLFWwindow *window, int key, int scancode,
 
 void ProceduralTerrain::UpdateTerrainUBO()
 {
+    m_NoiseMap->ReadBackValues();
     const float kTerrainHeightScale = m_Terrain->GetHeightScale();
 
-    m_TerrainUBOData.minHeight = m_NoiseMap->GetMinValue() * kTerrainHeightScale;
-    m_TerrainUBOData.maxHeight = m_NoiseMap->GetMaxValue() * kTerrainHeightScale;
+    const glm::vec2 kRange = m_ShowPreview ? m_PreviewRange :
+        glm::vec2(m_NoiseMap->GetMinValue(), m_NoiseMap->GetMaxValue());
+    m_TerrainUBOData.minHeight = kRange.x * kTerrainHeightScale;
+    m_TerrainUBOData.maxHeight = kRange.y * kTerrainHeightScale;
     //m_TerrainChanged = false;
 
     // TODO if regions changed
 
     m_TerrainUBOData.regionCount = static_cast<int>(m_Regions.size());
+    m_TerrainUBOData.useChannels = m_NoiseMap->GetChannelValues().empty() ? 0 : 1;
+    m_TerrainUBOData.temperatureShift = m_TemperatureShift;
+    m_TerrainUBOData.detailStrength = m_DetailStrength;
 
     SGL_ASSERT(m_Regions.size() <= s_kMaxRegionCount);
 
@@ -387,6 +759,7 @@ void ProceduralTerrain::UpdateTerrainUBO()
         region.tintStrength = m_Regions[i].tintStrength;
         region.blendStrength = m_Regions[i].blendStrength;
         region.startHeight = m_Regions[i].startHeight;
+        region.moisture = m_Regions[i].moisture;
     }
 
     // TODO null the rest?
@@ -410,7 +783,8 @@ ProceduralTerrain::Region::Region()
       texIndex(0),
       scale(1.0),
       tintStrength(0.1),
-      blendStrength(0.1)
+      blendStrength(0.1),
+      moisture(0.0, 1.0)
 {
 
 }
@@ -429,14 +803,15 @@ ProceduralTerrain::Region::Region(const std::string& newName)
 
 ProceduralTerrain::Region::Region(
     float sh, const std::string& newName, Color c, int tID,
-    float sc, float tintStr, float blendStr)
+    float sc, float tintStr, float blendStr, glm::vec2 moist)
     : startHeight(sh),
       name(newName),
       tint(c),
       texIndex(tID),
       scale(sc),
       tintStrength(tintStr),
-      blendStrength(blendStr)
+      blendStrength(blendStr),
+      moisture(moist)
 {
 
 }
\ No newline at end of file
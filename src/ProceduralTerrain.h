@@ -5,6 +5,10 @@
 
 #pragma once
 
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <unordered_map>
 
@@ -17,6 +21,10 @@
 #include "scene/Skybox.h"
 #include "scene/ProceduralTexture2D.h"
 #include "scene/Terrain.h"
+#include "AutoTuner.h"
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "ResumableTask.h"
 
 
 class ProceduralTerrain : public sgl::Application
@@ -25,6 +33,14 @@ public:
     ProceduralTerrain();
     ~ProceduralTerrain();
 
+    /**
+     * @brief Times the generation on this machine, saves the fastest config
+     *  to AutoTuner::GetDefaultPath and applies it. Restarts the running
+     *  generation. Only on request, the --calibrate flag or the button, the
+     *  defaults apply until the first calibration.
+     */
+    void Calibrate();
+
     void OnResize(GLFWwindow*, int, int);
     void OnMouseMove(GLFWwindow*, double, double);
     void OnMousePressed(GLFWwindow*, int, int, int);
@@ -57,6 +73,54 @@ private:
 
     void SetupPreRenderStates();
 
+    /** @brief Sums the task durations of the job system per task name */
+    void InstallJobProfileHook();
+
+    /** @brief Sets the worker count, the tile size and the mesh task grain */
+    void ApplyTuning();
+    /** @brief Restarts the workers of the job system, see StopGeneration */
+    void SetWorkerCount(uint32_t workerCount);
+    /**
+     * @brief Times the alternative paths of the generation with the current
+     *  settings, see Benchmark. Restarts the running generation.
+     */
+    void RunBenchmark();
+
+    /**
+     * @brief Generates the mesh of the terrain from the noise map, only its
+     *  exposed part when the map was panned since, see
+     *  ProceduralTexture2D::GetValueShift. Does not upload it.
+     */
+    static void GenerateTerrainMesh(Terrain& terrain, const ProceduralTexture2D& noiseMap);
+
+    /** @return False if the maps are generated on the render thread */
+    bool UseAsyncGeneration() const;
+    /**
+     * @brief Regenerates the noise map, the terrain or both with the current
+     *  settings in the background. Supersedes the pending request and
+     *  cancels the running generation.
+     * @param preview Shows coarse levels of the noise map on the terrain
+     *  first, see s_kPreviewStrides
+     */
+    void RequestGeneration(bool noise, bool terrain, bool preview = false);
+    /** @brief Drops the running and the pending generation */
+    void CancelGeneration();
+    /**
+     * @brief Cancels the generation and waits for its task, before the job
+     *  system or the maps are changed under it. Its work is requested again.
+     */
+    void StopGeneration();
+    /** @brief Swaps in the finished generation and starts the pending one */
+    void UpdateGeneration();
+    void StartGeneration();
+    void FinishGeneration();
+    /**
+     * @brief Runs the generation as a task of the job system, or in slices
+     *  of the frame budget on the render thread when it has no workers
+     */
+    void SubmitGeneration(const char* name, std::function<void()> function);
+    bool IsGenerationRunning() const;
+
     void ShowInterface();
     void StatusWindow();
 
@@ -94,9 +158,68 @@ private:
 
     std::shared_ptr<ProceduralTexture2D> m_NoiseMap;
     glm::uvec2 m_TextureSize{ 512 };
+    std::string m_ComputeBackendError;  ///< Why the compute shader did not compile
 
     std::unique_ptr<Terrain> m_Terrain;
     std::shared_ptr<sgl::Shader> m_TerrainShader;
+    glm::uvec2 m_TerrainSize{ 0 };      ///< Of the next generation
+
+    // -------------------------------------------------------------------------
+    // Background generation, the back buffers are generated by a task of the
+    //  job system while the front ones are rendered
+
+    struct GenerationRequest
+    {
+        bool noise{ false };
+        bool terrain{ false };
+        bool preview{ false };
+        uint32_t stride{ 0 };   ///< Of the level generated, 0 to start from the coarsest
+        std::chrono::steady_clock::time_point time;
+    };
+
+    std::shared_ptr<ProceduralTexture2D> m_BackNoiseMap;
+    std::unique_ptr<Terrain> m_BackTerrain;     ///< Bound to the back noise map
+
+    bool m_AsyncGeneration{ true };
+    GenerationRequest m_PendingGeneration;
+    GenerationRequest m_RunningGeneration;
+    JobSystem::TaskRef m_GenerationTask;
+    std::atomic<bool> m_CancelGeneration{ false };
+
+    /** @brief Resumed by UpdateGeneration for m_FrameBudget each frame */
+    std::unique_ptr<ResumableTask> m_SlicedGeneration;
+    float m_FrameBudget{ 4.0f };        ///< In ms
+    float m_LastSliceDuration{ 0.0f };  ///< In ms
+
+    float m_GenerationLatency{ 0.0f };  ///< From the request to the swap, in ms
+    uint32_t m_DroppedGenerations{ 0 };
+
+    /**
+     * @brief Strides of the coarse levels generated while a setting is
+     *  dragged, each level keeps the samples of the previous one
+     */
+    static constexpr std::array<uint32_t, 2> s_kPreviewStrides{ 8, 4 };
+
+    /** @brief Of the back noise map's preview, drawn until the generation is swapped in */
+    std::unique_ptr<Terrain> m_PreviewTerrain;
+    bool m_ProgressivePreview{ true };
+    bool m_ShowPreview{ false };
+    glm::vec2 m_PreviewRange{ 0.0f };   ///< Of the preview heights
+
+    struct JobTiming
+    {
+        double durationMs{ 0.0 };
+        uint32_t taskCount{ 0 };
+    };
+
+    /** @brief Written by the workers, see InstallJobProfileHook */
+    std::map<std::string, JobTiming> m_JobTimings;
+    std::mutex m_JobTimingMutex;
+
+    /** @brief Loaded or calibrated at startup, the settings override it */
+    AutoTuner::Config m_Tuning;
+    std::vector<Benchmark::Result> m_BenchmarkResults;
+    static constexpr uint32_t s_kMaxCalibrationSize = 1024;
 
     std::unique_ptr<sgl::Texture2DArray> m_TexArray;
     int32_t m_TexArrayTexWidth = 512;
@@ -128,13 +251,14 @@ private:
         float scale;
         float tintStrength;
         float blendStrength;
+        glm::vec2 moisture;  ///< Range of the moisture channel the region grows in
 
         Region();
         Region(int id);
         Region(const std::string& name);
         Region(float startHeight, const std::string& name, Color tint,
                int texIndex, float scale, float tintStrength,
-               float blendStrength);
+               float blendStrength, glm::vec2 moisture = glm::vec2(0, 1));
     };
 
     std::vector<Region> m_Regions{
@@ -142,7 +266,7 @@ private:
         { 0.1, "Water Shallow", Color(54, 103, 199)/255.f, TEX_WATER, 2.0, 0.1, 0.2 },
         { 0.15, "Sand", Color(210, 208, 125)/255.f, TEX_SAND, 2.0, 0.1, 0.2 },
         { 0.2, "Grass", Color(86, 152, 23)/255.f, TEX_GRASS, 2.0, 0.1, 0.2 },
-        { 0.3, "Trees", Color(62, 107, 18)/255.f, TEX_STONY_GRASS, 2.0, 0.1, 0.2 },
+        { 0.3, "Trees", Color(62, 107, 18)/255.f, TEX_STONY_GRASS, 2.0, 0.1, 0.2, { 0.45, 1.0 } },
         { 0.6, "Rock", Color(90, 69, 60)/255.f, TEX_ROCKY, 2.0, 0.1, 0.2 },
         { 0.8, "Higher Rock", Color(75, 60, 53)/255.f, TEX_MOUNTAINS, 2.0, 0.1, 0.2 },
         { 0.9, "Snow", Color(1.0, 1.0, 1.0), TEX_SNOW, 2.0, 0.1, 0.2 },
@@ -150,6 +274,10 @@ private:
 
     static constexpr Color s_kDefaultColor{ 1.0 };
 
+    // Region selection by the noise channels, see ProceduralTexture2D::Channel
+    float m_TemperatureShift{ 0.3f };
+    float m_DetailStrength{ 0.05f };
+
     // -------------------------------------------------------------------------
     // Uniform Buffers
 
@@ -163,6 +291,7 @@ private:
         float startHeight;
         glm::vec3 tint;
         float tintStrength;
+        alignas(16) glm::vec2 moisture;
     };
 
     struct TerrainUBO
@@ -170,6 +299,9 @@ private:
         float minHeight;
         float maxHeight;
         int regionCount;
+        int useChannels;
+        float temperatureShift;
+        float detailStrength;
         alignas(16) RegionUBO regions[s_kMaxRegionCount];
     };
 
@@ -208,6 +340,8 @@ private:
                           s_kTerrainFS = PREFIX "shaders/Terrain.frag",
                           s_kTerrainShaderName = "terrain";
 
+    static constexpr auto s_kNoiseCS = PREFIX "shaders/FractalNoise.comp";
+
     static constexpr Skybox::FacesPaths s_kSkyboxTexturePaths {
         PREFIX "textures/skybox/right.jpg",
         PREFIX "textures/skybox/left.jpg",
@@ -0,0 +1,159 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "ResumableTask.h"
+
+#include <thread>
+
+
+// Task whose function runs on the calling thread, if any
+static thread_local ResumableTask* s_Current = nullptr;
+
+/**
+ * @brief Thread the function of a task runs on. It waits for the next
+ *  function once one returned, so a task does not start an OS thread.
+ */
+class ResumableTask::HandoffThread
+{
+public:
+    HandoffThread()
+        : m_Thread(&HandoffThread::Loop, this) {}
+
+    ~HandoffThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_Condition.notify_all();
+        m_Thread.join();
+    }
+
+    /** @brief Runs the function next, the previous one returned */
+    void Start(std::function<void()> function)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Function = std::move(function);
+        }
+        m_Condition.notify_all();
+    }
+
+private:
+    void Loop()
+    {
+        for (;;)
+        {
+            std::function<void()> function;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Condition.wait(lock, [this]() { return m_Function || m_Stopping; });
+                if (!m_Function)
+                    return;
+                function.swap(m_Function);
+            }
+            function();
+        }
+    }
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::function<void()> m_Function;
+    bool m_Stopping{ false };
+    std::thread m_Thread;
+};
+
+std::mutex ResumableTask::s_IdleMutex;
+std::vector<std::unique_ptr<ResumableTask::HandoffThread>> ResumableTask::s_IdleThreads;
+
+// =============================================================================
+
+ResumableTask::ResumableTask(Function function)
+    : m_Function(std::move(function))
+{
+
+}
+
+ResumableTask::~ResumableTask()
+{
+    while (m_Thread)
+        Resume(std::chrono::seconds(1));
+}
+
+bool ResumableTask::Resume(Clock::duration budget)
+{
+    if (m_Done)
+        return true;
+
+    m_Deadline = Clock::now() + budget;
+    ++m_SliceCount;
+
+    if (!m_Thread)
+    {
+        {
+            std::lock_guard<std::mutex> lock(s_IdleMutex);
+            if (!s_IdleThreads.empty())
+            {
+                m_Thread = std::move(s_IdleThreads.back());
+                s_IdleThreads.pop_back();
+            }
+        }
+        if (!m_Thread)
+            m_Thread = std::make_unique<HandoffThread>();
+
+        // The function has control from its first instruction
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_InFunction = true;
+        }
+        m_Thread->Start([this]() { Run(); });
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.wait(lock, [this]() { return !m_InFunction; });
+    }
+    else
+        Switch(true);
+
+    // The thread only leaves Run once done, the next task may start it
+    if (m_Done)
+    {
+        std::lock_guard<std::mutex> lock(s_IdleMutex);
+        s_IdleThreads.push_back(std::move(m_Thread));
+    }
+    return m_Done;
+}
+
+void ResumableTask::Run()
+{
+    s_Current = this;
+    m_Function();
+    m_Function = nullptr;
+    s_Current = nullptr;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Done = true;
+    m_InFunction = false;
+    m_Condition.notify_all();
+}
+
+void ResumableTask::Switch(bool toFunction)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_InFunction = toFunction;
+    m_Condition.notify_all();
+    m_Condition.wait(lock, [this, toFunction]() { return m_InFunction != toFunction; });
+}
+
+void ResumableTask::Yield(const char* stage, float progress)
+{
+    ResumableTask* task = s_Current;
+    if (!task)
+        return;
+
+    task->m_Stage = stage;
+    task->m_StageProgress = progress;
+    if (Clock::now() >= task->m_Deadline)
+        task->Switch(false);
+}
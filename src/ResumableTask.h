@@ -0,0 +1,84 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+/**
+ * @brief Function run in slices of the caller's time, for machines where a
+ *  background thread has no core of its own. The function runs on a stack of
+ *  its own, a thread that only runs while Resume waits for it, and gives
+ *  control back at the first Yield past the deadline of the slice. The
+ *  threads are kept once their function returned and run the functions of
+ *  the next tasks. The function must return soon once asked to, see the
+ *  destructor.
+ */
+class ResumableTask
+{
+public:
+    using Function = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief The function first runs on Resume */
+    explicit ResumableTask(Function function);
+    /** @brief Resumes the function until it returned, cancel it first */
+    ~ResumableTask();
+
+    ResumableTask(const ResumableTask&) = delete;
+    ResumableTask& operator=(const ResumableTask&) = delete;
+
+    /**
+     * @brief Runs the function until it yields after budget or returns
+     * @return True once the function returned
+     */
+    bool Resume(Clock::duration budget);
+    bool IsDone() const { return m_Done; }
+
+    /** @brief Stage of the last Yield, a static string */
+    const char* GetStage() const { return m_Stage; }
+    /** @return Progress of the stage of the last Yield, in [0,1] */
+    float GetStageProgress() const { return m_StageProgress; }
+    uint32_t GetSliceCount() const { return m_SliceCount; }
+
+    /**
+     * @brief Called by the function between pieces of work, returns to
+     *  Resume once the slice is used up. No-op outside of a resumable task.
+     * @param stage Static string, see GetStage
+     */
+    static void Yield(const char* stage, float progress);
+
+private:
+    class HandoffThread;
+
+    void Run();
+    /** @brief Hands control to the other thread and waits to get it back */
+    void Switch(bool toFunction);
+
+    /** @brief Threads whose function returned, joined at exit */
+    static std::mutex s_IdleMutex;
+    static std::vector<std::unique_ptr<HandoffThread>> s_IdleThreads;
+
+    Function m_Function;
+    /** @brief From the first Resume until the function returned */
+    std::unique_ptr<HandoffThread> m_Thread;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    bool m_InFunction{ false };     ///< The function has control
+    bool m_Done{ false };
+    Clock::time_point m_Deadline;
+
+    // Only one of the threads runs at a time, the switches order the accesses
+    const char* m_Stage{ "" };
+    float m_StageProgress{ 0.0f };
+    uint32_t m_SliceCount{ 0 };
+};
@@ -3,6 +3,8 @@
  * (http://opensource.org/licenses/MIT)
  */
 
+#include <cstring>
+
 #include "ProceduralTerrain.h"
 
 
@@ -11,5 +13,11 @@ int main(int argc, char* argv[])
   sgl::Init();
 
   auto app = ProceduralTerrain();
+
+  // Times the generation before the first frame, see ProceduralTerrain::Calibrate
+  for (int i = 1; i < argc; ++i)
+    if (std::strcmp(argv[i], "--calibrate") == 0)
+      app.Calibrate();
+
   app.Run();
 }
@@ -5,33 +5,374 @@
 
 #pragma once
 
+#include <cmath>
+#include <vector>
+
 #include "PerlinNoise.h"
+#include "ScratchBuffer.h"
+#include "SimplexNoise.h"
+#include "WorleyNoise.h"
 
 
-/** 
- * @brief Fractal noise generator based on *Perlin Noise*
+/** @brief Lattice noise function summed across the octaves */
+enum class NoiseBasis
+{
+    Perlin = 0,
+    Simplex,
+    Worley
+};
+
+/**
+ * @brief Fractal noise generator based on *Perlin Noise*, *Simplex Noise* or
+ *  *Worley Noise*.
+ *  The basis is resolved once per call, the octave loops are shared.
  */
 template <typename T>
 class FractalNoise
 {
 public:
-    
+
     FractalNoise(const PerlinNoise<T>& perlinNoise,
                  T scale = (T)1,
-                 T offset = (T)0,
+                 const glm::vec<3, T>& offset = glm::vec<3, T>(0),
                  uint32_t octaves = 6,
                  T gain = (T)0.5,
                  T lacunarity = (T)2)
         : perlinNoise(perlinNoise),
+          simplexNoise(perlinNoise.GetSeed()),
+          worleyNoise(perlinNoise.GetSeed()),
+          octaveCount(octaves),
           scale(scale),
           offset(offset),
-          octaveCount(octaves),
           gain(gain),
           lacunarity(lacunarity) {}
 
+    /** @brief Reseeds all basis functions and regenerates their permutations */
+    void SetSeed(int32_t seed)
+    {
+        perlinNoise.SetSeed(seed);
+        perlinNoise.GeneratePermutations();
+        simplexNoise.SetSeed(seed);
+        simplexNoise.GeneratePermutations();
+        worleyNoise.SetSeed(seed);
+        worleyNoise.GeneratePermutations();
+    }
+
+    int32_t GetSeed() const { return perlinNoise.GetSeed(); }
+
     /** @return 3D Fractal noise value in [0,1] */
-    T Noise(T x, T y, T z)
+    T Noise(T x, T y, T z) const
+    {
+        return WithBasis([&](const auto& basisNoise) {
+            return SumOctaves(basisNoise, x, y, z);
+        });
+    }
+
+    /** @return 2D Fractal noise value in [0,1] */
+    T Noise(T x, T y) const
+    {
+        return WithBasis([&](const auto& basisNoise) {
+            return SumOctaves(basisNoise, x, y);
+        });
+    }
+
+    /**
+     * @return 2D Fractal noise value in [0,1] and its partial derivatives,
+     *  summed across the octaves by the chain rule, x: value, y: d/dx, z: d/dy
+     */
+    glm::vec<3, T> NoiseDeriv(T x, T y) const
+    {
+        return WithBasis([&](const auto& basisNoise) {
+            return SumOctavesDeriv(basisNoise, x, y);
+        });
+    }
+
+    /**
+     * @return 3D Fractal noise value in [0,1] and its partial derivatives,
+     *  x: value, yzw: d/dx, d/dy, d/dz
+     */
+    glm::vec<4, T> NoiseDeriv(T x, T y, T z) const
+    {
+        return WithBasis([&](const auto& basisNoise) {
+            return SumOctavesDeriv(basisNoise, x, y, z);
+        });
+    }
+
+    /**
+     * @brief Evaluates out[i] = Noise(xs[i], ys[i], zs[i]) for n samples,
+     *  octave by octave, using the batched NoiseN of the basis
+     */
+    void NoiseN(const T* xs, const T* ys, const T* zs, T* out, size_t n) const
+    {
+        WithBasis([&](const auto& basisNoise) {
+            SumOctavesN(basisNoise, xs, ys, zs, out, n);
+        });
+    }
+
+    /** @brief Evaluates out[i] = Noise(xs[i], ys[i]) for n samples */
+    void NoiseN(const T* xs, const T* ys, T* out, size_t n) const
+    {
+        WithBasis([&](const auto& basisNoise) {
+            SumOctavesN(basisNoise, xs, ys, out, n);
+        });
+    }
+
+    /**
+     * @brief Evaluates 2D fractal noise in [0,1] that tiles exactly every
+     *  periodX x periodY units for n samples. The lattice of each octave
+     *  wraps after the whole number of cells closest to the period, so the
+     *  features keep about the size of the scale and the frequency. The
+     *  positions are wrapped to the period first, opposite edges of the tile
+     *  then sample the same points and are bit-identical. Simplex noise has
+     *  no square lattice to wrap, it falls back to Perlin noise.
+     */
+    void NoisePeriodicN(const T* xs, const T* ys, T periodX, T periodY,
+                        T* out, size_t n) const
+    {
+        if (basis == NoiseBasis::Worley)
+            SumOctavesPeriodicN(worleyNoise, xs, ys, periodX, periodY, out, n);
+        else
+            SumOctavesPeriodicN(perlinNoise, xs, ys, periodX, periodY, out, n);
+    }
+
+    /**
+     * @brief Evaluates channelCount decorrelated 2D fractal noises in [0,1]
+     *  for n samples in one traversal of the octaves. Channel c is the noise
+     *  shifted by offsets[c] lattice cells, see PerlinNoise::NoiseChannelsN,
+     *  and sums only its first octaves[c] octaves. A channel with the offset
+     *  0 and all octaves equals NoiseN().
+     * @param[out] out Planar, channel c at out + c*n
+     */
+    void NoiseChannelsN(const int32_t* offsets, const uint32_t* octaves,
+                        uint32_t channelCount,
+                        const T* xs, const T* ys, T* out, size_t n) const
+    {
+        WithBasis([&](const auto& basisNoise) {
+            SumOctavesChannelsN(basisNoise, offsets, octaves, channelCount,
+                                xs, ys, out, n);
+        });
+    }
+
+    /**
+     * @brief Evaluates out[i] = Noise(x0 + i*dx, y, z) for count samples.
+     *  The sample transform is hoisted out of the row, one multiplication per
+     *  octave instead of a division per sample and axis, and each octave is
+     *  evaluated by the NoiseRow of the basis.
+     */
+    void NoiseRow(T y, T z, T x0, T dx, size_t count, T* out) const
+    {
+        WithBasis([&](const auto& basisNoise) {
+            SumOctavesRow(basisNoise, y, &z, x0, dx, count, out);
+        });
+    }
+
+    /** @brief Evaluates out[i] = Noise(x0 + i*dx, y) for count samples */
+    void NoiseRow(T y, T x0, T dx, size_t count, T* out) const
+    {
+        WithBasis([&](const auto& basisNoise) {
+            SumOctavesRow(basisNoise, y, nullptr, x0, dx, count, out);
+        });
+    }
+
+    /**
+     * @brief Evaluates out[i] = Noise(x0 + i*dx, y, z) for count samples with
+     *  the lattice coordinates computed in double and split into cell and
+     *  fraction by the basis, so that high octaves keep their precision at
+     *  large offsets. The noise itself is still evaluated in T.
+     */
+    void NoiseRowSplit(double y, double z, double x0, double dx,
+                       size_t count, T* out) const
     {
+        WithBasis([&](const auto& basisNoise) {
+            SumOctavesRowSplit(basisNoise, y, &z, x0, dx, count, out);
+        });
+    }
+
+    /** @brief 2D variant of NoiseRowSplit */
+    void NoiseRowSplit(double y, double x0, double dx, size_t count, T* out) const
+    {
+        WithBasis([&](const auto& basisNoise) {
+            SumOctavesRowSplit(basisNoise, y, nullptr, x0, dx, count, out);
+        });
+    }
+
+    /**
+     * @brief Evaluates the raw basis noise in [-1,1] of a single octave for n
+     *  samples, summing the layers weighted by the amplitudes gives NoiseN
+     */
+    void OctaveN(uint32_t octave,
+                 const T* xs, const T* ys, const T* zs, T* out, size_t n) const
+    {
+        const T kFrequency = GetFrequency(octave);
+
+        T* sampleX = Scratch<0>(n);
+        T* sampleY = Scratch<1>(n);
+        T* sampleZ = Scratch<2>(n);
+        for (size_t s = 0; s < n; ++s)
+        {
+            sampleX[s] = (xs[s] + offset.x) / scale * kFrequency;
+            sampleY[s] = (ys[s] + offset.y) / scale * kFrequency;
+            sampleZ[s] = (zs[s] + offset.z) / scale * kFrequency;
+        }
+
+        WithBasis([&](const auto& basisNoise) {
+            basisNoise.NoiseN(sampleX, sampleY, sampleZ, out, n);
+        });
+    }
+
+    /** @brief 2D variant of OctaveN */
+    void OctaveN(uint32_t octave, const T* xs, const T* ys, T* out, size_t n) const
+    {
+        const T kFrequency = GetFrequency(octave);
+
+        T* sampleX = Scratch<0>(n);
+        T* sampleY = Scratch<1>(n);
+        for (size_t s = 0; s < n; ++s)
+        {
+            sampleX[s] = (xs[s] + offset.x) / scale * kFrequency;
+            sampleY[s] = (ys[s] + offset.y) / scale * kFrequency;
+        }
+
+        WithBasis([&](const auto& basisNoise) {
+            basisNoise.NoiseN(sampleX, sampleY, out, n);
+        });
+    }
+
+    /**
+     * @return Frequency of the octave, accumulated the same way as in the
+     *  octave loops so that the samples match exactly
+     */
+    T GetFrequency(uint32_t octave) const
+    {
+        T frequency = (T)1;
+        for (uint32_t i = 0; i < octave; ++i)
+            frequency *= lacunarity;
+        return frequency;
+    }
+
+    /**
+     * @return Number of leading octaves evaluated by Noise, NoiseN and
+     *  NoiseRow. The octaves behind are faded out by the target spacing or
+     *  their amplitudes sum up to less than half the precision, so dropping
+     *  them cannot change the stored value.
+     */
+    uint32_t GetOctaveBudget() const { return CountOctaves(precision); }
+
+    /**
+     * @return Number of leading octaves evaluated by NoiseDeriv, only the
+     *  target spacing applies, the derivatives grow with the frequency
+     */
+    uint32_t GetDerivOctaveBudget() const { return CountOctaves((T)0); }
+
+    /**
+     * @return Weight of the octave in [0,1] by its wavelength, 1 down to twice
+     *  the target spacing and fading out log-linearly to 0 at the spacing
+     */
+    T GetOctaveFade(uint32_t octave) const { return SpacingFade(GetFrequency(octave)); }
+
+private:
+
+    /** @brief Per thread scratch of the octave loops, see GetScratchBuffer */
+    template <uint32_t Slot>
+    static T* Scratch(size_t n) { return GetScratchBuffer<T, FractalNoise, Slot>(n); }
+
+    T SpacingFade(T frequency) const
+    {
+        if (targetSpacing <= (T)0)
+            return (T)1;
+
+        const T kWavelength = scale / frequency;
+        return glm::clamp(std::log2(kWavelength / targetSpacing), (T)0, (T)1);
+    }
+
+    /** @param precisionLimit Zero keeps all octaves up to the faded out ones */
+    uint32_t CountOctaves(T precisionLimit) const
+    {
+        uint32_t count = 0;
+        T total = (T)0;
+        T max = (T)0;
+        T frequency = (T)1;
+        T amplitude = (T)1;
+
+        for (uint32_t i = 0; i < octaveCount; ++i)
+        {
+            const T kWeight = amplitude * SpacingFade(frequency);
+            if (kWeight > (T)0)
+                count = i + 1;
+            total += kWeight;
+            max += amplitude;
+
+            amplitude *= gain;
+            frequency *= lacunarity;
+        }
+
+        if (precisionLimit <= (T)0)
+            return count;
+
+        // The noise is within about [-1,1] and the sum is mapped by
+        // (sum / max + 1) / 2, a dropped tail of amplitudes changes the value
+        // by at most tail / (2 max)
+        const T kThreshold = precisionLimit * max;
+        T tail = total;
+        frequency = (T)1;
+        amplitude = (T)1;
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (i > 0 && tail < kThreshold)
+                return i;
+            tail -= amplitude * SpacingFade(frequency);
+
+            amplitude *= gain;
+            frequency *= lacunarity;
+        }
+        return count;
+    }
+
+    /**
+     * @return CountOctaves memoized per thread on the settings it depends on,
+     *  the per sample octave loops would otherwise recount it every sample.
+     *  The settings are public, so the cache compares them instead of being
+     *  invalidated by setters.
+     */
+    uint32_t CountOctavesCached(T precisionLimit) const
+    {
+        struct Cache
+        {
+            bool valid;
+            uint32_t octaveCount;
+            T scale, gain, lacunarity, targetSpacing, precisionLimit;
+            uint32_t count;
+        };
+        thread_local Cache s_Cache{};
+
+        if (!s_Cache.valid || s_Cache.octaveCount != octaveCount ||
+            s_Cache.scale != scale || s_Cache.gain != gain ||
+            s_Cache.lacunarity != lacunarity || s_Cache.targetSpacing != targetSpacing ||
+            s_Cache.precisionLimit != precisionLimit)
+        {
+            s_Cache = { true, octaveCount, scale, gain, lacunarity, targetSpacing,
+                        precisionLimit, CountOctaves(precisionLimit) };
+        }
+        return s_Cache.count;
+    }
+
+    /** @brief Calls func with the selected basis noise */
+    template <typename Func>
+    auto WithBasis(Func&& func) const
+    {
+        switch (basis)
+        {
+        case NoiseBasis::Simplex: return func(simplexNoise);
+        case NoiseBasis::Worley:  return func(worleyNoise);
+        default:                  return func(perlinNoise);
+        }
+    }
+
+    template <typename Basis>
+    T SumOctaves(const Basis& basisNoise, T x, T y, T z) const
+    {
+        const uint32_t kBudget = CountOctavesCached(precision);
         T sum = 0;
         T max = (T)0;
         T frequency = (T)1;
@@ -39,12 +380,17 @@ public:
 
         for (uint32_t i = 0; i < octaveCount; ++i)
         {
-            T noiseVal = perlinNoise.Noise(
-                (x + offset) / scale * frequency,
-                (y + offset) / scale * frequency,
-                (z + offset) / scale * frequency); // * (T)2 - (T)1 ;
+            const T kWeight = i < kBudget ? amplitude * SpacingFade(frequency) : (T)0;
+            if (kWeight > (T)0)
+            {
+                T noiseVal = basisNoise.Noise(
+                    (x + offset.x) / scale * frequency,
+                    (y + offset.y) / scale * frequency,
+                    (z + offset.z) / scale * frequency); // * (T)2 - (T)1 ;
+
+                sum += noiseVal * kWeight;
+            }
 
-            sum += noiseVal * amplitude;
             max += amplitude;
 
             amplitude *= gain;
@@ -55,12 +401,431 @@ public:
         return (sum + (T)1.0) / (T)2.0;
     }
 
+    template <typename Basis>
+    T SumOctaves(const Basis& basisNoise, T x, T y) const
+    {
+        const uint32_t kBudget = CountOctavesCached(precision);
+        T sum = 0;
+        T max = (T)0;
+        T frequency = (T)1;
+        T amplitude = (T)1;
+
+        for (uint32_t i = 0; i < octaveCount; ++i)
+        {
+            const T kWeight = i < kBudget ? amplitude * SpacingFade(frequency) : (T)0;
+            if (kWeight > (T)0)
+            {
+                T noiseVal = basisNoise.Noise(
+                    (x + offset.x) / scale * frequency,
+                    (y + offset.y) / scale * frequency);
+
+                sum += noiseVal * kWeight;
+            }
+
+            max += amplitude;
+
+            amplitude *= gain;
+            frequency *= lacunarity;
+        }
+
+        sum = sum / max;
+        return (sum + (T)1.0) / (T)2.0;
+    }
+
+    template <typename Basis>
+    glm::vec<3, T> SumOctavesDeriv(const Basis& basisNoise, T x, T y) const
+    {
+        const uint32_t kBudget = CountOctavesCached((T)0);
+        T sum = 0;
+        glm::vec<2, T> sumDeriv(0);
+        T max = (T)0;
+        T frequency = (T)1;
+        T amplitude = (T)1;
+
+        for (uint32_t i = 0; i < octaveCount; ++i)
+        {
+            const T kWeight = i < kBudget ? amplitude * SpacingFade(frequency) : (T)0;
+            if (kWeight > (T)0)
+            {
+                const glm::vec<3, T> kNoise = basisNoise.NoiseDeriv(
+                    (x + offset.x) / scale * frequency,
+                    (y + offset.y) / scale * frequency);
+
+                // d/dx of the sample position is frequency / scale
+                sum += kNoise.x * kWeight;
+                sumDeriv += glm::vec<2, T>(kNoise.y, kNoise.z) *
+                            (kWeight * frequency / scale);
+            }
+
+            max += amplitude;
+
+            amplitude *= gain;
+            frequency *= lacunarity;
+        }
+
+        sum = sum / max;
+        sumDeriv = sumDeriv / (max * (T)2.0);
+        return glm::vec<3, T>((sum + (T)1.0) / (T)2.0, sumDeriv.x, sumDeriv.y);
+    }
+
+    template <typename Basis>
+    glm::vec<4, T> SumOctavesDeriv(const Basis& basisNoise, T x, T y, T z) const
+    {
+        const uint32_t kBudget = CountOctavesCached((T)0);
+        T sum = 0;
+        glm::vec<3, T> sumDeriv(0);
+        T max = (T)0;
+        T frequency = (T)1;
+        T amplitude = (T)1;
+
+        for (uint32_t i = 0; i < octaveCount; ++i)
+        {
+            const T kWeight = i < kBudget ? amplitude * SpacingFade(frequency) : (T)0;
+            if (kWeight > (T)0)
+            {
+                const glm::vec<4, T> kNoise = basisNoise.NoiseDeriv(
+                    (x + offset.x) / scale * frequency,
+                    (y + offset.y) / scale * frequency,
+                    (z + offset.z) / scale * frequency);
+
+                sum += kNoise.x * kWeight;
+                sumDeriv += glm::vec<3, T>(kNoise.y, kNoise.z, kNoise.w) *
+                            (kWeight * frequency / scale);
+            }
+
+            max += amplitude;
+
+            amplitude *= gain;
+            frequency *= lacunarity;
+        }
+
+        sum = sum / max;
+        sumDeriv = sumDeriv / (max * (T)2.0);
+        return glm::vec<4, T>((sum + (T)1.0) / (T)2.0,
+                              sumDeriv.x, sumDeriv.y, sumDeriv.z);
+    }
+
+    /** @return Position wrapped to [0,period) */
+    static T WrapPeriod(T x, T period)
+    {
+        const T kWrapped = x - period * glm::floor(x / period);
+        return kWrapped >= period ? kWrapped - period
+                                  : kWrapped < (T)0 ? kWrapped + period : kWrapped;
+    }
+
+    template <typename Basis>
+    void SumOctavesPeriodicN(const Basis& basisNoise, const T* xs, const T* ys,
+                             T periodX, T periodY, T* out, size_t n) const
+    {
+        T* tileX = Scratch<0>(n);
+        T* tileY = Scratch<1>(n);
+        T* sampleX = Scratch<2>(n);
+        T* sampleY = Scratch<3>(n);
+        T* noiseVals = Scratch<4>(n);
+        std::fill_n(out, n, (T)0);
+
+        // Position within the tile in [0,1)
+        for (size_t s = 0; s < n; ++s)
+        {
+            tileX[s] = WrapPeriod(xs[s], periodX) / periodX;
+            tileY[s] = WrapPeriod(ys[s], periodY) / periodY;
+        }
+
+        const uint32_t kBudget = CountOctaves(precision);
+        T max = (T)0;
+        T frequency = (T)1;
+        T amplitude = (T)1;
+
+        for (uint32_t i = 0; i < octaveCount; ++i)
+        {
+            const T kWeight = i < kBudget ? amplitude * SpacingFade(frequency) : (T)0;
+            if (kWeight > (T)0)
+            {
+                const T kCellsX = glm::max((T)1, glm::round(periodX / scale * frequency));
+                const T kCellsY = glm::max((T)1, glm::round(periodY / scale * frequency));
+                const T kShiftX = offset.x / scale * frequency;
+                const T kShiftY = offset.y / scale * frequency;
+
+                for (size_t s = 0; s < n; ++s)
+                {
+                    sampleX[s] = tileX[s] * kCellsX + kShiftX;
+                    sampleY[s] = tileY[s] * kCellsY + kShiftY;
+                }
+
+                basisNoise.NoisePeriodicN(sampleX, sampleY, kCellsX, kCellsY, noiseVals, n);
+
+                for (size_t s = 0; s < n; ++s)
+                    out[s] += noiseVals[s] * kWeight;
+            }
+
+            max += amplitude;
+
+            amplitude *= gain;
+            frequency *= lacunarity;
+        }
+
+        for (size_t s = 0; s < n; ++s)
+            out[s] = (out[s] / max + (T)1.0) / (T)2.0;
+    }
+
+    template <typename Basis>
+    void SumOctavesN(const Basis& basisNoise,
+                     const T* xs, const T* ys, const T* zs, T* out, size_t n) const
+    {
+        T* sampleX = Scratch<0>(n);
+        T* sampleY = Scratch<1>(n);
+        T* sampleZ = Scratch<2>(n);
+        T* noiseVals = Scratch<3>(n);
+        std::fill_n(out, n, (T)0);
+
+        const uint32_t kBudget = CountOctaves(precision);
+        T max = (T)0;
+        T frequency = (T)1;
+        T amplitude = (T)1;
+
+        for (uint32_t i = 0; i < octaveCount; ++i)
+        {
+            const T kWeight = i < kBudget ? amplitude * SpacingFade(frequency) : (T)0;
+            if (kWeight > (T)0)
+            {
+                for (size_t s = 0; s < n; ++s)
+                {
+                    sampleX[s] = (xs[s] + offset.x) / scale * frequency;
+                    sampleY[s] = (ys[s] + offset.y) / scale * frequency;
+                    sampleZ[s] = (zs[s] + offset.z) / scale * frequency;
+                }
+
+                basisNoise.NoiseN(sampleX, sampleY, sampleZ, noiseVals, n);
+
+                for (size_t s = 0; s < n; ++s)
+                    out[s] += noiseVals[s] * kWeight;
+            }
+
+            max += amplitude;
+
+            amplitude *= gain;
+            frequency *= lacunarity;
+        }
+
+        for (size_t s = 0; s < n; ++s)
+            out[s] = (out[s] / max + (T)1.0) / (T)2.0;
+    }
+
+    template <typename Basis>
+    void SumOctavesChannelsN(const Basis& basisNoise,
+                             const int32_t* offsets, const uint32_t* octaves,
+                             uint32_t channelCount,
+                             const T* xs, const T* ys, T* out, size_t n) const
+    {
+        T* sampleX = Scratch<0>(n);
+        T* sampleY = Scratch<1>(n);
+        T* noiseVals = Scratch<2>(n * channelCount);
+        T* max = Scratch<3>(channelCount);
+        std::fill_n(max, channelCount, (T)0);
+        // Channels still summing at the current octave
+        int32_t* activeOffsets = GetScratchBuffer<int32_t, FractalNoise, 4>(channelCount);
+        uint32_t* activeChannels = GetScratchBuffer<uint32_t, FractalNoise, 5>(channelCount);
+        std::fill_n(out, n * channelCount, (T)0);
+
+        const uint32_t kBudget = CountOctaves(precision);
+        T frequency = (T)1;
+        T amplitude = (T)1;
+
+        for (uint32_t i = 0; i < octaveCount; ++i)
+        {
+            const T kWeight = i < kBudget ? amplitude * SpacingFade(frequency) : (T)0;
+
+            uint32_t activeCount = 0;
+            for (uint32_t c = 0; c < channelCount; ++c)
+            {
+                if (i >= octaves[c])
+                    continue;
+
+                max[c] += amplitude;
+                if (kWeight > (T)0)
+                {
+                    activeOffsets[activeCount] = offsets[c];
+                    activeChannels[activeCount++] = c;
+                }
+            }
+
+            if (activeCount > 0)
+            {
+                for (size_t s = 0; s < n; ++s)
+                {
+                    sampleX[s] = (xs[s] + offset.x) / scale * frequency;
+                    sampleY[s] = (ys[s] + offset.y) / scale * frequency;
+                }
+
+                basisNoise.NoiseChannelsN(activeOffsets, activeCount,
+                                          sampleX, sampleY, noiseVals, n);
+
+                for (uint32_t a = 0; a < activeCount; ++a)
+                {
+                    const T* kNoise = noiseVals + a*n;
+                    T* channel = out + activeChannels[a]*n;
+                    for (size_t s = 0; s < n; ++s)
+                        channel[s] += kNoise[s] * kWeight;
+                }
+            }
+
+            amplitude *= gain;
+            frequency *= lacunarity;
+        }
+
+        for (uint32_t c = 0; c < channelCount; ++c)
+        {
+            T* channel = out + c*n;
+            for (size_t s = 0; s < n; ++s)
+                channel[s] = (channel[s] / max[c] + (T)1.0) / (T)2.0;
+        }
+    }
+
+    template <typename Basis>
+    void SumOctavesN(const Basis& basisNoise,
+                     const T* xs, const T* ys, T* out, size_t n) const
+    {
+        T* sampleX = Scratch<0>(n);
+        T* sampleY = Scratch<1>(n);
+        T* noiseVals = Scratch<2>(n);
+        std::fill_n(out, n, (T)0);
+
+        const uint32_t kBudget = CountOctaves(precision);
+        T max = (T)0;
+        T frequency = (T)1;
+        T amplitude = (T)1;
+
+        for (uint32_t i = 0; i < octaveCount; ++i)
+        {
+            const T kWeight = i < kBudget ? amplitude * SpacingFade(frequency) : (T)0;
+            if (kWeight > (T)0)
+            {
+                for (size_t s = 0; s < n; ++s)
+                {
+                    sampleX[s] = (xs[s] + offset.x) / scale * frequency;
+                    sampleY[s] = (ys[s] + offset.y) / scale * frequency;
+                }
+
+                basisNoise.NoiseN(sampleX, sampleY, noiseVals, n);
+
+                for (size_t s = 0; s < n; ++s)
+                    out[s] += noiseVals[s] * kWeight;
+            }
+
+            max += amplitude;
+
+            amplitude *= gain;
+            frequency *= lacunarity;
+        }
+
+        for (size_t s = 0; s < n; ++s)
+            out[s] = (out[s] / max + (T)1.0) / (T)2.0;
+    }
+
+    /** @param z Null for the 2D noise */
+    template <typename Basis>
+    void SumOctavesRow(const Basis& basisNoise, T y, const T* z,
+                       T x0, T dx, size_t count, T* out) const
+    {
+        T* noiseVals = Scratch<0>(count);
+        std::fill_n(out, count, (T)0);
+
+        const uint32_t kBudget = CountOctaves(precision);
+        T max = (T)0;
+        T frequency = (T)1;
+        T amplitude = (T)1;
+
+        for (uint32_t i = 0; i < octaveCount; ++i)
+        {
+            const T kWeight = i < kBudget ? amplitude * SpacingFade(frequency) : (T)0;
+            if (kWeight > (T)0)
+            {
+                const T kStep = frequency / scale;
+
+                if (z)
+                    basisNoise.NoiseRow((y + offset.y) * kStep, (*z + offset.z) * kStep,
+                                        (x0 + offset.x) * kStep, dx * kStep,
+                                        count, noiseVals);
+                else
+                    basisNoise.NoiseRow((y + offset.y) * kStep,
+                                        (x0 + offset.x) * kStep, dx * kStep,
+                                        count, noiseVals);
+
+                for (size_t s = 0; s < count; ++s)
+                    out[s] += noiseVals[s] * kWeight;
+            }
+
+            max += amplitude;
+
+            amplitude *= gain;
+            frequency *= lacunarity;
+        }
+
+        for (size_t s = 0; s < count; ++s)
+            out[s] = (out[s] / max + (T)1.0) / (T)2.0;
+    }
+
+    template <typename Basis>
+    void SumOctavesRowSplit(const Basis& basisNoise, double y, const double* z,
+                            double x0, double dx, size_t count, T* out) const
+    {
+        double* sampleX = GetScratchBuffer<double, FractalNoise, 0>(count);
+        double* sampleY = GetScratchBuffer<double, FractalNoise, 1>(count);
+        double* sampleZ = GetScratchBuffer<double, FractalNoise, 2>(z ? count : 0);
+        T* noiseVals = Scratch<0>(count);
+        std::fill_n(out, count, (T)0);
+
+        const uint32_t kBudget = CountOctaves(precision);
+        T max = (T)0;
+        T frequency = (T)1;
+        T amplitude = (T)1;
+
+        for (uint32_t i = 0; i < octaveCount; ++i)
+        {
+            const T kWeight = i < kBudget ? amplitude * SpacingFade(frequency) : (T)0;
+            if (kWeight > (T)0)
+            {
+                const double kStep = (double)frequency / (double)scale;
+
+                for (size_t s = 0; s < count; ++s)
+                    sampleX[s] = (x0 + (double)s * dx + (double)offset.x) * kStep;
+                std::fill_n(sampleY, count, (y + (double)offset.y) * kStep);
+
+                if (z)
+                {
+                    std::fill_n(sampleZ, count, (*z + (double)offset.z) * kStep);
+                    basisNoise.NoiseSplitN(sampleX, sampleY, sampleZ, noiseVals, count);
+                }
+                else
+                {
+                    basisNoise.NoiseSplitN(sampleX, sampleY, noiseVals, count);
+                }
+
+                for (size_t s = 0; s < count; ++s)
+                    out[s] += noiseVals[s] * kWeight;
+            }
+
+            max += amplitude;
+
+            amplitude *= gain;
+            frequency *= lacunarity;
+        }
+
+        for (size_t s = 0; s < count; ++s)
+            out[s] = (out[s] / max + (T)1.0) / (T)2.0;
+    }
+
 public:
     PerlinNoise<T> perlinNoise;
+    SimplexNoise<T> simplexNoise;
+    WorleyNoise<T> worleyNoise;
 
+    NoiseBasis basis{ NoiseBasis::Perlin };  ///< Lattice noise summed across the octaves
     uint32_t octaveCount{ 0 };  ///< Number of octaves
     T scale{ 0 };               ///< Scales the sample
-    T offset{ 0 };              ///< Offsets the sample
+    glm::vec<3, T> offset{ 0 }; ///< Offsets the sample, per axis
     T gain{ 0 };                ///< Scales amplitude, influence of each successive octave
     T lacunarity{ 0 };          ///< Scales frequency with each successive octave
+    T precision{ 0 };           ///< Step of the stored values, 0 evaluates all octaves
+    T targetSpacing{ 0 };       ///< Sample spacing octaves fade out at, 0 disables
 };
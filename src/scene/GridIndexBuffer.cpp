@@ -0,0 +1,225 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "GridIndexBuffer.h"
+
+#include <tuple>
+
+#define SGL_PROFILE
+#include <SGL/SGL.h>
+
+
+std::mutex GridIndexBuffer::s_CacheMutex;
+std::map<GridIndexBuffer::Key, std::shared_ptr<const GridIndexBuffer>> GridIndexBuffer::s_Cache;
+
+// The fixed restart index is the largest one of the type, no vertex may have it
+static constexpr uint32_t s_kMaxVertices16 = 0xFFFF;
+
+// =============================================================================
+
+std::shared_ptr<const GridIndexBuffer> GridIndexBuffer::Acquire(const glm::uvec2& size,
+                                                                Topology topology,
+                                                                bool& generated)
+{
+    // A band is generated under the lock, it takes well below a millisecond
+    std::lock_guard<std::mutex> lock(s_CacheMutex);
+
+    std::shared_ptr<const GridIndexBuffer>& indices = s_Cache[{ size, topology }];
+    generated = !indices;
+    if (generated)
+        indices = std::make_shared<const GridIndexBuffer>(size, topology);
+    return indices;
+}
+
+void GridIndexBuffer::ReleaseUnused()
+{
+    std::lock_guard<std::mutex> lock(s_CacheMutex);
+
+    // Only the cache holds them, no other thread can acquire them meanwhile
+    for (auto it = s_Cache.begin(); it != s_Cache.end(); )
+    {
+        if (it->second.use_count() == 1)
+            it = s_Cache.erase(it);
+        else
+            ++it;
+    }
+}
+
+size_t GridIndexBuffer::GetCacheCount()
+{
+    std::lock_guard<std::mutex> lock(s_CacheMutex);
+    return s_Cache.size();
+}
+
+size_t GridIndexBuffer::GetCacheBytes()
+{
+    std::lock_guard<std::mutex> lock(s_CacheMutex);
+
+    size_t bytes = 0;
+    for (const auto& kEntry : s_Cache)
+        bytes += kEntry.second->GetByteSize();
+    return bytes;
+}
+
+size_t GridIndexBuffer::GetByteSize(const glm::uvec2& size, Topology topology)
+{
+    bool is16Bit = false;
+    const size_t kIndexCount = static_cast<size_t>(GetBandRows(size, is16Bit)) *
+                               GetRowIndexCount(size, topology);
+    return kIndexCount * (is16Bit ? sizeof(uint16_t) : sizeof(uint32_t));
+}
+
+uint32_t GridIndexBuffer::GetBandRows(const glm::uvec2& size, bool& is16Bit)
+{
+    const uint32_t kQuadRows = size.y > 1 ? size.y - 1 : 0;
+
+    // As many rows of vertices as 16 bit indices reach, 2 at least
+    const uint32_t kRows16 = s_kMaxVertices16 / glm::max(size.x, 1U);
+    is16Bit = kRows16 >= 2;
+    return is16Bit ? glm::min(kRows16 - 1, kQuadRows) : kQuadRows;
+}
+
+uint32_t GridIndexBuffer::GetRowIndexCount(const glm::uvec2& size, Topology topology)
+{
+    if (size.x < 2)
+        return 0;
+
+    return topology == Topology::Triangles ? (size.x - 1) * 6 : size.x * 2 + 2;
+}
+
+bool GridIndexBuffer::Key::operator<(const Key& other) const
+{
+    return std::tie(size.x, size.y, topology) <
+           std::tie(other.size.x, other.size.y, other.topology);
+}
+
+// =============================================================================
+
+GridIndexBuffer::GridIndexBuffer(const glm::uvec2& size, Topology topology)
+    : m_Size(size),
+      m_Topology(topology)
+{
+    bool is16Bit = false;
+    m_BandRows = GetBandRows(m_Size, is16Bit);
+    if (is16Bit)
+        Generate(m_Indices16);
+    else
+        Generate(m_Indices32);
+
+    // The last band may have fewer rows, a prefix of the indices
+    const uint32_t kQuadRows = m_Size.y > 1 ? m_Size.y - 1 : 0;
+    for (uint32_t row = 0; m_BandRows > 0 && row < kQuadRows; row += m_BandRows)
+    {
+        const uint32_t kRows = glm::min(m_BandRows, kQuadRows - row);
+        m_BandCounts.push_back(static_cast<int32_t>(kRows * GetRowIndexCount()));
+        m_BandBaseVertices.push_back(static_cast<int32_t>(row * m_Size.x));
+    }
+    m_BandOffsets.assign(m_BandCounts.size(), nullptr);
+}
+
+GridIndexBuffer::~GridIndexBuffer()
+{
+    // Dropped by ReleaseUnused on the thread of the context
+    if (m_Buffer != 0)
+        glDeleteBuffers(1, &m_Buffer);
+}
+
+template <typename Index>
+void GridIndexBuffer::Generate(std::vector<Index>& indices) const
+{
+    const uint32_t kWidth = m_Size.x;
+    indices.resize(static_cast<size_t>(m_BandRows) * GetRowIndexCount());
+    if (kWidth < 2)
+        return;
+
+    size_t index = 0;
+    for (uint32_t y = 0; y < m_BandRows; ++y)
+    {
+        const Index kRow = static_cast<Index>(y * kWidth);
+
+        if (m_Topology == Topology::Triangles)
+        {
+            for (uint32_t x = 0; x < kWidth - 1; ++x)
+            {
+                const Index kVertexIndex = kRow + static_cast<Index>(x);
+                // Top triangle
+                indices[index++] = kVertexIndex;
+                indices[index++] = kVertexIndex + kWidth + 1;
+                indices[index++] = kVertexIndex + 1;
+                // Bottom triangle
+                indices[index++] = kVertexIndex;
+                indices[index++] = kVertexIndex + kWidth;
+                indices[index++] = kVertexIndex + kWidth + 1;
+            }
+            continue;
+        }
+
+        // The first vertex twice flips the winding of the strip, so it has
+        //  the triangles of the list, bottom before top
+        indices[index++] = kRow + kWidth;
+        for (uint32_t x = 0; x < kWidth; ++x)
+        {
+            indices[index++] = kRow + kWidth + static_cast<Index>(x);
+            indices[index++] = kRow + static_cast<Index>(x);
+        }
+        indices[index++] = static_cast<Index>(~Index(0));
+    }
+}
+
+uint64_t GridIndexBuffer::GetDrawnIndexCount() const
+{
+    return static_cast<uint64_t>(m_Size.y > 1 ? m_Size.y - 1 : 0) * GetRowIndexCount();
+}
+
+uint32_t GridIndexBuffer::GetIndexCount() const
+{
+    return static_cast<uint32_t>(Is16Bit() ? m_Indices16.size() : m_Indices32.size());
+}
+
+size_t GridIndexBuffer::GetByteSize() const
+{
+    return m_Indices16.size() * sizeof(uint16_t) + m_Indices32.size() * sizeof(uint32_t);
+}
+
+void GridIndexBuffer::Upload() const
+{
+    glGenBuffers(1, &m_Buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_Buffer);
+    if (Is16Bit())
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Indices16.size() * sizeof(uint16_t),
+                     m_Indices16.data(), GL_STATIC_DRAW);
+    else
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Indices32.size() * sizeof(uint32_t),
+                     m_Indices32.data(), GL_STATIC_DRAW);
+}
+
+void GridIndexBuffer::Draw(uint32_t instanceCount) const
+{
+    if (m_BandCounts.empty())
+        return;
+
+    // The element buffer binding belongs to the vertex array bound
+    if (m_Buffer == 0)
+        Upload();
+    else
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_Buffer);
+
+    const GLenum kMode = m_Topology == Topology::Triangles ? GL_TRIANGLES : GL_TRIANGLE_STRIP;
+    const GLenum kType = Is16Bit() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+    // About 70 bands at 2048^2, validated once instead of per band
+    if (instanceCount == 1)
+    {
+        glMultiDrawElementsBaseVertex(kMode, m_BandCounts.data(), kType, m_BandOffsets.data(),
+                                      static_cast<GLsizei>(m_BandCounts.size()),
+                                      m_BandBaseVertices.data());
+        return;
+    }
+
+    for (size_t band = 0; band < m_BandCounts.size(); ++band)
+        glDrawElementsInstancedBaseVertex(kMode, m_BandCounts[band], kType, nullptr,
+                                          static_cast<GLsizei>(instanceCount),
+                                          m_BandBaseVertices[band]);
+}
@@ -0,0 +1,118 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+
+/**
+ * @brief Indices of a grid of vertices stored row by row, shared by all the
+ *  terrains of the size, see Acquire. The grid is drawn in bands of rows
+ *  with a base vertex each, so the indices of one band serve all of them
+ *  and fit in 16 bits unless a row has more than 32767 vertices.
+ */
+class GridIndexBuffer
+{
+public:
+    enum class Topology
+    {
+        Triangles,      ///< 6 indices per quad
+        TriangleStrips  ///< One strip per row of quads, 2 indices per quad
+    };
+
+    /**
+     * @brief Indices of the grid from the cache, generated on a miss.
+     *  Thread safe, the generation does not run tasks of the job system.
+     * @param[out] generated True if not cached
+     */
+    static std::shared_ptr<const GridIndexBuffer> Acquire(const glm::uvec2& size,
+                                                          Topology topology,
+                                                          bool& generated);
+    /**
+     * @brief Drops the cached indices no terrain holds anymore along with
+     *  their buffers, on the thread of the OpenGL context. Called once the
+     *  terrains are destroyed, before the context is, the cache is static.
+     */
+    static void ReleaseUnused();
+
+    /** @return Index buffers in the cache and their bytes */
+    static size_t GetCacheCount();
+    static size_t GetCacheBytes();
+    /** @return Bytes of the indices of the size and topology, cached or not */
+    static size_t GetByteSize(const glm::uvec2& size, Topology topology);
+
+    GridIndexBuffer(const glm::uvec2& size, Topology topology);
+    ~GridIndexBuffer();
+
+    GridIndexBuffer(const GridIndexBuffer&) = delete;
+    GridIndexBuffer& operator=(const GridIndexBuffer&) = delete;
+
+    /**
+     * @brief Draws the grid from the vertex array bound, uploads the indices
+     *  on the first call. Needs GL_PRIMITIVE_RESTART_FIXED_INDEX for strips.
+     *  A single instance draws all the bands in one multi-draw call, the
+     *  instances need one call per band.
+     */
+    void Draw(uint32_t instanceCount) const;
+
+    glm::uvec2 GetSize() const { return m_Size; }
+    Topology GetTopology() const { return m_Topology; }
+
+    /** @return Indices of all the bands, as drawn */
+    uint64_t GetDrawnIndexCount() const;
+    /** @return Indices of one band, as stored */
+    uint32_t GetIndexCount() const;
+    size_t GetByteSize() const;
+    bool Is16Bit() const { return !m_Indices16.empty(); }
+
+private:
+    /** @brief Indices of the quad rows of a band relative to its first vertex */
+    template <typename Index>
+    void Generate(std::vector<Index>& indices) const;
+
+    /**
+     * @return Rows of quads per band, as many as 16 bit indices reach unless
+     *  a row has more vertices than that, see is16Bit
+     */
+    static uint32_t GetBandRows(const glm::uvec2& size, bool& is16Bit);
+    /** @return Indices per row of quads */
+    static uint32_t GetRowIndexCount(const glm::uvec2& size, Topology topology);
+    uint32_t GetRowIndexCount() const { return GetRowIndexCount(m_Size, m_Topology); }
+
+    void Upload() const;
+
+private:
+    struct Key
+    {
+        glm::uvec2 size;
+        Topology topology;
+
+        bool operator<(const Key& other) const;
+    };
+
+    static std::mutex s_CacheMutex;
+    static std::map<Key, std::shared_ptr<const GridIndexBuffer>> s_Cache;
+
+    glm::uvec2 m_Size{ 0 };
+    Topology m_Topology{ Topology::Triangles };
+    uint32_t m_BandRows{ 0 };           ///< Rows of quads per band
+
+    std::vector<uint16_t> m_Indices16;
+    std::vector<uint32_t> m_Indices32;  ///< If the band has more vertices than 16 bits index
+
+    /** @brief Per band, the arguments of the multi-draw, see Draw */
+    std::vector<int32_t> m_BandCounts;
+    std::vector<int32_t> m_BandBaseVertices;
+    std::vector<const void*> m_BandOffsets;
+
+    mutable uint32_t m_Buffer{ 0 };     ///< Created by the first draw
+};
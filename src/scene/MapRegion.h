@@ -0,0 +1,101 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+
+/** @brief Samples [begin,end) of a map stored row by row */
+struct MapRegion
+{
+    glm::uvec2 begin{ 0 };
+    glm::uvec2 end{ 0 };
+};
+
+/**
+ * @brief Moves the samples of a size.x x size.y map in place, sample (x, y)
+ *  takes the one at (x + shift.x, y + shift.y). The exposed samples keep
+ *  their old values, see GetExposedRegions.
+ * @param components Values per sample
+ */
+template <typename T>
+void ShiftMap(std::vector<T>& map, const glm::uvec2& size, uint32_t components,
+              const glm::ivec2& shift)
+{
+    const glm::uvec2 kShift(glm::abs(shift));
+    if (kShift.x >= size.x || kShift.y >= size.y)
+        return;
+
+    const size_t kCount = static_cast<size_t>(size.x - kShift.x) * components;
+    const uint32_t kSrcX = shift.x > 0 ? kShift.x : 0;
+    const uint32_t kDstX = shift.x < 0 ? kShift.x : 0;
+
+    // Rows are written in the order that does not overwrite the rows still to
+    //  be read, the rows overlap, so this stays on one thread
+    for (uint32_t i = 0; i < size.y - kShift.y; ++i)
+    {
+        const uint32_t kDstY = shift.y >= 0 ? i : size.y - 1 - i;
+        const uint32_t kSrcY = kDstY + shift.y;
+        std::memmove(&map[(static_cast<size_t>(kDstY) * size.x + kDstX) * components],
+                     &map[(static_cast<size_t>(kSrcY) * size.x + kSrcX) * components],
+                     kCount * sizeof(T));
+    }
+}
+
+/** @return Samples ShiftMap keeps, the whole map without the exposed ones */
+inline MapRegion GetKeptRegion(const glm::uvec2& size, const glm::ivec2& shift)
+{
+    const glm::uvec2 kShift = glm::min(glm::uvec2(glm::abs(shift)), size);
+    return {
+        glm::uvec2(shift.x < 0 ? kShift.x : 0, shift.y < 0 ? kShift.y : 0),
+        glm::uvec2(shift.x > 0 ? size.x - kShift.x : size.x,
+                   shift.y > 0 ? size.y - kShift.y : size.y)
+    };
+}
+
+/**
+ * @return Samples ShiftMap cannot fill from the map, a band of full rows and
+ *  one of columns along the kept region, none for a zero shift
+ */
+inline std::vector<MapRegion> GetExposedRegions(const glm::uvec2& size, const glm::ivec2& shift)
+{
+    const MapRegion kKept = GetKeptRegion(size, shift);
+
+    std::vector<MapRegion> regions;
+    if (kKept.begin.y > 0)
+        regions.push_back({ glm::uvec2(0), glm::uvec2(size.x, kKept.begin.y) });
+    if (kKept.end.y < size.y)
+        regions.push_back({ glm::uvec2(0, kKept.end.y), size });
+
+    if (kKept.begin.x > 0)
+        regions.push_back({ glm::uvec2(0, kKept.begin.y),
+                            glm::uvec2(kKept.begin.x, kKept.end.y) });
+    if (kKept.end.x < size.x)
+        regions.push_back({ glm::uvec2(kKept.end.x, kKept.begin.y),
+                            glm::uvec2(size.x, kKept.end.y) });
+    return regions;
+}
+
+/** @return The regions split into tiles of at most tileSize, row by row */
+inline std::vector<MapRegion> SplitTiles(const std::vector<MapRegion>& regions,
+                                         const glm::uvec2& tileSize)
+{
+    const glm::uvec2 kTile = glm::max(tileSize, glm::uvec2(1));
+
+    std::vector<MapRegion> tiles;
+    for (const MapRegion& kRegion : regions)
+        for (uint32_t y = kRegion.begin.y; y < kRegion.end.y; y += kTile.y)
+            for (uint32_t x = kRegion.begin.x; x < kRegion.end.x; x += kTile.x)
+            {
+                const glm::uvec2 kBegin(x, y);
+                tiles.push_back({ kBegin, glm::min(kBegin + kTile, kRegion.end) });
+            }
+    return tiles;
+}
@@ -0,0 +1,202 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "NoiseCompute.h"
+
+#define SGL_PROFILE
+#include <SGL/SGL.h>
+
+
+static constexpr uint32_t s_kPermutationBinding = 0;
+static constexpr uint32_t s_kValueBinding = 1;
+static constexpr uint32_t s_kImageUnit = 0;
+/** @brief Size of PerlinNoise::GetPermutations, 256 entries twice */
+static constexpr size_t s_kPermutationSize = 512 * sizeof(uint32_t);
+
+/** @return Info log of the shader or the program */
+template <typename GetParam, typename GetLog>
+static std::string GetInfoLog(GLuint object, GetParam getParam, GetLog getLog)
+{
+    GLint length = 0;
+    getParam(object, GL_INFO_LOG_LENGTH, &length);
+
+    std::string log(static_cast<size_t>(glm::max(length, 1)), '\0');
+    getLog(object, length, nullptr, log.data());
+    return log;
+}
+
+// =============================================================================
+
+NoiseComputeBackend::~NoiseComputeBackend()
+{
+    Release();
+}
+
+bool NoiseComputeBackend::Init(const std::string& source, std::string& error)
+{
+    SGL_PROFILE_SCOPE();
+
+    Release();
+
+    const GLuint kShader = glCreateShader(GL_COMPUTE_SHADER);
+    const char* kSource = source.c_str();
+    glShaderSource(kShader, 1, &kSource, nullptr);
+    glCompileShader(kShader);
+
+    GLint status = GL_FALSE;
+    glGetShaderiv(kShader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        error = "Compute shader: " + GetInfoLog(kShader, glGetShaderiv, glGetShaderInfoLog);
+        glDeleteShader(kShader);
+        return false;
+    }
+
+    const GLuint kProgram = glCreateProgram();
+    glAttachShader(kProgram, kShader);
+    glLinkProgram(kProgram);
+    glDeleteShader(kShader);
+
+    glGetProgramiv(kProgram, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        error = "Compute program: " + GetInfoLog(kProgram, glGetProgramiv, glGetProgramInfoLog);
+        glDeleteProgram(kProgram);
+        return false;
+    }
+    m_Program = kProgram;
+
+    glGenBuffers(1, &m_PermutationBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_PermutationBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, s_kPermutationSize, nullptr, GL_STATIC_DRAW);
+
+    glGenBuffers(1, &m_ValueBuffer);
+
+    glGenBuffers(1, &m_UniformBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_UniformBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(NoiseUBO), nullptr, GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    error.clear();
+    return true;
+}
+
+void NoiseComputeBackend::Release()
+{
+    if (m_Program == 0)
+        return;
+
+    glDeleteProgram(m_Program);
+    glDeleteBuffers(1, &m_PermutationBuffer);
+    glDeleteBuffers(1, &m_ValueBuffer);
+    glDeleteBuffers(1, &m_UniformBuffer);
+
+    m_Program = m_PermutationBuffer = m_ValueBuffer = m_UniformBuffer = 0;
+    m_ValueCapacity = 0;
+    m_PermutationsUploaded = false;
+}
+
+bool NoiseComputeBackend::Supports(const FractalNoise<float>& noise, std::string& reason)
+{
+    if (noise.basis != NoiseBasis::Perlin)
+    {
+        reason = "The compute shader only has the Perlin basis";
+        return false;
+    }
+    if (noise.octaveCount > OCTAVE_MAX_COUNT)
+    {
+        reason = "The compute shader sums at most 32 octaves";
+        return false;
+    }
+
+    reason.clear();
+    return true;
+}
+
+void NoiseComputeBackend::Dispatch(const FractalNoise<float>& noise,
+                                   uint32_t width, uint32_t height,
+                                   uint32_t texture)
+{
+    SGL_PROFILE_SCOPE();
+
+    // The permutations only change with the seed
+    if (!m_PermutationsUploaded || m_UploadedSeed != noise.GetSeed())
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_PermutationBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, s_kPermutationSize,
+                        noise.perlinNoise.GetPermutations());
+
+        m_UploadedSeed = noise.GetSeed();
+        m_PermutationsUploaded = true;
+    }
+
+    const size_t kCount = static_cast<size_t>(width) * height;
+    if (kCount > m_ValueCapacity)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ValueBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, kCount * sizeof(float),
+                     nullptr, GL_DYNAMIC_COPY);
+        m_ValueCapacity = kCount;
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // Same octave weights as FractalNoise::SumOctavesN, the culling and the
+    //  fading stay on the CPU
+    NoiseUBO data;
+    data.size = glm::uvec2(width, height);
+    data.scale = noise.scale;
+    data.offset = glm::vec2(noise.offset);
+    data.octaveCount = static_cast<int32_t>(noise.octaveCount);
+
+    const uint32_t kBudget = noise.GetOctaveBudget();
+    float max = 0.0f;
+    float frequency = 1.0f;
+    float amplitude = 1.0f;
+
+    for (uint32_t i = 0; i < noise.octaveCount; ++i)
+    {
+        const float kWeight = i < kBudget ? amplitude * noise.GetOctaveFade(i) : 0.0f;
+        data.octaves[i] = glm::vec4(frequency, kWeight, 0.0f, 0.0f);
+
+        max += amplitude;
+
+        amplitude *= noise.gain;
+        frequency *= noise.lacunarity;
+    }
+    data.amplitudeSum = max;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, m_UniformBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(NoiseUBO), &data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glUseProgram(m_Program);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, s_kPermutationBinding, m_PermutationBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, s_kValueBinding, m_ValueBuffer);
+    glBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING_POINT, m_UniformBuffer);
+    if (texture != 0)
+        glBindImageTexture(s_kImageUnit, texture, 0, GL_FALSE, 0,
+                           GL_WRITE_ONLY, GL_RGBA8);
+
+    glDispatchCompute((width + GROUP_SIZE - 1) / GROUP_SIZE,
+                      (height + GROUP_SIZE - 1) / GROUP_SIZE, 1);
+
+    // The texture is sampled and the buffer read back afterwards
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
+                    GL_TEXTURE_FETCH_BARRIER_BIT |
+                    GL_BUFFER_UPDATE_BARRIER_BIT);
+    glUseProgram(0);
+}
+
+void NoiseComputeBackend::ReadBack(float* out, size_t count) const
+{
+    SGL_PROFILE_SCOPE();
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ValueBuffer);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
+                       glm::min(count, m_ValueCapacity) * sizeof(float), out);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
@@ -0,0 +1,80 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "FractalNoise.h"
+
+
+/**
+ * @brief Evaluates the 2D fractal Perlin noise in a compute shader, see
+ *  shaders/FractalNoise.comp. The values are written to a storage buffer and
+ *  the height map texture, they stay on the GPU until read back. Needs
+ *  OpenGL 4.3 and runs on software implementations like Mesa llvmpipe.
+ */
+class NoiseComputeBackend
+{
+public:
+    static constexpr uint32_t OCTAVE_MAX_COUNT = 32;
+    static constexpr uint32_t GROUP_SIZE = 16;  ///< Of the shader in x and y
+    static constexpr uint32_t UBO_BINDING_POINT = 3;
+
+    NoiseComputeBackend() = default;
+    ~NoiseComputeBackend();
+
+    NoiseComputeBackend(const NoiseComputeBackend&) = delete;
+    NoiseComputeBackend& operator=(const NoiseComputeBackend&) = delete;
+
+    /**
+     * @brief Compiles the shader and creates the buffers, needs a current
+     *  OpenGL context
+     * @return False if the shader does not compile, error has the log
+     */
+    bool Init(const std::string& source, std::string& error);
+    bool IsReady() const { return m_Program != 0; }
+
+    /** @return False if the noise settings cannot be evaluated by the shader */
+    static bool Supports(const FractalNoise<float>& noise, std::string& reason);
+
+    /**
+     * @brief Evaluates width x height samples at the integer positions,
+     *  asynchronously on the GPU
+     * @param texture Written as well if not 0, GL_RGBA8 storage of the size
+     */
+    void Dispatch(const FractalNoise<float>& noise, uint32_t width, uint32_t height,
+                  uint32_t texture);
+
+    /** @brief Copies the values of the last dispatch, waits for the GPU */
+    void ReadBack(float* out, size_t count) const;
+
+private:
+    /** @brief std140 layout of NoiseUBO */
+    struct NoiseUBO
+    {
+        glm::uvec2 size{ 0 };
+        glm::vec2 offset{ 0.0f };
+        float scale{ 1.0f };
+        float amplitudeSum{ 1.0f };
+        int32_t octaveCount{ 0 };
+        float __pad{ 0.0f };
+        glm::vec4 octaves[OCTAVE_MAX_COUNT]{};  ///< x: frequency, y: weight
+    };
+
+    void Release();
+
+    uint32_t m_Program{ 0 };
+    uint32_t m_PermutationBuffer{ 0 };
+    uint32_t m_ValueBuffer{ 0 };
+    uint32_t m_UniformBuffer{ 0 };
+
+    size_t m_ValueCapacity{ 0 };        ///< Values the buffer has room for
+    int32_t m_UploadedSeed{ 0 };
+    bool m_PermutationsUploaded{ false };
+};
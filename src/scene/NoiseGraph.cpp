@@ -0,0 +1,698 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "NoiseGraph.h"
+
+#include <map>
+#include <limits>
+#include <cstdlib>
+#include <sstream>
+#include <algorithm>
+
+#define SGL_PROFILE
+#include <SGL/SGL.h>
+
+#include "JobSystem.h"
+
+
+static const char* s_kNodeTypeNames[] = {
+    "fbm", "ridged", "billow", "constant",
+    "add", "multiply", "min", "max", "lerp",
+    "warp",
+    "scalebias", "power", "terrace", "clamp", "invert"
+};
+static_assert(sizeof(s_kNodeTypeNames) / sizeof(s_kNodeTypeNames[0]) ==
+              static_cast<size_t>(NoiseNodeType::Count));
+
+static const char* s_kBasisNames[] = { "perlin", "simplex", "worley" };
+static const char* s_kCellFunctionNames[] = { "f1", "f2", "f2-f1" };
+static const char* s_kCellDistanceNames[] = { "euclidean", "manhattan", "chebyshev" };
+
+static const char* s_kDefaultRecipe =
+    "# Rolling hills, warped ridged mountains blended in by a mask\n"
+    "hills = fbm basis=perlin seed=1 scale=220 octaves=8\n"
+    "ridges = ridged basis=simplex seed=2 scale=300 octaves=6\n"
+    "flow = fbm basis=simplex seed=3 scale=180 octaves=3\n"
+    "warped = warp ridges flow amount=40\n"
+    "mask = fbm basis=perlin seed=4 scale=600 octaves=3\n"
+    "contrast = scalebias mask factor=3 bias=-1\n"
+    "blend = clamp contrast min=0 max=1\n"
+    "mountains = lerp hills warped blend\n"
+    "shaped = terrace mountains steps=12 softness=0.6\n"
+    "output shaped\n";
+
+/** @return Index of the name in the list, -1 if not found */
+template <size_t N>
+static int32_t FindName(const char* const (&names)[N], const std::string& name)
+{
+    for (size_t i = 0; i < N; ++i)
+        if (name == names[i])
+            return static_cast<int32_t>(i);
+    return -1;
+}
+
+static bool ParseFloat(const std::string& text, float& value)
+{
+    char* end = nullptr;
+    value = std::strtof(text.c_str(), &end);
+    return !text.empty() && *end == '\0';
+}
+
+static bool ParseInt(const std::string& text, int32_t& value)
+{
+    char* end = nullptr;
+    value = static_cast<int32_t>(std::strtol(text.c_str(), &end, 10));
+    return !text.empty() && *end == '\0';
+}
+
+// =============================================================================
+
+const char* GetNoiseNodeTypeName(NoiseNodeType type)
+{
+    return s_kNodeTypeNames[static_cast<size_t>(type)];
+}
+
+uint32_t GetNoiseNodeInputCount(NoiseNodeType type)
+{
+    switch (type)
+    {
+    case NoiseNodeType::Fbm:
+    case NoiseNodeType::Ridged:
+    case NoiseNodeType::Billow:
+    case NoiseNodeType::Constant:
+        return 0;
+    case NoiseNodeType::Add:
+    case NoiseNodeType::Multiply:
+    case NoiseNodeType::Min:
+    case NoiseNodeType::Max:
+        return 2;
+    case NoiseNodeType::Lerp:
+    case NoiseNodeType::Warp:
+        return 3;
+    default:
+        return 1;
+    }
+}
+
+std::array<const char*, 2> GetNoiseNodeParamNames(NoiseNodeType type)
+{
+    switch (type)
+    {
+    case NoiseNodeType::Constant:  return { "value", nullptr };
+    case NoiseNodeType::Warp:      return { "amount", nullptr };
+    case NoiseNodeType::ScaleBias: return { "factor", "bias" };
+    case NoiseNodeType::Power:     return { "exponent", nullptr };
+    case NoiseNodeType::Terrace:   return { "steps", "softness" };
+    case NoiseNodeType::Clamp:     return { "min", "max" };
+    default:                       return { nullptr, nullptr };
+    }
+}
+
+bool IsNoiseNodeSource(NoiseNodeType type)
+{
+    return type == NoiseNodeType::Fbm ||
+           type == NoiseNodeType::Ridged ||
+           type == NoiseNodeType::Billow;
+}
+
+// =============================================================================
+
+void NoiseProgram::Evaluate(uint32_t width, uint32_t height, float* out,
+                            float& min, float& max) const
+{
+    min = std::numeric_limits<float>::max();
+    max = std::numeric_limits<float>::lowest();
+    if (IsEmpty())
+        return;
+
+    // Every band of tiles has its own registers and range, the ranges are
+    //  merged afterwards
+    const uint32_t kBandCount = (height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+    std::vector<float> bandMin(kBandCount), bandMax(kBandCount);
+
+    JobSystem::Get().ParallelFor("Noise graph tiles", kBandCount, 1,
+                                 [&](uint32_t begin, uint32_t end) {
+        // Registers of one tile, reused by all tiles of the bands
+        std::vector<float> registers(static_cast<size_t>(m_RegisterCount) * TILE_SIZE);
+        std::vector<float> scratch(2 * TILE_SIZE);
+        float* xs = registers.data();
+        float* ys = registers.data() + TILE_SIZE;
+        const float* kResult = registers.data() + static_cast<size_t>(m_Output) * TILE_SIZE;
+
+        for (uint32_t band = begin; band < end; ++band)
+        {
+            const uint32_t tileY = band * TILE_HEIGHT;
+            float bandMinValue = std::numeric_limits<float>::max();
+            float bandMaxValue = std::numeric_limits<float>::lowest();
+
+            for (uint32_t tileX = 0; tileX < width; tileX += TILE_WIDTH)
+            {
+                const uint32_t kWidth = std::min(TILE_WIDTH, width - tileX);
+                const uint32_t kHeight = std::min(TILE_HEIGHT, height - tileY);
+
+                for (uint32_t y = 0; y < kHeight; ++y)
+                    for (uint32_t x = 0; x < kWidth; ++x)
+                    {
+                        xs[y*kWidth + x] = static_cast<float>(tileX + x);
+                        ys[y*kWidth + x] = static_cast<float>(tileY + y);
+                    }
+
+                Run(registers.data(), scratch.data(), kWidth * kHeight);
+
+                for (uint32_t y = 0; y < kHeight; ++y)
+                {
+                    const float* kRow = kResult + y*kWidth;
+                    float* outRow = out + static_cast<size_t>(tileY + y) * width + tileX;
+                    for (uint32_t x = 0; x < kWidth; ++x)
+                    {
+                        outRow[x] = kRow[x];
+                        bandMinValue = std::min(bandMinValue, kRow[x]);
+                        bandMaxValue = std::max(bandMaxValue, kRow[x]);
+                    }
+                }
+            }
+
+            bandMin[band] = bandMinValue;
+            bandMax[band] = bandMaxValue;
+        }
+    });
+
+    for (uint32_t band = 0; band < kBandCount; ++band)
+    {
+        min = std::min(min, bandMin[band]);
+        max = std::max(max, bandMax[band]);
+    }
+}
+
+void NoiseProgram::Run(float* registers, float* scratch, size_t n) const
+{
+    const auto kRegister = [registers](uint32_t index) {
+        return registers + static_cast<size_t>(index) * TILE_SIZE;
+    };
+
+    for (const Instruction& instruction : m_Instructions)
+    {
+        float* dst = kRegister(instruction.dst);
+        const float* in0 = kRegister(instruction.src[0]);
+        const float* in1 = kRegister(instruction.src[1]);
+        const float* in2 = kRegister(instruction.src[2]);
+        const float a = instruction.a;
+        const float b = instruction.b;
+
+        switch (instruction.op)
+        {
+        case NoiseNodeType::Fbm:
+        case NoiseNodeType::Ridged:
+        case NoiseNodeType::Billow:
+            RunSource(instruction, registers, scratch, n);
+            break;
+        case NoiseNodeType::Constant:
+            std::fill_n(dst, n, a);
+            break;
+        case NoiseNodeType::Add:
+            for (size_t s = 0; s < n; ++s)
+                dst[s] = in0[s] + in1[s];
+            break;
+        case NoiseNodeType::Multiply:
+            for (size_t s = 0; s < n; ++s)
+                dst[s] = in0[s] * in1[s];
+            break;
+        case NoiseNodeType::Min:
+            for (size_t s = 0; s < n; ++s)
+                dst[s] = std::min(in0[s], in1[s]);
+            break;
+        case NoiseNodeType::Max:
+            for (size_t s = 0; s < n; ++s)
+                dst[s] = std::max(in0[s], in1[s]);
+            break;
+        case NoiseNodeType::Lerp:
+            for (size_t s = 0; s < n; ++s)
+                dst[s] = in0[s] + (in1[s] - in0[s]) * in2[s];
+            break;
+        case NoiseNodeType::Warp:
+        {
+            // The offsets are centered, amount is in samples
+            const float* kX = kRegister(instruction.coord);
+            const float* kY = kRegister(instruction.coord + 1);
+            float* dstY = kRegister(instruction.dst + 1);
+            for (size_t s = 0; s < n; ++s)
+            {
+                dst[s] = kX[s] + (in0[s] - 0.5f) * 2.0f * a;
+                dstY[s] = kY[s] + (in1[s] - 0.5f) * 2.0f * a;
+            }
+            break;
+        }
+        case NoiseNodeType::ScaleBias:
+            for (size_t s = 0; s < n; ++s)
+                dst[s] = in0[s] * a + b;
+            break;
+        case NoiseNodeType::Power:
+            for (size_t s = 0; s < n; ++s)
+                dst[s] = std::pow(glm::clamp(in0[s], 0.0f, 1.0f), a);
+            break;
+        case NoiseNodeType::Terrace:
+        {
+            const float kSteps = std::max(a, 1.0f);
+            const float kSoftness = glm::clamp(b, 0.01f, 1.0f);
+            for (size_t s = 0; s < n; ++s)
+            {
+                const float kValue = in0[s] * kSteps;
+                const float kStep = std::floor(kValue);
+                dst[s] = (kStep + glm::smoothstep(1.0f - kSoftness, 1.0f, kValue - kStep)) / kSteps;
+            }
+            break;
+        }
+        case NoiseNodeType::Clamp:
+            for (size_t s = 0; s < n; ++s)
+                dst[s] = glm::clamp(in0[s], a, b);
+            break;
+        case NoiseNodeType::Invert:
+            for (size_t s = 0; s < n; ++s)
+                dst[s] = 1.0f - in0[s];
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void NoiseProgram::RunSource(const Instruction& instruction, float* registers,
+                             float* scratch, size_t n) const
+{
+    const FractalNoise<float>& noise = m_Noises[instruction.noise];
+    const float* xs = registers + static_cast<size_t>(instruction.coord) * TILE_SIZE;
+    const float* ys = xs + TILE_SIZE;
+    float* dst = registers + static_cast<size_t>(instruction.dst) * TILE_SIZE;
+
+    if (instruction.op == NoiseNodeType::Fbm)
+    {
+        noise.NoiseN(xs, ys, dst, n);
+        return;
+    }
+
+    // Ridged and billow shape the raw noise of each octave, the octaves are
+    // culled like the ones of the fractal noise
+    float* octave = scratch;
+    float* weight = scratch + TILE_SIZE;
+    std::fill_n(dst, n, 0.0f);
+    std::fill_n(weight, n, 1.0f);
+
+    const bool kRidged = instruction.op == NoiseNodeType::Ridged;
+    const uint32_t kBudget = noise.GetOctaveBudget();
+    float max = 0.0f;
+    float amplitude = 1.0f;
+
+    for (uint32_t i = 0; i < noise.octaveCount; ++i)
+    {
+        const float kWeight = i < kBudget ? amplitude * noise.GetOctaveFade(i) : 0.0f;
+        if (kWeight > 0.0f)
+        {
+            noise.OctaveN(i, xs, ys, octave, n);
+
+            if (kRidged)
+            {
+                // Musgrave's ridged multifractal, each octave is weighted by
+                // the previous one, so the detail gathers on the crests
+                for (size_t s = 0; s < n; ++s)
+                {
+                    float signal = 1.0f - std::abs(octave[s]);
+                    signal *= signal * weight[s];
+                    weight[s] = glm::clamp(signal * 2.0f, 0.0f, 1.0f);
+                    dst[s] += signal * kWeight;
+                }
+            }
+            else
+            {
+                for (size_t s = 0; s < n; ++s)
+                    dst[s] += (std::abs(octave[s]) * 2.0f - 1.0f) * kWeight;
+            }
+        }
+
+        max += amplitude;
+        amplitude *= noise.gain;
+    }
+
+    for (size_t s = 0; s < n; ++s)
+        dst[s] = kRidged ? dst[s] / max : (dst[s] / max + 1.0f) / 2.0f;
+}
+
+// =============================================================================
+
+NoiseGraph NoiseGraph::CreateDefault()
+{
+    NoiseGraph graph;
+    std::string error;
+    graph.FromRecipe(s_kDefaultRecipe, error);
+    return graph;
+}
+
+NoiseNode& NoiseGraph::AddNode(NoiseNodeType type)
+{
+    NoiseNode node;
+    node.type = type;
+    node.name = "n" + std::to_string(m_Nodes.size());
+    while (std::any_of(m_Nodes.begin(), m_Nodes.end(),
+                       [&](const NoiseNode& other) { return other.name == node.name; }))
+        node.name += "_";
+
+    // Connects the previous node, the common case when chaining curves
+    const int32_t kPrevious = static_cast<int32_t>(m_Nodes.size()) - 1;
+    for (uint32_t i = 0; i < GetNoiseNodeInputCount(type) && i < 2; ++i)
+        node.inputs[i] = kPrevious;
+
+    m_Nodes.push_back(node);
+    return m_Nodes.back();
+}
+
+void NoiseGraph::RemoveNode(uint32_t index)
+{
+    if (index >= m_Nodes.size())
+        return;
+
+    m_Nodes.erase(m_Nodes.begin() + index);
+    for (NoiseNode& node : m_Nodes)
+        for (int32_t& input : node.inputs)
+        {
+            if (input == static_cast<int32_t>(index))
+                input = -1;
+            else if (input > static_cast<int32_t>(index))
+                --input;
+        }
+
+    if (m_Output == static_cast<int32_t>(index))
+        m_Output = -1;
+    else if (m_Output > static_cast<int32_t>(index))
+        --m_Output;
+}
+
+bool NoiseGraph::Validate(std::string& error) const
+{
+    if (m_Nodes.empty())
+    {
+        error = "the graph has no nodes";
+        return false;
+    }
+    if (m_Output >= static_cast<int32_t>(m_Nodes.size()))
+    {
+        error = "the output node does not exist";
+        return false;
+    }
+
+    for (size_t i = 0; i < m_Nodes.size(); ++i)
+    {
+        const NoiseNode& kNode = m_Nodes[i];
+        if (kNode.name.empty() ||
+            kNode.name.find_first_of(" \t=#") != std::string::npos)
+        {
+            error = "node " + std::to_string(i) + ": invalid name '" + kNode.name + "'";
+            return false;
+        }
+        for (size_t j = 0; j < i; ++j)
+            if (m_Nodes[j].name == kNode.name)
+            {
+                error = kNode.name + ": duplicate name";
+                return false;
+            }
+
+        for (uint32_t k = 0; k < GetNoiseNodeInputCount(kNode.type); ++k)
+        {
+            // The second offset of the warp falls back to the first one
+            const bool kOptional = kNode.type == NoiseNodeType::Warp && k == 2;
+            if (kOptional && kNode.inputs[k] < 0)
+                continue;
+            if (kNode.inputs[k] < 0 || kNode.inputs[k] >= static_cast<int32_t>(i))
+            {
+                error = kNode.name + ": input " + std::to_string(k) +
+                        " must be connected to an earlier node";
+                return false;
+            }
+        }
+
+        if (IsNoiseNodeSource(kNode.type) && (kNode.octaves < 1 || kNode.scale <= 0.0f))
+        {
+            error = kNode.name + ": needs at least one octave and a positive scale";
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Emits the instructions of the nodes, once per node and position */
+struct NoiseGraphCompiler
+{
+    const std::vector<NoiseNode>& nodes;
+    std::vector<NoiseProgram::Instruction>& instructions;
+    std::vector<FractalNoise<float>>& noises;
+    uint32_t& registerCount;
+    float precision;
+    float targetSpacing;
+    std::map<std::pair<int32_t, uint32_t>, uint32_t> compiled;
+
+    uint32_t Compile(int32_t index, uint32_t coord)
+    {
+        const auto kKey = std::make_pair(index, coord);
+        const auto kFound = compiled.find(kKey);
+        if (kFound != compiled.end())
+            return kFound->second;
+
+        const NoiseNode& kNode = nodes[index];
+
+        NoiseProgram::Instruction instruction;
+        instruction.op = kNode.type;
+        instruction.coord = coord;
+        instruction.a = kNode.a;
+        instruction.b = kNode.b;
+
+        uint32_t result = 0;
+        if (kNode.type == NoiseNodeType::Warp)
+        {
+            // The offsets are sampled at the incoming position, the input at
+            // the warped one
+            instruction.src[0] = Compile(kNode.inputs[1], coord);
+            instruction.src[1] = kNode.inputs[2] >= 0 ? Compile(kNode.inputs[2], coord)
+                                                      : instruction.src[0];
+            instruction.dst = registerCount;
+            registerCount += 2;
+            instructions.push_back(instruction);
+
+            result = Compile(kNode.inputs[0], instruction.dst);
+        }
+        else
+        {
+            for (uint32_t k = 0; k < GetNoiseNodeInputCount(kNode.type); ++k)
+                instruction.src[k] = Compile(kNode.inputs[k], coord);
+
+            if (IsNoiseNodeSource(kNode.type))
+            {
+                FractalNoise<float> noise(PerlinNoise<float>(kNode.seed), kNode.scale, glm::vec3(0.0f),
+                                          static_cast<uint32_t>(kNode.octaves),
+                                          kNode.gain, kNode.lacunarity);
+                noise.SetSeed(kNode.seed);
+                noise.basis = kNode.basis;
+                noise.worleyNoise.SetCellFunction(kNode.cellFunction);
+                noise.worleyNoise.SetCellDistance(kNode.cellDistance);
+                noise.precision = precision;
+                noise.targetSpacing = targetSpacing;
+
+                instruction.noise = static_cast<uint32_t>(noises.size());
+                noises.push_back(noise);
+            }
+
+            instruction.dst = registerCount++;
+            instructions.push_back(instruction);
+            result = instruction.dst;
+        }
+
+        compiled[kKey] = result;
+        return result;
+    }
+};
+
+bool NoiseGraph::Compile(NoiseProgram& program, float precision, float targetSpacing,
+                         std::string& error) const
+{
+    if (!Validate(error))
+        return false;
+
+    NoiseProgram compiled;
+    compiled.m_RegisterCount = 2;
+
+    NoiseGraphCompiler compiler{ m_Nodes, compiled.m_Instructions,
+                                 compiled.m_Noises, compiled.m_RegisterCount,
+                                 precision, targetSpacing, {} };
+    const int32_t kOutput = m_Output >= 0 ? m_Output
+                                          : static_cast<int32_t>(m_Nodes.size()) - 1;
+    compiled.m_Output = compiler.Compile(kOutput, 0);
+
+    program = std::move(compiled);
+    error.clear();
+    return true;
+}
+
+std::string NoiseGraph::ToRecipe() const
+{
+    std::ostringstream recipe;
+    for (const NoiseNode& kNode : m_Nodes)
+    {
+        recipe << kNode.name << " = " << GetNoiseNodeTypeName(kNode.type);
+
+        for (uint32_t k = 0; k < GetNoiseNodeInputCount(kNode.type); ++k)
+            if (kNode.inputs[k] >= 0 && kNode.inputs[k] < static_cast<int32_t>(m_Nodes.size()))
+                recipe << " " << m_Nodes[kNode.inputs[k]].name;
+
+        if (IsNoiseNodeSource(kNode.type))
+        {
+            recipe << " basis=" << s_kBasisNames[static_cast<size_t>(kNode.basis)]
+                   << " seed=" << kNode.seed
+                   << " scale=" << kNode.scale
+                   << " octaves=" << kNode.octaves
+                   << " gain=" << kNode.gain
+                   << " lacunarity=" << kNode.lacunarity;
+            if (kNode.basis == NoiseBasis::Worley)
+                recipe << " cell=" << s_kCellFunctionNames[static_cast<size_t>(kNode.cellFunction)]
+                       << " distance=" << s_kCellDistanceNames[static_cast<size_t>(kNode.cellDistance)];
+        }
+
+        const auto kParamNames = GetNoiseNodeParamNames(kNode.type);
+        if (kParamNames[0])
+            recipe << " " << kParamNames[0] << "=" << kNode.a;
+        if (kParamNames[1])
+            recipe << " " << kParamNames[1] << "=" << kNode.b;
+
+        recipe << "\n";
+    }
+
+    if (m_Output >= 0)
+        recipe << "output " << m_Nodes[m_Output].name << "\n";
+    return recipe.str();
+}
+
+bool NoiseGraph::FromRecipe(const std::string& recipe, std::string& error)
+{
+    NoiseGraph graph;
+
+    std::istringstream lines(recipe);
+    std::string line;
+    uint32_t lineNumber = 0;
+    while (std::getline(lines, line))
+    {
+        ++lineNumber;
+        const std::string kLinePrefix = "line " + std::to_string(lineNumber) + ": ";
+
+        line = line.substr(0, line.find('#'));
+        std::istringstream tokenStream(line);
+        std::vector<std::string> tokens;
+        for (std::string token; tokenStream >> token;)
+            tokens.push_back(token);
+        if (tokens.empty())
+            continue;
+
+        const auto kFindNode = [&graph](const std::string& name) {
+            for (size_t i = 0; i < graph.m_Nodes.size(); ++i)
+                if (graph.m_Nodes[i].name == name)
+                    return static_cast<int32_t>(i);
+            return -1;
+        };
+
+        if (tokens[0] == "output")
+        {
+            graph.m_Output = tokens.size() == 2 ? kFindNode(tokens[1]) : -1;
+            if (graph.m_Output < 0)
+            {
+                error = kLinePrefix + "expected the name of an earlier node after output";
+                return false;
+            }
+            continue;
+        }
+
+        if (tokens.size() < 3 || tokens[1] != "=")
+        {
+            error = kLinePrefix + "expected 'name = type [inputs] [key=value]'";
+            return false;
+        }
+
+        const int32_t kType = FindName(s_kNodeTypeNames, tokens[2]);
+        if (kType < 0)
+        {
+            error = kLinePrefix + "unknown node type '" + tokens[2] + "'";
+            return false;
+        }
+
+        NoiseNode node;
+        node.name = tokens[0];
+        node.type = static_cast<NoiseNodeType>(kType);
+        const auto kParamNames = GetNoiseNodeParamNames(node.type);
+
+        uint32_t inputCount = 0;
+        for (size_t t = 3; t < tokens.size(); ++t)
+        {
+            const size_t kEquals = tokens[t].find('=');
+            if (kEquals == std::string::npos)
+            {
+                const int32_t kInput = kFindNode(tokens[t]);
+                if (kInput < 0 || inputCount >= GetNoiseNodeInputCount(node.type))
+                {
+                    error = kLinePrefix + "unexpected input '" + tokens[t] + "'";
+                    return false;
+                }
+                node.inputs[inputCount++] = kInput;
+                continue;
+            }
+
+            const std::string kKey = tokens[t].substr(0, kEquals);
+            const std::string kValue = tokens[t].substr(kEquals + 1);
+            bool valid = true;
+            if (kKey == "basis")
+            {
+                const int32_t kBasis = FindName(s_kBasisNames, kValue);
+                valid = kBasis >= 0;
+                node.basis = static_cast<NoiseBasis>(std::max(kBasis, 0));
+            }
+            else if (kKey == "cell")
+            {
+                const int32_t kFunction = FindName(s_kCellFunctionNames, kValue);
+                valid = kFunction >= 0;
+                node.cellFunction = static_cast<WorleySIMD::CellFunction>(std::max(kFunction, 0));
+            }
+            else if (kKey == "distance")
+            {
+                const int32_t kDistance = FindName(s_kCellDistanceNames, kValue);
+                valid = kDistance >= 0;
+                node.cellDistance = static_cast<WorleySIMD::CellDistance>(std::max(kDistance, 0));
+            }
+            else if (kKey == "seed")
+                valid = ParseInt(kValue, node.seed);
+            else if (kKey == "octaves")
+                valid = ParseInt(kValue, node.octaves);
+            else if (kKey == "scale")
+                valid = ParseFloat(kValue, node.scale);
+            else if (kKey == "gain")
+                valid = ParseFloat(kValue, node.gain);
+            else if (kKey == "lacunarity")
+                valid = ParseFloat(kValue, node.lacunarity);
+            else if (kParamNames[0] && kKey == kParamNames[0])
+                valid = ParseFloat(kValue, node.a);
+            else if (kParamNames[1] && kKey == kParamNames[1])
+                valid = ParseFloat(kValue, node.b);
+            else
+                valid = false;
+
+            if (!valid)
+            {
+                error = kLinePrefix + "invalid parameter '" + tokens[t] + "'";
+                return false;
+            }
+        }
+
+        graph.m_Nodes.push_back(node);
+    }
+
+    if (!graph.Validate(error))
+        return false;
+
+    *this = std::move(graph);
+    error.clear();
+    return true;
+}
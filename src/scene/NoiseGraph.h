@@ -0,0 +1,174 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "FractalNoise.h"
+
+
+/** @brief Operation of a node, the values are in about [0,1] */
+enum class NoiseNodeType
+{
+    // Sources, sampled at the position of the node
+    Fbm = 0,        ///< Fractal noise, see FractalNoise
+    Ridged,         ///< Ridged multifractal, sharp crests
+    Billow,         ///< Summed absolute noise, rounded hills
+    Constant,       ///< value
+
+    // Combiners
+    Add,            ///< in0 + in1
+    Multiply,       ///< in0 * in1
+    Min,
+    Max,
+    Lerp,           ///< in0 blended to in1 by the mask in2
+
+    // Warps
+    Warp,           ///< in0 sampled at the position offset by in1, in2 (in1 if unset)
+
+    // Curves
+    ScaleBias,      ///< in0 * factor + bias
+    Power,          ///< clamp(in0, 0, 1) ^ exponent
+    Terrace,        ///< in0 quantized to steps, smoothed by softness
+    Clamp,          ///< clamp(in0, min, max)
+    Invert,         ///< 1 - in0
+
+    Count
+};
+
+/** @return Name of the type in the recipes and the GUI */
+const char* GetNoiseNodeTypeName(NoiseNodeType type);
+/** @return Number of inputs read by the type, the optional ones included */
+uint32_t GetNoiseNodeInputCount(NoiseNodeType type);
+/** @return Names of the parameters a and b, null if the type does not use them */
+std::array<const char*, 2> GetNoiseNodeParamNames(NoiseNodeType type);
+bool IsNoiseNodeSource(NoiseNodeType type);
+
+struct NoiseNode
+{
+    std::string name;
+    NoiseNodeType type{ NoiseNodeType::Fbm };
+    /** @brief Indices of the input nodes, only earlier nodes, -1 is unset */
+    std::array<int32_t, 3> inputs{ -1, -1, -1 };
+
+    // Sources, see FractalNoise
+    NoiseBasis basis{ NoiseBasis::Perlin };
+    int32_t seed{ 0 };
+    float scale{ 220.0f };
+    int32_t octaves{ 6 };
+    float gain{ 0.5f };
+    float lacunarity{ 2.0f };
+    WorleySIMD::CellFunction cellFunction{ WorleySIMD::CellFunction::F1 };
+    WorleySIMD::CellDistance cellDistance{ WorleySIMD::CellDistance::Euclidean };
+
+    // Combiners, warps and curves, see GetNoiseNodeParamNames
+    float a{ 1.0f };
+    float b{ 0.0f };
+};
+
+class NoiseGraph;
+
+/**
+ * @brief Noise graph compiled into a flat list of instructions over
+ *  registers of one tile. The whole program runs per tile of
+ *  TILE_WIDTH x TILE_HEIGHT samples, the registers stay in the cache and
+ *  only the final value is written to the map, there are no intermediate
+ *  full resolution buffers.
+ */
+class NoiseProgram
+{
+public:
+    static constexpr uint32_t TILE_WIDTH = 32;
+    static constexpr uint32_t TILE_HEIGHT = 8;
+    static constexpr uint32_t TILE_SIZE = TILE_WIDTH * TILE_HEIGHT;
+
+    /**
+     * @brief Evaluates the map of width x height samples at the integer
+     *  positions, row by row into out
+     * @param[out] min, max Range of the values
+     */
+    void Evaluate(uint32_t width, uint32_t height, float* out,
+                  float& min, float& max) const;
+
+    bool IsEmpty() const { return m_Instructions.empty(); }
+    uint32_t GetInstructionCount() const { return static_cast<uint32_t>(m_Instructions.size()); }
+    uint32_t GetRegisterCount() const { return m_RegisterCount; }
+
+private:
+    friend class NoiseGraph;
+    friend struct NoiseGraphCompiler;
+
+    struct Instruction
+    {
+        NoiseNodeType op{ NoiseNodeType::Constant };
+        uint32_t dst{ 0 };                  ///< Register written, two for the warp
+        std::array<uint32_t, 3> src{};      ///< Input registers
+        uint32_t coord{ 0 };                ///< x register of the position, y follows
+        uint32_t noise{ 0 };                ///< Index of the sources' noise
+        float a{ 0.0f };
+        float b{ 0.0f };
+    };
+
+    /** @brief Runs the instructions on n samples of a tile */
+    void Run(float* registers, float* scratch, size_t n) const;
+    void RunSource(const Instruction& instruction, float* registers,
+                   float* scratch, size_t n) const;
+
+    std::vector<Instruction> m_Instructions;
+    std::vector<FractalNoise<float>> m_Noises;
+    uint32_t m_RegisterCount{ 0 };  ///< Including the sample position in 0 and 1
+    uint32_t m_Output{ 0 };
+};
+
+/**
+ * @brief Small node graph of noise sources, combiners, warps and curves.
+ *  The nodes only read earlier nodes, so the graph is acyclic by
+ *  construction. A warp re-evaluates its input subgraph at the warped
+ *  position, the nodes are compiled once per position they are sampled at.
+ */
+class NoiseGraph
+{
+public:
+    static NoiseGraph CreateDefault();
+
+    std::vector<NoiseNode>& GetNodes() { return m_Nodes; }
+    const std::vector<NoiseNode>& GetNodes() const { return m_Nodes; }
+
+    /** @brief Appends a node named after its index */
+    NoiseNode& AddNode(NoiseNodeType type);
+    /** @brief Removes the node, inputs connected to it are unset */
+    void RemoveNode(uint32_t index);
+
+    /** @brief Index of the node whose value is the height, the last if -1 */
+    int32_t GetOutput() const { return m_Output; }
+    void SetOutput(int32_t output) { m_Output = output; }
+
+    /**
+     * @param precision, targetSpacing Octave culling of the sources, see
+     *  FractalNoise
+     * @return False if the graph is invalid, error describes why
+     */
+    bool Compile(NoiseProgram& program, float precision, float targetSpacing,
+                 std::string& error) const;
+
+    /**
+     * @brief Text recipe, one node per line, e.g.
+     *  base = fbm basis=perlin seed=1 scale=220 octaves=8
+     *  hills = power base exponent=1.5
+     *  output hills
+     */
+    std::string ToRecipe() const;
+    /** @return False if the recipe cannot be parsed, the graph is unchanged */
+    bool FromRecipe(const std::string& recipe, std::string& error);
+
+private:
+    bool Validate(std::string& error) const;
+
+    std::vector<NoiseNode> m_Nodes;
+    int32_t m_Output{ -1 };
+};
@@ -0,0 +1,213 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "NormalSIMD.h"
+
+#include <algorithm>
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+    #define NORMAL_SIMD_X86
+    #include <immintrin.h>
+#endif
+
+#ifdef NORMAL_SIMD_X86
+
+#define TARGET_SSE41  __attribute__((target("sse4.1")))
+#define TARGET_AVX2   __attribute__((target("avx2")))
+
+/**
+ * The kernels mirror glm::cross and glm::normalize operation by operation,
+ *  do not reorder the arithmetic, otherwise the results stop being
+ *  bit-identical to the scalar path.
+ */
+
+// Offsets of the triangle corners around the vertex, (column, row), in the
+//  order the quads of the index buffer list them
+static constexpr int s_kTriangles[6][3][2] = {
+    { { -1, -1 }, {  0,  0 }, {  0, -1 } },     // Top of the upper left quad
+    { { -1, -1 }, { -1,  0 }, {  0,  0 } },     // Bottom of the upper left quad
+    { {  0, -1 }, {  0,  0 }, {  1,  0 } },     // Bottom of the upper right quad
+    { { -1,  0 }, {  0,  1 }, {  0,  0 } },     // Top of the lower left quad
+    { {  0,  0 }, {  1,  1 }, {  1,  0 } },     // Top of the lower right quad
+    { {  0,  0 }, {  0,  1 }, {  1,  1 } }      // Bottom of the lower right quad
+};
+
+// =============================================================================
+// SSE4.1, 4 vertices
+
+struct Vec3x4 { __m128 x, y, z; };
+
+TARGET_SSE41 static inline Vec3x4 Corner4(const float* xs, const float zs[3],
+                                          const float* const heights[3],
+                                          size_t i, const int corner[2])
+{
+    return { _mm_loadu_ps(xs + i + 1 + corner[0]),
+             _mm_loadu_ps(heights[1 + corner[1]] + i + 1 + corner[0]),
+             _mm_set1_ps(zs[1 + corner[1]]) };
+}
+
+TARGET_SSE41 static inline Vec3x4 Normalize4(const Vec3x4& v)
+{
+    // glm::dot sums the products of x and y first
+    const __m128 kDot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v.x, v.x), _mm_mul_ps(v.y, v.y)),
+                                   _mm_mul_ps(v.z, v.z));
+    const __m128 kInvLength = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(kDot));
+    return { _mm_mul_ps(v.x, kInvLength), _mm_mul_ps(v.y, kInvLength),
+             _mm_mul_ps(v.z, kInvLength) };
+}
+
+TARGET_SSE41 static inline Vec3x4 FaceNormal4(const Vec3x4& v0, const Vec3x4& v1,
+                                              const Vec3x4& v2)
+{
+    const Vec3x4 a{ _mm_sub_ps(v1.x, v0.x), _mm_sub_ps(v1.y, v0.y), _mm_sub_ps(v1.z, v0.z) };
+    const Vec3x4 b{ _mm_sub_ps(v2.x, v0.x), _mm_sub_ps(v2.y, v0.y), _mm_sub_ps(v2.z, v0.z) };
+
+    return Normalize4({ _mm_sub_ps(_mm_mul_ps(a.y, b.z), _mm_mul_ps(b.y, a.z)),
+                        _mm_sub_ps(_mm_mul_ps(a.z, b.x), _mm_mul_ps(b.z, a.x)),
+                        _mm_sub_ps(_mm_mul_ps(a.x, b.y), _mm_mul_ps(b.x, a.y)) });
+}
+
+TARGET_SSE41 static void RowNormals_SSE41(const float* xs, const float zs[3],
+                                          const float* const heights[3],
+                                          float* const normals[3], size_t n)
+{
+    for (size_t i = 0; i < n; i += 4)
+    {
+        // Summed onto zero like the scatter, which keeps the sign of zeros
+        Vec3x4 sum{ _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+        for (const auto& kTriangle : s_kTriangles)
+        {
+            const Vec3x4 kNormal = FaceNormal4(Corner4(xs, zs, heights, i, kTriangle[0]),
+                                               Corner4(xs, zs, heights, i, kTriangle[1]),
+                                               Corner4(xs, zs, heights, i, kTriangle[2]));
+            sum = { _mm_add_ps(sum.x, kNormal.x), _mm_add_ps(sum.y, kNormal.y),
+                    _mm_add_ps(sum.z, kNormal.z) };
+        }
+
+        const Vec3x4 kNormal = Normalize4(sum);
+        _mm_storeu_ps(normals[0] + i, kNormal.x);
+        _mm_storeu_ps(normals[1] + i, kNormal.y);
+        _mm_storeu_ps(normals[2] + i, kNormal.z);
+    }
+}
+
+// =============================================================================
+// AVX2, 8 vertices
+
+struct Vec3x8 { __m256 x, y, z; };
+
+TARGET_AVX2 static inline Vec3x8 Corner8(const float* xs, const float zs[3],
+                                         const float* const heights[3],
+                                         size_t i, const int corner[2])
+{
+    return { _mm256_loadu_ps(xs + i + 1 + corner[0]),
+             _mm256_loadu_ps(heights[1 + corner[1]] + i + 1 + corner[0]),
+             _mm256_set1_ps(zs[1 + corner[1]]) };
+}
+
+TARGET_AVX2 static inline Vec3x8 Normalize8(const Vec3x8& v)
+{
+    const __m256 kDot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(v.x, v.x),
+                                                    _mm256_mul_ps(v.y, v.y)),
+                                      _mm256_mul_ps(v.z, v.z));
+    const __m256 kInvLength = _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_sqrt_ps(kDot));
+    return { _mm256_mul_ps(v.x, kInvLength), _mm256_mul_ps(v.y, kInvLength),
+             _mm256_mul_ps(v.z, kInvLength) };
+}
+
+TARGET_AVX2 static inline Vec3x8 FaceNormal8(const Vec3x8& v0, const Vec3x8& v1,
+                                             const Vec3x8& v2)
+{
+    const Vec3x8 a{ _mm256_sub_ps(v1.x, v0.x), _mm256_sub_ps(v1.y, v0.y),
+                    _mm256_sub_ps(v1.z, v0.z) };
+    const Vec3x8 b{ _mm256_sub_ps(v2.x, v0.x), _mm256_sub_ps(v2.y, v0.y),
+                    _mm256_sub_ps(v2.z, v0.z) };
+
+    return Normalize8({ _mm256_sub_ps(_mm256_mul_ps(a.y, b.z), _mm256_mul_ps(b.y, a.z)),
+                        _mm256_sub_ps(_mm256_mul_ps(a.z, b.x), _mm256_mul_ps(b.z, a.x)),
+                        _mm256_sub_ps(_mm256_mul_ps(a.x, b.y), _mm256_mul_ps(b.x, a.y)) });
+}
+
+TARGET_AVX2 static void RowNormals_AVX2(const float* xs, const float zs[3],
+                                        const float* const heights[3],
+                                        float* const normals[3], size_t n)
+{
+    for (size_t i = 0; i < n; i += 8)
+    {
+        Vec3x8 sum{ _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps() };
+        for (const auto& kTriangle : s_kTriangles)
+        {
+            const Vec3x8 kNormal = FaceNormal8(Corner8(xs, zs, heights, i, kTriangle[0]),
+                                               Corner8(xs, zs, heights, i, kTriangle[1]),
+                                               Corner8(xs, zs, heights, i, kTriangle[2]));
+            sum = { _mm256_add_ps(sum.x, kNormal.x), _mm256_add_ps(sum.y, kNormal.y),
+                    _mm256_add_ps(sum.z, kNormal.z) };
+        }
+
+        const Vec3x8 kNormal = Normalize8(sum);
+        _mm256_storeu_ps(normals[0] + i, kNormal.x);
+        _mm256_storeu_ps(normals[1] + i, kNormal.y);
+        _mm256_storeu_ps(normals[2] + i, kNormal.z);
+    }
+}
+
+using KernelRow = void (*)(const float*, const float[3], const float* const[3],
+                           float* const[3], size_t);
+
+#endif // NORMAL_SIMD_X86
+
+// =============================================================================
+
+namespace NormalSIMD
+{
+
+bool RowNormals(PerlinSIMD::ISA isa,
+                const float* xs, const float zs[3], const float* const heights[3],
+                float* const normals[3], size_t n)
+{
+#ifdef NORMAL_SIMD_X86
+    using PerlinSIMD::ISA;
+    if (isa == ISA::Scalar || isa > PerlinSIMD::GetBestISA())
+        return false;
+
+    KernelRow kernel = nullptr;
+    switch (isa)
+    {
+        case ISA::SSE41: kernel = RowNormals_SSE41; break;
+        case ISA::AVX2:  kernel = RowNormals_AVX2; break;
+        default: return false;
+    }
+
+    // Whole blocks of lanes, the tail goes through a zero padded block
+    const uint32_t kLanes = PerlinSIMD::GetLaneCount(isa);
+    const size_t kBlocked = n - n % kLanes;
+    if (kBlocked > 0)
+        kernel(xs, zs, heights, normals, kBlocked);
+
+    const size_t kTail = n - kBlocked;
+    if (kTail == 0)
+        return true;
+
+    constexpr uint32_t kMaxLanes = 8;
+    float x[kMaxLanes + 2]{}, rows[3][kMaxLanes + 2]{}, result[3][kMaxLanes];
+
+    std::copy_n(xs + kBlocked, kTail + 2, x);
+    for (int r = 0; r < 3; ++r)
+        std::copy_n(heights[r] + kBlocked, kTail + 2, rows[r]);
+
+    const float* const kRows[3] = { rows[0], rows[1], rows[2] };
+    float* const kResult[3] = { result[0], result[1], result[2] };
+    kernel(x, zs, kRows, kResult, kLanes);
+
+    for (int c = 0; c < 3; ++c)
+        std::copy_n(result[c], kTail, normals[c] + kBlocked);
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace NormalSIMD
@@ -0,0 +1,39 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "PerlinNoiseSIMD.h"
+
+
+/**
+ * @brief Vectorized gather of the vertex normals of the terrain grid over 4
+ *  (SSE4.1) or 8 (AVX2) vertices of a row. Each vertex sums the normalized
+ *  normals of its six triangles in the order Terrain::GenerateNormals scatters
+ *  them and normalizes the sum, with the operations of glm::cross and
+ *  glm::normalize, so the results are bit-identical to the scalar path, see
+ *  PerlinSIMD for the instruction set selection.
+ */
+namespace NormalSIMD
+{
+    /**
+     * @brief Normals of n consecutive vertices of a row, none of them on the
+     *  border of the grid
+     * @param xs X positions of the columns, n + 2 from the column left of the
+     *  first vertex
+     * @param zs Z positions of the rows above, of and below the vertices
+     * @param heights Heights of the rows above, of and below the vertices,
+     *  n + 2 each from the column left of the first vertex
+     * @param[out] normals Planar, the x, y and z components of n vertices each
+     * @return False if the instruction set has no kernel or is not available
+     */
+    bool RowNormals(PerlinSIMD::ISA isa,
+                    const float* xs, const float zs[3], const float* const heights[3],
+                    float* const normals[3], size_t n);
+
+} // namespace NormalSIMD
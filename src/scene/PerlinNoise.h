@@ -6,11 +6,18 @@
 #pragma once
 
 #include <array>
+#include <cmath>
 #include <algorithm>
+#include <numeric>
 #include <random>
+#include <type_traits>
+#include <vector>
 
 #include <glm/glm.hpp>
 
+#include "PerlinNoiseSIMD.h"
+#include "ScratchBuffer.h"
+
 // TODO to calculate gradient using a switch case, should be faster
 // #define CALC_GRAD_SWITCH
 
@@ -56,6 +63,25 @@ public:
         x -= glm::floor(x);                         // Find relative x,y,z
         y -= glm::floor(y);                         // of point in cube.
         z -= glm::floor(z);
+        return NoiseInCell(X, Y, Z, x, y, z);
+    }
+
+    /** @return Perlin 2D noise value in [-1,1] */
+    T Noise(T x, T y) const
+    {
+        int32_t X = (int32_t)glm::floor(x) & 255;   // Find unit square
+        int32_t Y = (int32_t)glm::floor(y) & 255;   // that contains a point.
+        x -= glm::floor(x);                         // Find relative x,y
+        y -= glm::floor(y);                         // of point in square.
+        return NoiseInCell(X, Y, x, y);
+    }
+
+    /**
+     * @return Perlin 3D noise value in [-1,1] of the point at x,y,z within the
+     *  unit cube X,Y,Z, wrapped to [0,255]
+     */
+    T NoiseInCell(int32_t X, int32_t Y, int32_t Z, T x, T y, T z) const
+    {
         T u = Fade(x);                              // Compute fade curves
         T v = Fade(y);                              // for each x,y,z.
         T w = Fade(z);
@@ -74,18 +100,538 @@ public:
                                        Grad(m_P[BB + 1], x - 1, y - 1, z - 1))));
     }
 
+    /** @return Perlin 2D noise value in [-1,1] within the unit square X,Y */
+    T NoiseInCell(int32_t X, int32_t Y, T x, T y) const
+    {
+        T u = Fade(x);                              // Compute fade curves
+        T v = Fade(y);                              // for each x,y.
+        // Hash coordinates of the 4 square corners.
+        uint32_t A = m_P[X    ] + Y;
+        uint32_t B = m_P[X + 1] + Y;
+
+        // And add blended results from 4 corners of the square
+        return Lerp(v, Lerp(u, Grad(m_P[A], x, y),
+                               Grad(m_P[B], x - 1, y)),
+                       Lerp(u, Grad(m_P[A + 1], x, y - 1),
+                               Grad(m_P[B + 1], x - 1, y - 1)));
+    }
+
+    /**
+     * @return Perlin 2D noise value in [-1,1] along with its analytic partial
+     *  derivatives, x: value (same as Noise(x, y)), y: d/dx, z: d/dy
+     */
+    glm::vec<3, T> NoiseDeriv(T x, T y) const
+    {
+        int32_t X = (int32_t)glm::floor(x) & 255;
+        int32_t Y = (int32_t)glm::floor(y) & 255;
+        x -= glm::floor(x);
+        y -= glm::floor(y);
+        T u = Fade(x);
+        T v = Fade(y);
+        T du = FadeDeriv(x);
+        T dv = FadeDeriv(y);
+        uint32_t A = m_P[X    ] + Y;
+        uint32_t B = m_P[X + 1] + Y;
+
+        // Corner values a: (0,0), b: (1,0), c: (0,1), d: (1,1)
+        const T a = Grad(m_P[A], x, y);
+        const T b = Grad(m_P[B], x - 1, y);
+        const T c = Grad(m_P[A + 1], x, y - 1);
+        const T d = Grad(m_P[B + 1], x - 1, y - 1);
+
+        const glm::vec<2, T> ga = GradVec2(m_P[A]);
+        const glm::vec<2, T> gb = GradVec2(m_P[B]);
+        const glm::vec<2, T> gc = GradVec2(m_P[A + 1]);
+        const glm::vec<2, T> gd = GradVec2(m_P[B + 1]);
+
+        // Noise expanded as: a + u(b-a) + v(c-a) + uv(a-b-c+d)
+        const T k4 = a - b - c + d;
+        const glm::vec<2, T> kDeriv =
+            ga + u * (gb - ga) + v * (gc - ga) + u * v * (ga - gb - gc + gd) +
+            glm::vec<2, T>(du * (b - a + v * k4), dv * (c - a + u * k4));
+
+        return glm::vec<3, T>(Lerp(v, Lerp(u, a, b), Lerp(u, c, d)),
+                              kDeriv.x, kDeriv.y);
+    }
+
+    /**
+     * @return Perlin 3D noise value in [-1,1] along with its analytic partial
+     *  derivatives, x: value (same as Noise(x, y, z)), yzw: d/dx, d/dy, d/dz
+     */
+    glm::vec<4, T> NoiseDeriv(T x, T y, T z) const
+    {
+        int32_t X = (int32_t)glm::floor(x) & 255;
+        int32_t Y = (int32_t)glm::floor(y) & 255;
+        int32_t Z = (int32_t)glm::floor(z) & 255;
+        x -= glm::floor(x);
+        y -= glm::floor(y);
+        z -= glm::floor(z);
+        T u = Fade(x);
+        T v = Fade(y);
+        T w = Fade(z);
+        const glm::vec<3, T> kFadeDeriv(FadeDeriv(x), FadeDeriv(y), FadeDeriv(z));
+        uint32_t A = m_P[X    ] + Y, AA = m_P[A] + Z, AB = m_P[A + 1] + Z;
+        uint32_t B = m_P[X + 1] + Y, BA = m_P[B] + Z, BB = m_P[B + 1] + Z;
+
+        // Corner values a: (0,0,0), b: (1,0,0), c: (0,1,0), d: (1,1,0),
+        //  e: (0,0,1), f: (1,0,1), g: (0,1,1), h: (1,1,1)
+        const T a = Grad(m_P[AA], x, y, z);
+        const T b = Grad(m_P[BA], x - 1, y, z);
+        const T c = Grad(m_P[AB], x, y - 1, z);
+        const T d = Grad(m_P[BB], x - 1, y - 1, z);
+        const T e = Grad(m_P[AA + 1], x, y, z - 1);
+        const T f = Grad(m_P[BA + 1], x - 1, y, z - 1);
+        const T g = Grad(m_P[AB + 1], x, y - 1, z - 1);
+        const T h = Grad(m_P[BB + 1], x - 1, y - 1, z - 1);
+
+        const glm::vec<3, T> ga = GradVec3(m_P[AA]);
+        const glm::vec<3, T> gb = GradVec3(m_P[BA]);
+        const glm::vec<3, T> gc = GradVec3(m_P[AB]);
+        const glm::vec<3, T> gd = GradVec3(m_P[BB]);
+        const glm::vec<3, T> ge = GradVec3(m_P[AA + 1]);
+        const glm::vec<3, T> gf = GradVec3(m_P[BA + 1]);
+        const glm::vec<3, T> gg = GradVec3(m_P[AB + 1]);
+        const glm::vec<3, T> gh = GradVec3(m_P[BB + 1]);
+
+        // Noise expanded as: k0 + k1 u + k2 v + k3 w + k4 uv + k5 vw + k6 wu
+        //  + k7 uvw
+        const T k1 = b - a;
+        const T k2 = c - a;
+        const T k3 = e - a;
+        const T k4 = a - b - c + d;
+        const T k5 = a - c - e + g;
+        const T k6 = a - b - e + f;
+        const T k7 = -a + b + c - d + e - f - g + h;
+
+        const glm::vec<3, T> kDeriv =
+            ga + u * (gb - ga) + v * (gc - ga) + w * (ge - ga) +
+            u * v * (ga - gb - gc + gd) + v * w * (ga - gc - ge + gg) +
+            w * u * (ga - gb - ge + gf) +
+            u * v * w * (-ga + gb + gc - gd + ge - gf - gg + gh) +
+            kFadeDeriv * glm::vec<3, T>(k1 + k4 * v + k6 * w + k7 * v * w,
+                                        k2 + k5 * w + k4 * u + k7 * w * u,
+                                        k3 + k6 * u + k5 * v + k7 * u * v);
+
+        const T kValue =
+            Lerp(w, Lerp(v, Lerp(u, a, b), Lerp(u, c, d)),
+                    Lerp(v, Lerp(u, e, f), Lerp(u, g, h)));
+
+        return glm::vec<4, T>(kValue, kDeriv.x, kDeriv.y, kDeriv.z);
+    }
+
+    /**
+     * @brief Evaluates out[i] = Noise(xs[i], ys[i], zs[i]) for n samples.
+     *  For floats, the samples are processed by the SIMD kernel of the set
+     *  instruction set, within PerlinSIMD::PERLIN_SIMD_MAX_ERROR of Noise().
+     */
+    void NoiseN(const T* xs, const T* ys, const T* zs, T* out, size_t n) const
+    {
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (PerlinSIMD::Noise3D(m_ISA, m_P.data(), xs, ys, zs, out, n))
+                return;
+        }
+
+        for (size_t i = 0; i < n; ++i)
+            out[i] = Noise(xs[i], ys[i], zs[i]);
+    }
+
+    /** @brief Evaluates out[i] = Noise(xs[i], ys[i]) for n samples */
+    void NoiseN(const T* xs, const T* ys, T* out, size_t n) const
+    {
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (PerlinSIMD::Noise2D(m_ISA, m_P.data(), xs, ys, out, n))
+                return;
+        }
+
+        for (size_t i = 0; i < n; ++i)
+            out[i] = Noise(xs[i], ys[i]);
+    }
+
+    /**
+     * @brief Evaluates channelCount decorrelated 2D noises for n samples,
+     *  channel c is Noise(x + offsets[c], y) for integer offsets, with the
+     *  cell lookups offset instead of the coordinates, so the floors,
+     *  fractions and fades are computed once per sample for all channels
+     * @param[out] out Planar, channel c at out + c*n
+     */
+    void NoiseChannelsN(const int32_t* offsets, uint32_t channelCount,
+                        const T* xs, const T* ys, T* out, size_t n) const
+    {
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (PerlinSIMD::Noise2DChannels(m_ISA, m_P.data(), offsets, channelCount,
+                                            xs, ys, out, n))
+                return;
+        }
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            const T kFloorX = glm::floor(xs[i]);
+            const T kFloorY = glm::floor(ys[i]);
+            const int32_t X = (int32_t)kFloorX;
+            const int32_t Y = (int32_t)kFloorY & 255;
+            for (uint32_t c = 0; c < channelCount; ++c)
+                out[c*n + i] = NoiseInCell((X + offsets[c]) & 255, Y,
+                                           xs[i] - kFloorX, ys[i] - kFloorY);
+        }
+    }
+
+    /**
+     * @brief Evaluates out[i] = Noise(xs[i], ys[i], zs[i]) for lattice
+     *  coordinates given in double. Each coordinate is split into its 64-bit
+     *  cell and the in-cell fraction, only the fraction is evaluated in T, so
+     *  the precision does not degrade far from the origin.
+     */
+    void NoiseSplitN(const double* xs, const double* ys, const double* zs,
+                     T* out, size_t n) const
+    {
+        int32_t* cellX = Scratch<int32_t, 0>(n);
+        int32_t* cellY = Scratch<int32_t, 1>(n);
+        int32_t* cellZ = Scratch<int32_t, 2>(n);
+        T* fracX = Scratch<T, 0>(n);
+        T* fracY = Scratch<T, 1>(n);
+        T* fracZ = Scratch<T, 2>(n);
+        SplitCoords(xs, cellX, fracX, n);
+        SplitCoords(ys, cellY, fracY, n);
+        SplitCoords(zs, cellZ, fracZ, n);
+
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (PerlinSIMD::Noise3DSplit(m_ISA, m_P.data(), cellX, cellY, cellZ,
+                                         fracX, fracY, fracZ, out, n))
+                return;
+        }
+
+        for (size_t i = 0; i < n; ++i)
+            out[i] = NoiseInCell(cellX[i], cellY[i], cellZ[i],
+                                 fracX[i], fracY[i], fracZ[i]);
+    }
+
+    /** @brief 2D variant of NoiseSplitN */
+    void NoiseSplitN(const double* xs, const double* ys, T* out, size_t n) const
+    {
+        int32_t* cellX = Scratch<int32_t, 0>(n);
+        int32_t* cellY = Scratch<int32_t, 1>(n);
+        T* fracX = Scratch<T, 0>(n);
+        T* fracY = Scratch<T, 1>(n);
+        SplitCoords(xs, cellX, fracX, n);
+        SplitCoords(ys, cellY, fracY, n);
+
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (PerlinSIMD::Noise2DSplit(m_ISA, m_P.data(), cellX, cellY,
+                                         fracX, fracY, out, n))
+                return;
+        }
+
+        for (size_t i = 0; i < n; ++i)
+            out[i] = NoiseInCell(cellX[i], cellY[i], fracX[i], fracY[i]);
+    }
+
+    /**
+     * @brief Evaluates out[i] = Noise(x0 + i*dx, y, z) for count samples.
+     *  The fade curves and hashes of y and z are computed once per row and the
+     *  corner gradients once per lattice cell, the blend of the 8 corners then
+     *  reduces to two lines in x, within a few ULP of Noise().
+     */
+    void NoiseRow(T y, T z, T x0, T dx, size_t count, T* out) const
+    {
+        if (UseBatchForRow(dx))
+        {
+            T* xs = Scratch<T, 0>(count);
+            T* ys = Scratch<T, 1>(count);
+            T* zs = Scratch<T, 2>(count);
+            for (size_t i = 0; i < count; ++i)
+                xs[i] = x0 + (T)i * dx;
+            std::fill_n(ys, count, y);
+            std::fill_n(zs, count, z);
+            NoiseN(xs, ys, zs, out, count);
+            return;
+        }
+
+        const int32_t kY = (int32_t)glm::floor(y) & 255;
+        const int32_t kZ = (int32_t)glm::floor(z) & 255;
+        y -= glm::floor(y);
+        z -= glm::floor(z);
+        const T kV = Fade(y);
+        const T kW = Fade(z);
+
+        // Corners of a cell face in the order AA, AB, AA + 1, AB + 1
+        const T kWeights[4] = { ((T)1 - kV) * ((T)1 - kW), kV * ((T)1 - kW),
+                                ((T)1 - kV) * kW, kV * kW };
+        const T kCornerY[4] = { y, y - 1, y, y - 1 };
+        const T kCornerZ[4] = { z, z, z - 1, z - 1 };
+
+        size_t i = 0;
+        while (i < count)
+        {
+            // Samples within the same lattice cell share the corner gradients
+            const T kCellX = glm::floor(x0 + (T)i * dx);
+            const size_t end = CellEnd(kCellX, x0, dx, i, count);
+
+            const int32_t kX = (int32_t)kCellX & 255;
+            const uint32_t A = m_P[kX    ] + kY, AA = m_P[A] + kZ, AB = m_P[A + 1] + kZ;
+            const uint32_t B = m_P[kX + 1] + kY, BA = m_P[B] + kZ, BB = m_P[B + 1] + kZ;
+            const uint32_t kHashesA[4] = { m_P[AA], m_P[AB], m_P[AA + 1], m_P[AB + 1] };
+            const uint32_t kHashesB[4] = { m_P[BA], m_P[BB], m_P[BA + 1], m_P[BB + 1] };
+
+            // Faces at x = 0 and x = 1 as lines: slope * x + constant
+            T slopeA = 0, constA = 0, slopeB = 0, constB = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                const glm::vec<3, T> kGradA = GradVec3(kHashesA[c]);
+                const glm::vec<3, T> kGradB = GradVec3(kHashesB[c]);
+                slopeA += kWeights[c] * kGradA.x;
+                constA += kWeights[c] * (kGradA.y * kCornerY[c] + kGradA.z * kCornerZ[c]);
+                slopeB += kWeights[c] * kGradB.x;
+                constB += kWeights[c] * (kGradB.y * kCornerY[c] + kGradB.z * kCornerZ[c]);
+            }
+
+            // 32-bit sample index, converts to T in SIMD registers
+            T* cellOut = out + i;
+            const int32_t kBegin = static_cast<int32_t>(i);
+            const int32_t kCellCount = static_cast<int32_t>(end - i);
+            for (int32_t s = 0; s < kCellCount; ++s)
+            {
+                const T kX = x0 + (T)(kBegin + s) * dx - kCellX;
+                cellOut[s] = Lerp(Fade(kX), slopeA * kX + constA,
+                                        slopeB * (kX - (T)1) + constB);
+            }
+
+            i = end;
+        }
+    }
+
+    /** @brief Evaluates out[i] = Noise(x0 + i*dx, y) for count samples */
+    void NoiseRow(T y, T x0, T dx, size_t count, T* out) const
+    {
+        if (UseBatchForRow(dx))
+        {
+            T* xs = Scratch<T, 0>(count);
+            T* ys = Scratch<T, 1>(count);
+            for (size_t i = 0; i < count; ++i)
+                xs[i] = x0 + (T)i * dx;
+            std::fill_n(ys, count, y);
+            NoiseN(xs, ys, out, count);
+            return;
+        }
+
+        const int32_t kY = (int32_t)glm::floor(y) & 255;
+        y -= glm::floor(y);
+        const T kV = Fade(y);
+
+        size_t i = 0;
+        while (i < count)
+        {
+            const T kCellX = glm::floor(x0 + (T)i * dx);
+            const size_t end = CellEnd(kCellX, x0, dx, i, count);
+
+            const int32_t kX = (int32_t)kCellX & 255;
+            const uint32_t A = m_P[kX    ] + kY;
+            const uint32_t B = m_P[kX + 1] + kY;
+            const glm::vec<2, T> kGradA0 = GradVec2(m_P[A]), kGradA1 = GradVec2(m_P[A + 1]);
+            const glm::vec<2, T> kGradB0 = GradVec2(m_P[B]), kGradB1 = GradVec2(m_P[B + 1]);
+
+            const T kSlopeA = Lerp(kV, kGradA0.x, kGradA1.x);
+            const T kConstA = Lerp(kV, kGradA0.y * y, kGradA1.y * (y - 1));
+            const T kSlopeB = Lerp(kV, kGradB0.x, kGradB1.x);
+            const T kConstB = Lerp(kV, kGradB0.y * y, kGradB1.y * (y - 1));
+
+            // 32-bit sample index, converts to T in SIMD registers
+            T* cellOut = out + i;
+            const int32_t kBegin = static_cast<int32_t>(i);
+            const int32_t kCellCount = static_cast<int32_t>(end - i);
+            for (int32_t s = 0; s < kCellCount; ++s)
+            {
+                const T kX = x0 + (T)(kBegin + s) * dx - kCellX;
+                cellOut[s] = Lerp(Fade(kX), kSlopeA * kX + kConstA,
+                                        kSlopeB * (kX - (T)1) + kConstB);
+            }
+
+            i = end;
+        }
+    }
+
+    /**
+     * @return Perlin 2D noise value in [-1,1] of the lattice wrapping every
+     *  periodX x periodY cells instead of 256, the periods are whole numbers
+     *  below 2^24. The corners of the cell are wrapped separately, so the
+     *  noise is periodic for any period, not only the divisors of 256.
+     */
+    T NoisePeriodic(T x, T y, T periodX, T periodY) const
+    {
+        const T kFloorX = glm::floor(x);
+        const T kFloorY = glm::floor(y);
+        const T kCellX = WrapCell(kFloorX, periodX);
+        const T kCellY = WrapCell(kFloorY, periodY);
+        const uint32_t X0 = (uint32_t)kCellX & 255;
+        const uint32_t Y0 = (uint32_t)kCellY & 255;
+        const uint32_t X1 = (uint32_t)(kCellX + (T)1 == periodX ? (T)0 : kCellX + (T)1) & 255;
+        const uint32_t Y1 = (uint32_t)(kCellY + (T)1 == periodY ? (T)0 : kCellY + (T)1) & 255;
+        x -= kFloorX;
+        y -= kFloorY;
+
+        T u = Fade(x);
+        T v = Fade(y);
+        uint32_t A = m_P[X0];
+        uint32_t B = m_P[X1];
+
+        return Lerp(v, Lerp(u, Grad(m_P[A + Y0], x, y),
+                               Grad(m_P[B + Y0], x - 1, y)),
+                       Lerp(u, Grad(m_P[A + Y1], x, y - 1),
+                               Grad(m_P[B + Y1], x - 1, y - 1)));
+    }
+
+    /** @brief Evaluates out[i] = NoisePeriodic(xs[i], ys[i], periodX, periodY) */
+    void NoisePeriodicN(const T* xs, const T* ys, T periodX, T periodY,
+                        T* out, size_t n) const
+    {
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (PerlinSIMD::Noise2DPeriodic(m_ISA, m_P.data(), periodX, periodY,
+                                            xs, ys, out, n))
+                return;
+        }
+
+        for (size_t i = 0; i < n; ++i)
+            out[i] = NoisePeriodic(xs[i], ys[i], periodX, periodY);
+    }
+
+    /** @return Permutation table, PERMUTATION_COUNT entries repeated once */
+    const uint32_t* GetPermutations() const { return m_P.data(); }
+
+    PerlinSIMD::ISA GetISA() const { return m_ISA; }
+    /** @brief Unsupported instruction sets fall back to the scalar path */
+    void SetISA(PerlinSIMD::ISA isa) { m_ISA = isa; }
+
 private:
+    /** @brief Per thread scratch of the row and split paths, see GetScratchBuffer */
+    template <typename U, uint32_t Slot>
+    static U* Scratch(size_t n) { return GetScratchBuffer<U, PerlinNoise, Slot>(n); }
+
     // Fade fnc, qunitic fnc: 6t^5 - 15t^4 + 10t^3
     constexpr T Fade(T t) const
     {
         return t * t * t * (t * (t * (T)6 - (T)15) + (T)10);
     }
 
+    /**
+     * @return Cell wrapped to [0,period), computed in T like the SIMD kernels
+     *  so that both paths pick the same cells
+     */
+    static T WrapCell(T cell, T period)
+    {
+        const T kWrapped = cell - period * glm::floor(cell / period);
+        return kWrapped >= period ? kWrapped - period
+                                  : kWrapped < (T)0 ? kWrapped + period : kWrapped;
+    }
+
     constexpr T Lerp(T t, T a, T b) const
     {
         return a + t * (b - a);
     }
 
+    // Derivative of the fade fnc: 30t^4 - 60t^3 + 30t^2
+    constexpr T FadeDeriv(T t) const
+    {
+        return (T)30 * t * t * (t * (t - (T)2) + (T)1);
+    }
+
+    /**
+     * @brief Splits a lattice coordinate into its cell, wrapped to the
+     *  permutation period, and the fraction within the cell
+     */
+    static void SplitCoord(double coord, int32_t& cell, T& frac)
+    {
+        // Floor by truncation, cheaper than std::floor without SSE4.1
+        int64_t floor = static_cast<int64_t>(coord);
+        floor -= coord < static_cast<double>(floor) ? 1 : 0;
+        cell = static_cast<int32_t>(floor & 255);
+        frac = static_cast<T>(coord - static_cast<double>(floor));
+    }
+
+    /** @brief Splits n lattice coordinates, vectorized for float */
+    void SplitCoords(const double* coords, int32_t* cells, T* fracs, size_t n) const
+    {
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (PerlinSIMD::SplitCoords(m_ISA, coords, cells, fracs, n))
+                return;
+        }
+
+        for (size_t i = 0; i < n; ++i)
+            SplitCoord(coords[i], cells[i], fracs[i]);
+    }
+
+    /**
+     * @return True if the row has too few samples per lattice cell to amortize
+     *  the corner gradients, the SIMD batch kernels are faster then
+     */
+    bool UseBatchForRow(T dx) const
+    {
+        if constexpr (std::is_same_v<T, float>)
+            return m_ISA != PerlinSIMD::ISA::Scalar && glm::abs(dx) > ROW_BATCH_STEP;
+        return false;
+    }
+
+    /**
+     * @return Index past the last sample x0 + s*dx, from begin on, that lies in
+     *  the lattice cell [cellX, cellX + 1)
+     */
+    size_t CellEnd(T cellX, T x0, T dx, size_t begin, size_t count) const
+    {
+        size_t end = begin + 1;
+        if (dx <= (T)0)
+        {
+            while (end < count && glm::floor(x0 + (T)end * dx) == cellX)
+                ++end;
+            return end;
+        }
+
+        // Estimated from the cell border, then corrected for the rounding
+        const T kNextCell = cellX + (T)1;
+        const T kEstimate = glm::ceil((kNextCell - x0) / dx);
+        if (kEstimate > (T)end)
+            end = std::min(count, static_cast<size_t>(kEstimate));
+        while (end > begin + 1 && x0 + (T)(end - 1) * dx >= kNextCell)
+            --end;
+        while (end < count && x0 + (T)end * dx < kNextCell)
+            ++end;
+        return end;
+    }
+
+    /** @return Gradient direction of the 2D Grad() for the hash */
+    glm::vec<2, T> GradVec2(int hash) const
+    {
+        int h = hash & 7;
+        return glm::vec<2, T>(
+            h < 6 ? ((h & 1) == 0 ? (T)1 : (T)-1) : (T)0,
+            h < 4 ? ((h & 2) == 0 ? (T)1 : (T)-1)
+                  : h < 6 ? (T)0 : ((h & 1) == 0 ? (T)1 : (T)-1));
+    }
+
+    /** @return Gradient direction of the 3D Grad() for the hash */
+    glm::vec<3, T> GradVec3(int hash) const
+    {
+        int h = hash & 15;
+        glm::vec<3, T> g(0);
+        g[h < 8 ? 0 : 1] = (h & 1) == 0 ? (T)1 : (T)-1;
+        g[h < 4 ? 1 : h == 12 || h == 14 ? 0 : 2] = (h & 2) == 0 ? (T)1 : (T)-1;
+        return g;
+    }
+
+    constexpr T Grad(int hash, T x, T y) const
+    {
+        // Convert LO 3 bits of hash code into 8 gradient directions,
+        //  4 diagonal and 4 axis-aligned
+        int h = hash & 7;
+        T u = h < 6 ? x : y;
+        T v = h < 4 ? y : (T)0;
+        return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+    }
+
 #ifndef CALC_GRAD_SWITCH
     constexpr T Grad(int hash, T x, T y, T z) const
     {
@@ -124,8 +670,12 @@ private:
 
 private:
     static const size_t PERMUTATION_COUNT = 256;
+    /** @brief Sample spacing above which NoiseRow uses the batch kernels */
+    static constexpr T ROW_BATCH_STEP = (T)1 / (T)16;
 
     std::array<uint32_t, PERMUTATION_COUNT*2> m_P;    ///< Permutations
     int32_t m_Seed{ 0 };
+
+    PerlinSIMD::ISA m_ISA{ PerlinSIMD::GetBestISA() };
 };
 
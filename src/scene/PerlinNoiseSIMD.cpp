@@ -0,0 +1,1435 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "PerlinNoiseSIMD.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+    #define PERLIN_SIMD_X86
+    #include <immintrin.h>
+#endif
+
+#ifdef PERLIN_SIMD_X86
+
+#define TARGET_SSE41  __attribute__((target("sse4.1")))
+#define TARGET_AVX2   __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+
+/**
+ * Each kernel below mirrors PerlinNoise::Noise operation by operation,
+ *  do not reorder the arithmetic, otherwise the results stop being
+ *  bit-identical to the scalar path.
+ */
+
+// =============================================================================
+// SSE4.1, 4 samples, no gather instruction, the lookups are done per lane
+
+TARGET_SSE41 static inline __m128i Gather4(const uint32_t* perm, __m128i idx)
+{
+    return _mm_setr_epi32(perm[_mm_extract_epi32(idx, 0)],
+                          perm[_mm_extract_epi32(idx, 1)],
+                          perm[_mm_extract_epi32(idx, 2)],
+                          perm[_mm_extract_epi32(idx, 3)]);
+}
+
+TARGET_SSE41 static inline __m128 Fade4(__m128 t)
+{
+    const __m128 kT3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+    __m128 p = _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.f)), _mm_set1_ps(15.f));
+    p = _mm_add_ps(_mm_mul_ps(t, p), _mm_set1_ps(10.f));
+    return _mm_mul_ps(kT3, p);
+}
+
+TARGET_SSE41 static inline __m128 Lerp4(__m128 t, __m128 a, __m128 b)
+{
+    return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+TARGET_SSE41 static inline __m128 Grad4(__m128i hash,
+                                        __m128 x, __m128 y, __m128 z)
+{
+    const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+
+    const __m128 kLt8 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+    const __m128 kLt4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+    const __m128 kIs12or14 = _mm_castsi128_ps(
+        _mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)),
+                     _mm_cmpeq_epi32(h, _mm_set1_epi32(14))));
+
+    const __m128 u = _mm_blendv_ps(y, x, kLt8);
+    const __m128 v = _mm_blendv_ps(_mm_blendv_ps(z, x, kIs12or14), y, kLt4);
+
+    const __m128 kSignU = _mm_castsi128_ps(
+        _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+    const __m128 kSignV = _mm_castsi128_ps(
+        _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+
+    return _mm_add_ps(_mm_xor_ps(u, kSignU), _mm_xor_ps(v, kSignV));
+}
+
+/** @brief 3D noise of samples given as wrapped lattice cells and in-cell fractions */
+TARGET_SSE41 static inline __m128 Noise3D4Cell(const uint32_t* perm,
+                                               __m128i X, __m128i Y, __m128i Z,
+                                               __m128 x, __m128 y, __m128 z)
+{
+    const __m128i kOne = _mm_set1_epi32(1);
+    const __m128 kOnef = _mm_set1_ps(1.f);
+
+    const __m128 u = Fade4(x);
+    const __m128 v = Fade4(y);
+    const __m128 w = Fade4(z);
+
+    const __m128i A  = _mm_add_epi32(Gather4(perm, X), Y);
+    const __m128i AA = _mm_add_epi32(Gather4(perm, A), Z);
+    const __m128i AB = _mm_add_epi32(Gather4(perm, _mm_add_epi32(A, kOne)), Z);
+    const __m128i B  = _mm_add_epi32(Gather4(perm, _mm_add_epi32(X, kOne)), Y);
+    const __m128i BA = _mm_add_epi32(Gather4(perm, B), Z);
+    const __m128i BB = _mm_add_epi32(Gather4(perm, _mm_add_epi32(B, kOne)), Z);
+
+    const __m128 x1 = _mm_sub_ps(x, kOnef);
+    const __m128 y1 = _mm_sub_ps(y, kOnef);
+    const __m128 z1 = _mm_sub_ps(z, kOnef);
+
+    return Lerp4(w,
+        Lerp4(v, Lerp4(u, Grad4(Gather4(perm, AA), x,  y, z),
+                          Grad4(Gather4(perm, BA), x1, y, z)),
+                 Lerp4(u, Grad4(Gather4(perm, AB), x,  y1, z),
+                          Grad4(Gather4(perm, BB), x1, y1, z))),
+        Lerp4(v, Lerp4(u, Grad4(Gather4(perm, _mm_add_epi32(AA, kOne)), x,  y, z1),
+                          Grad4(Gather4(perm, _mm_add_epi32(BA, kOne)), x1, y, z1)),
+                 Lerp4(u, Grad4(Gather4(perm, _mm_add_epi32(AB, kOne)), x,  y1, z1),
+                          Grad4(Gather4(perm, _mm_add_epi32(BB, kOne)), x1, y1, z1))));
+}
+
+TARGET_SSE41 static inline __m128 Noise3D4(const uint32_t* perm,
+                                           __m128 x, __m128 y, __m128 z)
+{
+    const __m128i kMask = _mm_set1_epi32(255);
+
+    const __m128 kFloorX = _mm_floor_ps(x);
+    const __m128 kFloorY = _mm_floor_ps(y);
+    const __m128 kFloorZ = _mm_floor_ps(z);
+    const __m128i X = _mm_and_si128(_mm_cvttps_epi32(kFloorX), kMask);
+    const __m128i Y = _mm_and_si128(_mm_cvttps_epi32(kFloorY), kMask);
+    const __m128i Z = _mm_and_si128(_mm_cvttps_epi32(kFloorZ), kMask);
+    x = _mm_sub_ps(x, kFloorX);
+    y = _mm_sub_ps(y, kFloorY);
+    z = _mm_sub_ps(z, kFloorZ);
+
+    return Noise3D4Cell(perm, X, Y, Z, x, y, z);
+}
+
+TARGET_SSE41 static void Noise3D_SSE41(const uint32_t* perm,
+    const float* xs, const float* ys, const float* zs, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 4)
+    {
+        _mm_storeu_ps(out + i, Noise3D4(perm, _mm_loadu_ps(xs + i),
+                                              _mm_loadu_ps(ys + i),
+                                              _mm_loadu_ps(zs + i)));
+    }
+}
+
+TARGET_SSE41 static void Noise3DSplit_SSE41(const uint32_t* perm,
+    const int32_t* cellXs, const int32_t* cellYs, const int32_t* cellZs,
+    const float* xs, const float* ys, const float* zs, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 4)
+    {
+        _mm_storeu_ps(out + i, Noise3D4Cell(perm,
+                                            _mm_loadu_si128((const __m128i*)(cellXs + i)),
+                                            _mm_loadu_si128((const __m128i*)(cellYs + i)),
+                                            _mm_loadu_si128((const __m128i*)(cellZs + i)),
+                                            _mm_loadu_ps(xs + i),
+                                            _mm_loadu_ps(ys + i),
+                                            _mm_loadu_ps(zs + i)));
+    }
+}
+
+TARGET_SSE41 static inline __m128 Grad2D4(__m128i hash, __m128 x, __m128 y)
+{
+    const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(7));
+
+    const __m128 kLt6 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(6)));
+    const __m128 kLt4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+
+    const __m128 u = _mm_blendv_ps(y, x, kLt6);
+    const __m128 v = _mm_and_ps(y, kLt4);
+
+    const __m128 kSignU = _mm_castsi128_ps(
+        _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+    const __m128 kSignV = _mm_castsi128_ps(
+        _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+
+    return _mm_add_ps(_mm_xor_ps(u, kSignU), _mm_xor_ps(v, kSignV));
+}
+
+/** @brief 2D noise of samples given as wrapped lattice cells and in-cell fractions */
+TARGET_SSE41 static inline __m128 Noise2D4Cell(const uint32_t* perm,
+                                               __m128i X, __m128i Y,
+                                               __m128 x, __m128 y)
+{
+    const __m128i kOne = _mm_set1_epi32(1);
+    const __m128 kOnef = _mm_set1_ps(1.f);
+
+    const __m128 u = Fade4(x);
+    const __m128 v = Fade4(y);
+
+    const __m128i A = _mm_add_epi32(Gather4(perm, X), Y);
+    const __m128i B = _mm_add_epi32(Gather4(perm, _mm_add_epi32(X, kOne)), Y);
+
+    const __m128 x1 = _mm_sub_ps(x, kOnef);
+    const __m128 y1 = _mm_sub_ps(y, kOnef);
+
+    return Lerp4(v, Lerp4(u, Grad2D4(Gather4(perm, A), x,  y),
+                             Grad2D4(Gather4(perm, B), x1, y)),
+                    Lerp4(u, Grad2D4(Gather4(perm, _mm_add_epi32(A, kOne)), x,  y1),
+                             Grad2D4(Gather4(perm, _mm_add_epi32(B, kOne)), x1, y1)));
+}
+
+TARGET_SSE41 static inline __m128 Noise2D4(const uint32_t* perm,
+                                           __m128 x, __m128 y)
+{
+    const __m128i kMask = _mm_set1_epi32(255);
+
+    const __m128 kFloorX = _mm_floor_ps(x);
+    const __m128 kFloorY = _mm_floor_ps(y);
+    const __m128i X = _mm_and_si128(_mm_cvttps_epi32(kFloorX), kMask);
+    const __m128i Y = _mm_and_si128(_mm_cvttps_epi32(kFloorY), kMask);
+    x = _mm_sub_ps(x, kFloorX);
+    y = _mm_sub_ps(y, kFloorY);
+
+    return Noise2D4Cell(perm, X, Y, x, y);
+}
+
+TARGET_SSE41 static void Noise2D_SSE41(const uint32_t* perm,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 4)
+    {
+        _mm_storeu_ps(out + i, Noise2D4(perm, _mm_loadu_ps(xs + i),
+                                              _mm_loadu_ps(ys + i)));
+    }
+}
+
+TARGET_SSE41 static void Noise2DSplit_SSE41(const uint32_t* perm,
+    const int32_t* cellXs, const int32_t* cellYs,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 4)
+    {
+        _mm_storeu_ps(out + i, Noise2D4Cell(perm,
+                                            _mm_loadu_si128((const __m128i*)(cellXs + i)),
+                                            _mm_loadu_si128((const __m128i*)(cellYs + i)),
+                                            _mm_loadu_ps(xs + i),
+                                            _mm_loadu_ps(ys + i)));
+    }
+}
+
+/**
+ * @brief 2D noise of several channels, the cell of channel c is offset by
+ *  offsets[c] along x, the floors, fractions and fades are computed once
+ */
+TARGET_SSE41 static void Noise2DChannels_SSE41(const uint32_t* perm,
+    const int32_t* offsets, uint32_t channelCount,
+    const float* xs, const float* ys, float* out, size_t stride, size_t n)
+{
+    const __m128i kMask = _mm_set1_epi32(255);
+    const __m128i kOne = _mm_set1_epi32(1);
+    const __m128 kOnef = _mm_set1_ps(1.f);
+
+    for (size_t i = 0; i < n; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+        const __m128 kFloorX = _mm_floor_ps(x);
+        const __m128 kFloorY = _mm_floor_ps(y);
+        const __m128i X = _mm_cvttps_epi32(kFloorX);
+        const __m128i Y = _mm_and_si128(_mm_cvttps_epi32(kFloorY), kMask);
+        x = _mm_sub_ps(x, kFloorX);
+        y = _mm_sub_ps(y, kFloorY);
+
+        const __m128 u = Fade4(x);
+        const __m128 v = Fade4(y);
+        const __m128 x1 = _mm_sub_ps(x, kOnef);
+        const __m128 y1 = _mm_sub_ps(y, kOnef);
+
+        for (uint32_t c = 0; c < channelCount; ++c)
+        {
+            const __m128i kX = _mm_and_si128(
+                _mm_add_epi32(X, _mm_set1_epi32(offsets[c])), kMask);
+            const __m128i A = _mm_add_epi32(Gather4(perm, kX), Y);
+            const __m128i B = _mm_add_epi32(Gather4(perm, _mm_add_epi32(kX, kOne)), Y);
+
+            _mm_storeu_ps(out + c*stride + i,
+                Lerp4(v, Lerp4(u, Grad2D4(Gather4(perm, A), x,  y),
+                                  Grad2D4(Gather4(perm, B), x1, y)),
+                         Lerp4(u, Grad2D4(Gather4(perm, _mm_add_epi32(A, kOne)), x,  y1),
+                                  Grad2D4(Gather4(perm, _mm_add_epi32(B, kOne)), x1, y1))));
+        }
+    }
+}
+
+/** @brief Cell wrapped to [0,period), see PerlinNoise::WrapCell */
+TARGET_SSE41 static inline __m128 WrapCell4(__m128 cell, __m128 period)
+{
+    __m128 w = _mm_sub_ps(cell, _mm_mul_ps(period, _mm_floor_ps(_mm_div_ps(cell, period))));
+    w = _mm_blendv_ps(w, _mm_sub_ps(w, period), _mm_cmpge_ps(w, period));
+    return _mm_blendv_ps(w, _mm_add_ps(w, period), _mm_cmplt_ps(w, _mm_setzero_ps()));
+}
+
+/** @brief Cell following the wrapped cell, 0 after the last one */
+TARGET_SSE41 static inline __m128 NextCell4(__m128 cell, __m128 period)
+{
+    const __m128 kNext = _mm_add_ps(cell, _mm_set1_ps(1.f));
+    return _mm_blendv_ps(kNext, _mm_setzero_ps(), _mm_cmpeq_ps(kNext, period));
+}
+
+/**
+ * @brief 2D noise of the lattice wrapping every periodX x periodY cells, the
+ *  cells of both corners are wrapped separately
+ */
+TARGET_SSE41 static void Noise2DPeriodic_SSE41(const uint32_t* perm,
+    float periodX, float periodY,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    const __m128i kMask = _mm_set1_epi32(255);
+    const __m128 kOnef = _mm_set1_ps(1.f);
+    const __m128 kPeriodX = _mm_set1_ps(periodX);
+    const __m128 kPeriodY = _mm_set1_ps(periodY);
+
+    for (size_t i = 0; i < n; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+        const __m128 kFloorX = _mm_floor_ps(x);
+        const __m128 kFloorY = _mm_floor_ps(y);
+        const __m128 kCellX = WrapCell4(kFloorX, kPeriodX);
+        const __m128 kCellY = WrapCell4(kFloorY, kPeriodY);
+        const __m128i X0 = _mm_and_si128(_mm_cvttps_epi32(kCellX), kMask);
+        const __m128i Y0 = _mm_and_si128(_mm_cvttps_epi32(kCellY), kMask);
+        const __m128i X1 = _mm_and_si128(_mm_cvttps_epi32(NextCell4(kCellX, kPeriodX)), kMask);
+        const __m128i Y1 = _mm_and_si128(_mm_cvttps_epi32(NextCell4(kCellY, kPeriodY)), kMask);
+        x = _mm_sub_ps(x, kFloorX);
+        y = _mm_sub_ps(y, kFloorY);
+
+        const __m128 u = Fade4(x);
+        const __m128 v = Fade4(y);
+        const __m128i A = Gather4(perm, X0);
+        const __m128i B = Gather4(perm, X1);
+        const __m128 x1 = _mm_sub_ps(x, kOnef);
+        const __m128 y1 = _mm_sub_ps(y, kOnef);
+
+        _mm_storeu_ps(out + i,
+            Lerp4(v, Lerp4(u, Grad2D4(Gather4(perm, _mm_add_epi32(A, Y0)), x,  y),
+                              Grad2D4(Gather4(perm, _mm_add_epi32(B, Y0)), x1, y)),
+                     Lerp4(u, Grad2D4(Gather4(perm, _mm_add_epi32(A, Y1)), x,  y1),
+                              Grad2D4(Gather4(perm, _mm_add_epi32(B, Y1)), x1, y1))));
+    }
+}
+
+
+// =============================================================================
+// AVX2, 8 samples
+
+TARGET_AVX2 static inline __m256i Gather8(const uint32_t* perm, __m256i idx)
+{
+    return _mm256_i32gather_epi32(reinterpret_cast<const int*>(perm), idx, 4);
+}
+
+TARGET_AVX2 static inline __m256 Fade8(__m256 t)
+{
+    const __m256 kT3 = _mm256_mul_ps(_mm256_mul_ps(t, t), t);
+    __m256 p = _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.f)),
+                             _mm256_set1_ps(15.f));
+    p = _mm256_add_ps(_mm256_mul_ps(t, p), _mm256_set1_ps(10.f));
+    return _mm256_mul_ps(kT3, p);
+}
+
+TARGET_AVX2 static inline __m256 Lerp8(__m256 t, __m256 a, __m256 b)
+{
+    return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+}
+
+TARGET_AVX2 static inline __m256 Grad8(__m256i hash,
+                                       __m256 x, __m256 y, __m256 z)
+{
+    const __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+
+    const __m256 kLt8 = _mm256_castsi256_ps(
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(8), h));
+    const __m256 kLt4 = _mm256_castsi256_ps(
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+    const __m256 kIs12or14 = _mm256_castsi256_ps(
+        _mm256_or_si256(_mm256_cmpeq_epi32(h, _mm256_set1_epi32(12)),
+                        _mm256_cmpeq_epi32(h, _mm256_set1_epi32(14))));
+
+    const __m256 u = _mm256_blendv_ps(y, x, kLt8);
+    const __m256 v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, kIs12or14),
+                                      y, kLt4);
+
+    const __m256 kSignU = _mm256_castsi256_ps(
+        _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31));
+    const __m256 kSignV = _mm256_castsi256_ps(
+        _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+
+    return _mm256_add_ps(_mm256_xor_ps(u, kSignU), _mm256_xor_ps(v, kSignV));
+}
+
+/** @brief 3D noise of samples given as wrapped lattice cells and in-cell fractions */
+TARGET_AVX2 static inline __m256 Noise3D8Cell(const uint32_t* perm,
+                                              __m256i X, __m256i Y, __m256i Z,
+                                              __m256 x, __m256 y, __m256 z)
+{
+    const __m256i kOne = _mm256_set1_epi32(1);
+    const __m256 kOnef = _mm256_set1_ps(1.f);
+
+    const __m256 u = Fade8(x);
+    const __m256 v = Fade8(y);
+    const __m256 w = Fade8(z);
+
+    const __m256i A  = _mm256_add_epi32(Gather8(perm, X), Y);
+    const __m256i AA = _mm256_add_epi32(Gather8(perm, A), Z);
+    const __m256i AB = _mm256_add_epi32(Gather8(perm, _mm256_add_epi32(A, kOne)), Z);
+    const __m256i B  = _mm256_add_epi32(Gather8(perm, _mm256_add_epi32(X, kOne)), Y);
+    const __m256i BA = _mm256_add_epi32(Gather8(perm, B), Z);
+    const __m256i BB = _mm256_add_epi32(Gather8(perm, _mm256_add_epi32(B, kOne)), Z);
+
+    const __m256 x1 = _mm256_sub_ps(x, kOnef);
+    const __m256 y1 = _mm256_sub_ps(y, kOnef);
+    const __m256 z1 = _mm256_sub_ps(z, kOnef);
+
+    return Lerp8(w,
+        Lerp8(v, Lerp8(u, Grad8(Gather8(perm, AA), x,  y, z),
+                          Grad8(Gather8(perm, BA), x1, y, z)),
+                 Lerp8(u, Grad8(Gather8(perm, AB), x,  y1, z),
+                          Grad8(Gather8(perm, BB), x1, y1, z))),
+        Lerp8(v, Lerp8(u, Grad8(Gather8(perm, _mm256_add_epi32(AA, kOne)), x,  y, z1),
+                          Grad8(Gather8(perm, _mm256_add_epi32(BA, kOne)), x1, y, z1)),
+                 Lerp8(u, Grad8(Gather8(perm, _mm256_add_epi32(AB, kOne)), x,  y1, z1),
+                          Grad8(Gather8(perm, _mm256_add_epi32(BB, kOne)), x1, y1, z1))));
+}
+
+TARGET_AVX2 static inline __m256 Noise3D8(const uint32_t* perm,
+                                          __m256 x, __m256 y, __m256 z)
+{
+    const __m256i kMask = _mm256_set1_epi32(255);
+
+    const __m256 kFloorX = _mm256_floor_ps(x);
+    const __m256 kFloorY = _mm256_floor_ps(y);
+    const __m256 kFloorZ = _mm256_floor_ps(z);
+    const __m256i X = _mm256_and_si256(_mm256_cvttps_epi32(kFloorX), kMask);
+    const __m256i Y = _mm256_and_si256(_mm256_cvttps_epi32(kFloorY), kMask);
+    const __m256i Z = _mm256_and_si256(_mm256_cvttps_epi32(kFloorZ), kMask);
+    x = _mm256_sub_ps(x, kFloorX);
+    y = _mm256_sub_ps(y, kFloorY);
+    z = _mm256_sub_ps(z, kFloorZ);
+
+    return Noise3D8Cell(perm, X, Y, Z, x, y, z);
+}
+
+TARGET_AVX2 static void Noise3D_AVX2(const uint32_t* perm,
+    const float* xs, const float* ys, const float* zs, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 8)
+    {
+        _mm256_storeu_ps(out + i, Noise3D8(perm, _mm256_loadu_ps(xs + i),
+                                                 _mm256_loadu_ps(ys + i),
+                                                 _mm256_loadu_ps(zs + i)));
+    }
+}
+
+TARGET_AVX2 static void Noise3DSplit_AVX2(const uint32_t* perm,
+    const int32_t* cellXs, const int32_t* cellYs, const int32_t* cellZs,
+    const float* xs, const float* ys, const float* zs, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 8)
+    {
+        _mm256_storeu_ps(out + i, Noise3D8Cell(perm,
+                                               _mm256_loadu_si256((const __m256i*)(cellXs + i)),
+                                               _mm256_loadu_si256((const __m256i*)(cellYs + i)),
+                                               _mm256_loadu_si256((const __m256i*)(cellZs + i)),
+                                               _mm256_loadu_ps(xs + i),
+                                               _mm256_loadu_ps(ys + i),
+                                               _mm256_loadu_ps(zs + i)));
+    }
+}
+
+TARGET_AVX2 static inline __m256 Grad2D8(__m256i hash, __m256 x, __m256 y)
+{
+    const __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(7));
+
+    const __m256 kLt6 = _mm256_castsi256_ps(
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(6), h));
+    const __m256 kLt4 = _mm256_castsi256_ps(
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+
+    const __m256 u = _mm256_blendv_ps(y, x, kLt6);
+    const __m256 v = _mm256_and_ps(y, kLt4);
+
+    const __m256 kSignU = _mm256_castsi256_ps(
+        _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31));
+    const __m256 kSignV = _mm256_castsi256_ps(
+        _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+
+    return _mm256_add_ps(_mm256_xor_ps(u, kSignU), _mm256_xor_ps(v, kSignV));
+}
+
+/** @brief 2D noise of samples given as wrapped lattice cells and in-cell fractions */
+TARGET_AVX2 static inline __m256 Noise2D8Cell(const uint32_t* perm,
+                                              __m256i X, __m256i Y,
+                                              __m256 x, __m256 y)
+{
+    const __m256i kOne = _mm256_set1_epi32(1);
+    const __m256 kOnef = _mm256_set1_ps(1.f);
+
+    const __m256 u = Fade8(x);
+    const __m256 v = Fade8(y);
+
+    const __m256i A = _mm256_add_epi32(Gather8(perm, X), Y);
+    const __m256i B = _mm256_add_epi32(Gather8(perm, _mm256_add_epi32(X, kOne)), Y);
+
+    const __m256 x1 = _mm256_sub_ps(x, kOnef);
+    const __m256 y1 = _mm256_sub_ps(y, kOnef);
+
+    return Lerp8(v, Lerp8(u, Grad2D8(Gather8(perm, A), x,  y),
+                             Grad2D8(Gather8(perm, B), x1, y)),
+                    Lerp8(u, Grad2D8(Gather8(perm, _mm256_add_epi32(A, kOne)), x,  y1),
+                             Grad2D8(Gather8(perm, _mm256_add_epi32(B, kOne)), x1, y1)));
+}
+
+TARGET_AVX2 static inline __m256 Noise2D8(const uint32_t* perm,
+                                          __m256 x, __m256 y)
+{
+    const __m256i kMask = _mm256_set1_epi32(255);
+
+    const __m256 kFloorX = _mm256_floor_ps(x);
+    const __m256 kFloorY = _mm256_floor_ps(y);
+    const __m256i X = _mm256_and_si256(_mm256_cvttps_epi32(kFloorX), kMask);
+    const __m256i Y = _mm256_and_si256(_mm256_cvttps_epi32(kFloorY), kMask);
+    x = _mm256_sub_ps(x, kFloorX);
+    y = _mm256_sub_ps(y, kFloorY);
+
+    return Noise2D8Cell(perm, X, Y, x, y);
+}
+
+TARGET_AVX2 static void Noise2D_AVX2(const uint32_t* perm,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 8)
+    {
+        _mm256_storeu_ps(out + i, Noise2D8(perm, _mm256_loadu_ps(xs + i),
+                                                 _mm256_loadu_ps(ys + i)));
+    }
+}
+
+TARGET_AVX2 static void Noise2DSplit_AVX2(const uint32_t* perm,
+    const int32_t* cellXs, const int32_t* cellYs,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 8)
+    {
+        _mm256_storeu_ps(out + i, Noise2D8Cell(perm,
+                                               _mm256_loadu_si256((const __m256i*)(cellXs + i)),
+                                               _mm256_loadu_si256((const __m256i*)(cellYs + i)),
+                                               _mm256_loadu_ps(xs + i),
+                                               _mm256_loadu_ps(ys + i)));
+    }
+}
+
+/** @brief 2D noise of several channels, @see Noise2DChannels_SSE41 */
+TARGET_AVX2 static void Noise2DChannels_AVX2(const uint32_t* perm,
+    const int32_t* offsets, uint32_t channelCount,
+    const float* xs, const float* ys, float* out, size_t stride, size_t n)
+{
+    const __m256i kMask = _mm256_set1_epi32(255);
+    const __m256i kOne = _mm256_set1_epi32(1);
+    const __m256 kOnef = _mm256_set1_ps(1.f);
+
+    for (size_t i = 0; i < n; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        const __m256 kFloorX = _mm256_floor_ps(x);
+        const __m256 kFloorY = _mm256_floor_ps(y);
+        const __m256i X = _mm256_cvttps_epi32(kFloorX);
+        const __m256i Y = _mm256_and_si256(_mm256_cvttps_epi32(kFloorY), kMask);
+        x = _mm256_sub_ps(x, kFloorX);
+        y = _mm256_sub_ps(y, kFloorY);
+
+        const __m256 u = Fade8(x);
+        const __m256 v = Fade8(y);
+        const __m256 x1 = _mm256_sub_ps(x, kOnef);
+        const __m256 y1 = _mm256_sub_ps(y, kOnef);
+
+        for (uint32_t c = 0; c < channelCount; ++c)
+        {
+            const __m256i kX = _mm256_and_si256(
+                _mm256_add_epi32(X, _mm256_set1_epi32(offsets[c])), kMask);
+            const __m256i A = _mm256_add_epi32(Gather8(perm, kX), Y);
+            const __m256i B = _mm256_add_epi32(Gather8(perm, _mm256_add_epi32(kX, kOne)), Y);
+
+            _mm256_storeu_ps(out + c*stride + i,
+                Lerp8(v, Lerp8(u, Grad2D8(Gather8(perm, A), x,  y),
+                                  Grad2D8(Gather8(perm, B), x1, y)),
+                         Lerp8(u, Grad2D8(Gather8(perm, _mm256_add_epi32(A, kOne)), x,  y1),
+                                  Grad2D8(Gather8(perm, _mm256_add_epi32(B, kOne)), x1, y1))));
+        }
+    }
+}
+
+TARGET_AVX2 static inline __m256 WrapCell8(__m256 cell, __m256 period)
+{
+    __m256 w = _mm256_sub_ps(cell, _mm256_mul_ps(period,
+        _mm256_floor_ps(_mm256_div_ps(cell, period))));
+    w = _mm256_blendv_ps(w, _mm256_sub_ps(w, period), _mm256_cmp_ps(w, period, _CMP_GE_OQ));
+    return _mm256_blendv_ps(w, _mm256_add_ps(w, period),
+                            _mm256_cmp_ps(w, _mm256_setzero_ps(), _CMP_LT_OQ));
+}
+
+TARGET_AVX2 static inline __m256 NextCell8(__m256 cell, __m256 period)
+{
+    const __m256 kNext = _mm256_add_ps(cell, _mm256_set1_ps(1.f));
+    return _mm256_blendv_ps(kNext, _mm256_setzero_ps(),
+                            _mm256_cmp_ps(kNext, period, _CMP_EQ_OQ));
+}
+
+/** @brief 2D noise of a periodic lattice, @see Noise2DPeriodic_SSE41 */
+TARGET_AVX2 static void Noise2DPeriodic_AVX2(const uint32_t* perm,
+    float periodX, float periodY,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    const __m256i kMask = _mm256_set1_epi32(255);
+    const __m256 kOnef = _mm256_set1_ps(1.f);
+    const __m256 kPeriodX = _mm256_set1_ps(periodX);
+    const __m256 kPeriodY = _mm256_set1_ps(periodY);
+
+    for (size_t i = 0; i < n; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        const __m256 kFloorX = _mm256_floor_ps(x);
+        const __m256 kFloorY = _mm256_floor_ps(y);
+        const __m256 kCellX = WrapCell8(kFloorX, kPeriodX);
+        const __m256 kCellY = WrapCell8(kFloorY, kPeriodY);
+        const __m256i X0 = _mm256_and_si256(_mm256_cvttps_epi32(kCellX), kMask);
+        const __m256i Y0 = _mm256_and_si256(_mm256_cvttps_epi32(kCellY), kMask);
+        const __m256i X1 = _mm256_and_si256(
+            _mm256_cvttps_epi32(NextCell8(kCellX, kPeriodX)), kMask);
+        const __m256i Y1 = _mm256_and_si256(
+            _mm256_cvttps_epi32(NextCell8(kCellY, kPeriodY)), kMask);
+        x = _mm256_sub_ps(x, kFloorX);
+        y = _mm256_sub_ps(y, kFloorY);
+
+        const __m256 u = Fade8(x);
+        const __m256 v = Fade8(y);
+        const __m256i A = Gather8(perm, X0);
+        const __m256i B = Gather8(perm, X1);
+        const __m256 x1 = _mm256_sub_ps(x, kOnef);
+        const __m256 y1 = _mm256_sub_ps(y, kOnef);
+
+        _mm256_storeu_ps(out + i,
+            Lerp8(v, Lerp8(u, Grad2D8(Gather8(perm, _mm256_add_epi32(A, Y0)), x,  y),
+                              Grad2D8(Gather8(perm, _mm256_add_epi32(B, Y0)), x1, y)),
+                     Lerp8(u, Grad2D8(Gather8(perm, _mm256_add_epi32(A, Y1)), x,  y1),
+                              Grad2D8(Gather8(perm, _mm256_add_epi32(B, Y1)), x1, y1))));
+    }
+}
+
+
+// =============================================================================
+// AVX-512, 16 samples
+
+TARGET_AVX512 static inline __m512i Gather16(const uint32_t* perm, __m512i idx)
+{
+    return _mm512_i32gather_epi32(idx, reinterpret_cast<const int*>(perm), 4);
+}
+
+TARGET_AVX512 static inline __m512 Fade16(__m512 t)
+{
+    const __m512 kT3 = _mm512_mul_ps(_mm512_mul_ps(t, t), t);
+    __m512 p = _mm512_sub_ps(_mm512_mul_ps(t, _mm512_set1_ps(6.f)),
+                             _mm512_set1_ps(15.f));
+    p = _mm512_add_ps(_mm512_mul_ps(t, p), _mm512_set1_ps(10.f));
+    return _mm512_mul_ps(kT3, p);
+}
+
+TARGET_AVX512 static inline __m512 Lerp16(__m512 t, __m512 a, __m512 b)
+{
+    return _mm512_add_ps(a, _mm512_mul_ps(t, _mm512_sub_ps(b, a)));
+}
+
+TARGET_AVX512 static inline __m512 Grad16(__m512i hash,
+                                          __m512 x, __m512 y, __m512 z)
+{
+    const __m512i h = _mm512_and_si512(hash, _mm512_set1_epi32(15));
+
+    const __mmask16 kLt8 = _mm512_cmplt_epi32_mask(h, _mm512_set1_epi32(8));
+    const __mmask16 kLt4 = _mm512_cmplt_epi32_mask(h, _mm512_set1_epi32(4));
+    const __mmask16 kIs12or14 =
+        _mm512_cmpeq_epi32_mask(h, _mm512_set1_epi32(12)) |
+        _mm512_cmpeq_epi32_mask(h, _mm512_set1_epi32(14));
+
+    const __m512 u = _mm512_mask_blend_ps(kLt8, y, x);
+    const __m512 v = _mm512_mask_blend_ps(kLt4,
+        _mm512_mask_blend_ps(kIs12or14, z, x), y);
+
+    // Sign flip through the integer domain, AVX512F lacks _mm512_xor_ps
+    const __m512i kSignU =
+        _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(1)), 31);
+    const __m512i kSignV =
+        _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(2)), 30);
+
+    return _mm512_add_ps(
+        _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(u), kSignU)),
+        _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(v), kSignV)));
+}
+
+/** @brief 3D noise of samples given as wrapped lattice cells and in-cell fractions */
+TARGET_AVX512 static inline __m512 Noise3D16Cell(const uint32_t* perm,
+                                                 __m512i X, __m512i Y, __m512i Z,
+                                                 __m512 x, __m512 y, __m512 z)
+{
+    const __m512i kOne = _mm512_set1_epi32(1);
+    const __m512 kOnef = _mm512_set1_ps(1.f);
+
+    const __m512 u = Fade16(x);
+    const __m512 v = Fade16(y);
+    const __m512 w = Fade16(z);
+
+    const __m512i A  = _mm512_add_epi32(Gather16(perm, X), Y);
+    const __m512i AA = _mm512_add_epi32(Gather16(perm, A), Z);
+    const __m512i AB = _mm512_add_epi32(Gather16(perm, _mm512_add_epi32(A, kOne)), Z);
+    const __m512i B  = _mm512_add_epi32(Gather16(perm, _mm512_add_epi32(X, kOne)), Y);
+    const __m512i BA = _mm512_add_epi32(Gather16(perm, B), Z);
+    const __m512i BB = _mm512_add_epi32(Gather16(perm, _mm512_add_epi32(B, kOne)), Z);
+
+    const __m512 x1 = _mm512_sub_ps(x, kOnef);
+    const __m512 y1 = _mm512_sub_ps(y, kOnef);
+    const __m512 z1 = _mm512_sub_ps(z, kOnef);
+
+    return Lerp16(w,
+        Lerp16(v, Lerp16(u, Grad16(Gather16(perm, AA), x,  y, z),
+                            Grad16(Gather16(perm, BA), x1, y, z)),
+                  Lerp16(u, Grad16(Gather16(perm, AB), x,  y1, z),
+                            Grad16(Gather16(perm, BB), x1, y1, z))),
+        Lerp16(v, Lerp16(u, Grad16(Gather16(perm, _mm512_add_epi32(AA, kOne)), x,  y, z1),
+                            Grad16(Gather16(perm, _mm512_add_epi32(BA, kOne)), x1, y, z1)),
+                  Lerp16(u, Grad16(Gather16(perm, _mm512_add_epi32(AB, kOne)), x,  y1, z1),
+                            Grad16(Gather16(perm, _mm512_add_epi32(BB, kOne)), x1, y1, z1))));
+}
+
+TARGET_AVX512 static inline __m512 Noise3D16(const uint32_t* perm,
+                                             __m512 x, __m512 y, __m512 z)
+{
+    const __m512i kMask = _mm512_set1_epi32(255);
+
+    const __m512 kFloorX = _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF);
+    const __m512 kFloorY = _mm512_roundscale_ps(y, _MM_FROUND_TO_NEG_INF);
+    const __m512 kFloorZ = _mm512_roundscale_ps(z, _MM_FROUND_TO_NEG_INF);
+    const __m512i X = _mm512_and_si512(_mm512_cvttps_epi32(kFloorX), kMask);
+    const __m512i Y = _mm512_and_si512(_mm512_cvttps_epi32(kFloorY), kMask);
+    const __m512i Z = _mm512_and_si512(_mm512_cvttps_epi32(kFloorZ), kMask);
+    x = _mm512_sub_ps(x, kFloorX);
+    y = _mm512_sub_ps(y, kFloorY);
+    z = _mm512_sub_ps(z, kFloorZ);
+
+    return Noise3D16Cell(perm, X, Y, Z, x, y, z);
+}
+
+TARGET_AVX512 static void Noise3D_AVX512(const uint32_t* perm,
+    const float* xs, const float* ys, const float* zs, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 16)
+    {
+        _mm512_storeu_ps(out + i, Noise3D16(perm, _mm512_loadu_ps(xs + i),
+                                                  _mm512_loadu_ps(ys + i),
+                                                  _mm512_loadu_ps(zs + i)));
+    }
+}
+
+TARGET_AVX512 static void Noise3DSplit_AVX512(const uint32_t* perm,
+    const int32_t* cellXs, const int32_t* cellYs, const int32_t* cellZs,
+    const float* xs, const float* ys, const float* zs, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 16)
+    {
+        _mm512_storeu_ps(out + i, Noise3D16Cell(perm,
+                                                _mm512_loadu_si512(cellXs + i),
+                                                _mm512_loadu_si512(cellYs + i),
+                                                _mm512_loadu_si512(cellZs + i),
+                                                _mm512_loadu_ps(xs + i),
+                                                _mm512_loadu_ps(ys + i),
+                                                _mm512_loadu_ps(zs + i)));
+    }
+}
+
+TARGET_AVX512 static inline __m512 Grad2D16(__m512i hash, __m512 x, __m512 y)
+{
+    const __m512i h = _mm512_and_si512(hash, _mm512_set1_epi32(7));
+
+    const __mmask16 kLt6 = _mm512_cmplt_epi32_mask(h, _mm512_set1_epi32(6));
+    const __mmask16 kLt4 = _mm512_cmplt_epi32_mask(h, _mm512_set1_epi32(4));
+
+    const __m512 u = _mm512_mask_blend_ps(kLt6, y, x);
+    const __m512 v = _mm512_maskz_mov_ps(kLt4, y);
+
+    const __m512i kSignU =
+        _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(1)), 31);
+    const __m512i kSignV =
+        _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(2)), 30);
+
+    return _mm512_add_ps(
+        _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(u), kSignU)),
+        _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(v), kSignV)));
+}
+
+/** @brief 2D noise of samples given as wrapped lattice cells and in-cell fractions */
+TARGET_AVX512 static inline __m512 Noise2D16Cell(const uint32_t* perm,
+                                                 __m512i X, __m512i Y,
+                                                 __m512 x, __m512 y)
+{
+    const __m512i kOne = _mm512_set1_epi32(1);
+    const __m512 kOnef = _mm512_set1_ps(1.f);
+
+    const __m512 u = Fade16(x);
+    const __m512 v = Fade16(y);
+
+    const __m512i A = _mm512_add_epi32(Gather16(perm, X), Y);
+    const __m512i B = _mm512_add_epi32(Gather16(perm, _mm512_add_epi32(X, kOne)), Y);
+
+    const __m512 x1 = _mm512_sub_ps(x, kOnef);
+    const __m512 y1 = _mm512_sub_ps(y, kOnef);
+
+    return Lerp16(v, Lerp16(u, Grad2D16(Gather16(perm, A), x,  y),
+                               Grad2D16(Gather16(perm, B), x1, y)),
+                     Lerp16(u, Grad2D16(Gather16(perm, _mm512_add_epi32(A, kOne)), x,  y1),
+                               Grad2D16(Gather16(perm, _mm512_add_epi32(B, kOne)), x1, y1)));
+}
+
+TARGET_AVX512 static inline __m512 Noise2D16(const uint32_t* perm,
+                                             __m512 x, __m512 y)
+{
+    const __m512i kMask = _mm512_set1_epi32(255);
+
+    const __m512 kFloorX = _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF);
+    const __m512 kFloorY = _mm512_roundscale_ps(y, _MM_FROUND_TO_NEG_INF);
+    const __m512i X = _mm512_and_si512(_mm512_cvttps_epi32(kFloorX), kMask);
+    const __m512i Y = _mm512_and_si512(_mm512_cvttps_epi32(kFloorY), kMask);
+    x = _mm512_sub_ps(x, kFloorX);
+    y = _mm512_sub_ps(y, kFloorY);
+
+    return Noise2D16Cell(perm, X, Y, x, y);
+}
+
+TARGET_AVX512 static void Noise2D_AVX512(const uint32_t* perm,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 16)
+    {
+        _mm512_storeu_ps(out + i, Noise2D16(perm, _mm512_loadu_ps(xs + i),
+                                                  _mm512_loadu_ps(ys + i)));
+    }
+}
+
+TARGET_AVX512 static void Noise2DSplit_AVX512(const uint32_t* perm,
+    const int32_t* cellXs, const int32_t* cellYs,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 16)
+    {
+        _mm512_storeu_ps(out + i, Noise2D16Cell(perm,
+                                                _mm512_loadu_si512(cellXs + i),
+                                                _mm512_loadu_si512(cellYs + i),
+                                                _mm512_loadu_ps(xs + i),
+                                                _mm512_loadu_ps(ys + i)));
+    }
+}
+
+/** @brief 2D noise of several channels, @see Noise2DChannels_SSE41 */
+TARGET_AVX512 static void Noise2DChannels_AVX512(const uint32_t* perm,
+    const int32_t* offsets, uint32_t channelCount,
+    const float* xs, const float* ys, float* out, size_t stride, size_t n)
+{
+    const __m512i kMask = _mm512_set1_epi32(255);
+    const __m512i kOne = _mm512_set1_epi32(1);
+    const __m512 kOnef = _mm512_set1_ps(1.f);
+
+    for (size_t i = 0; i < n; i += 16)
+    {
+        __m512 x = _mm512_loadu_ps(xs + i);
+        __m512 y = _mm512_loadu_ps(ys + i);
+        const __m512 kFloorX = _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF);
+        const __m512 kFloorY = _mm512_roundscale_ps(y, _MM_FROUND_TO_NEG_INF);
+        const __m512i X = _mm512_cvttps_epi32(kFloorX);
+        const __m512i Y = _mm512_and_si512(_mm512_cvttps_epi32(kFloorY), kMask);
+        x = _mm512_sub_ps(x, kFloorX);
+        y = _mm512_sub_ps(y, kFloorY);
+
+        const __m512 u = Fade16(x);
+        const __m512 v = Fade16(y);
+        const __m512 x1 = _mm512_sub_ps(x, kOnef);
+        const __m512 y1 = _mm512_sub_ps(y, kOnef);
+
+        for (uint32_t c = 0; c < channelCount; ++c)
+        {
+            const __m512i kX = _mm512_and_si512(
+                _mm512_add_epi32(X, _mm512_set1_epi32(offsets[c])), kMask);
+            const __m512i A = _mm512_add_epi32(Gather16(perm, kX), Y);
+            const __m512i B = _mm512_add_epi32(Gather16(perm, _mm512_add_epi32(kX, kOne)), Y);
+
+            _mm512_storeu_ps(out + c*stride + i,
+                Lerp16(v, Lerp16(u, Grad2D16(Gather16(perm, A), x,  y),
+                                    Grad2D16(Gather16(perm, B), x1, y)),
+                          Lerp16(u, Grad2D16(Gather16(perm, _mm512_add_epi32(A, kOne)), x,  y1),
+                                    Grad2D16(Gather16(perm, _mm512_add_epi32(B, kOne)), x1, y1))));
+        }
+    }
+}
+
+TARGET_AVX512 static inline __m512 WrapCell16(__m512 cell, __m512 period)
+{
+    __m512 w = _mm512_sub_ps(cell, _mm512_mul_ps(period,
+        _mm512_roundscale_ps(_mm512_div_ps(cell, period), _MM_FROUND_TO_NEG_INF)));
+    w = _mm512_mask_sub_ps(w, _mm512_cmp_ps_mask(w, period, _CMP_GE_OQ), w, period);
+    return _mm512_mask_add_ps(w, _mm512_cmp_ps_mask(w, _mm512_setzero_ps(), _CMP_LT_OQ),
+                              w, period);
+}
+
+TARGET_AVX512 static inline __m512 NextCell16(__m512 cell, __m512 period)
+{
+    const __m512 kNext = _mm512_add_ps(cell, _mm512_set1_ps(1.f));
+    return _mm512_mask_mov_ps(kNext, _mm512_cmp_ps_mask(kNext, period, _CMP_EQ_OQ),
+                              _mm512_setzero_ps());
+}
+
+/** @brief 2D noise of a periodic lattice, @see Noise2DPeriodic_SSE41 */
+TARGET_AVX512 static void Noise2DPeriodic_AVX512(const uint32_t* perm,
+    float periodX, float periodY,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    const __m512i kMask = _mm512_set1_epi32(255);
+    const __m512 kOnef = _mm512_set1_ps(1.f);
+    const __m512 kPeriodX = _mm512_set1_ps(periodX);
+    const __m512 kPeriodY = _mm512_set1_ps(periodY);
+
+    for (size_t i = 0; i < n; i += 16)
+    {
+        __m512 x = _mm512_loadu_ps(xs + i);
+        __m512 y = _mm512_loadu_ps(ys + i);
+        const __m512 kFloorX = _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF);
+        const __m512 kFloorY = _mm512_roundscale_ps(y, _MM_FROUND_TO_NEG_INF);
+        const __m512 kCellX = WrapCell16(kFloorX, kPeriodX);
+        const __m512 kCellY = WrapCell16(kFloorY, kPeriodY);
+        const __m512i X0 = _mm512_and_si512(_mm512_cvttps_epi32(kCellX), kMask);
+        const __m512i Y0 = _mm512_and_si512(_mm512_cvttps_epi32(kCellY), kMask);
+        const __m512i X1 = _mm512_and_si512(
+            _mm512_cvttps_epi32(NextCell16(kCellX, kPeriodX)), kMask);
+        const __m512i Y1 = _mm512_and_si512(
+            _mm512_cvttps_epi32(NextCell16(kCellY, kPeriodY)), kMask);
+        x = _mm512_sub_ps(x, kFloorX);
+        y = _mm512_sub_ps(y, kFloorY);
+
+        const __m512 u = Fade16(x);
+        const __m512 v = Fade16(y);
+        const __m512i A = Gather16(perm, X0);
+        const __m512i B = Gather16(perm, X1);
+        const __m512 x1 = _mm512_sub_ps(x, kOnef);
+        const __m512 y1 = _mm512_sub_ps(y, kOnef);
+
+        _mm512_storeu_ps(out + i,
+            Lerp16(v, Lerp16(u, Grad2D16(Gather16(perm, _mm512_add_epi32(A, Y0)), x,  y),
+                                Grad2D16(Gather16(perm, _mm512_add_epi32(B, Y0)), x1, y)),
+                      Lerp16(u, Grad2D16(Gather16(perm, _mm512_add_epi32(A, Y1)), x,  y1),
+                                Grad2D16(Gather16(perm, _mm512_add_epi32(B, Y1)), x1, y1))));
+    }
+}
+
+
+// =============================================================================
+// Splitting of double lattice coordinates into wrapped cells and fractions.
+//  The coordinate is first reduced to [0,256), exact for the power of two
+//  period, so the cell fits into 32 bits even far away from the origin.
+
+TARGET_SSE41 static void SplitCoords_SSE41(const double* coords, int32_t* cells,
+                                           float* fracs, size_t n)
+{
+    const __m128d kInvPeriod = _mm_set1_pd(1.0 / 256.0);
+    const __m128d kPeriod = _mm_set1_pd(256.0);
+    const __m128i kMask = _mm_set1_epi32(255);
+    for (size_t i = 0; i < n; i += 2)
+    {
+        const __m128d kCoord = _mm_loadu_pd(coords + i);
+        const __m128d kWrapped = _mm_sub_pd(kCoord, _mm_mul_pd(kPeriod,
+            _mm_floor_pd(_mm_mul_pd(kCoord, kInvPeriod))));
+        const __m128d kFloor = _mm_floor_pd(kWrapped);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(cells + i),
+                         _mm_and_si128(_mm_cvttpd_epi32(kFloor), kMask));
+        _mm_storel_pi(reinterpret_cast<__m64*>(fracs + i),
+                      _mm_cvtpd_ps(_mm_sub_pd(kWrapped, kFloor)));
+    }
+}
+
+TARGET_AVX2 static void SplitCoords_AVX2(const double* coords, int32_t* cells,
+                                         float* fracs, size_t n)
+{
+    const __m256d kInvPeriod = _mm256_set1_pd(1.0 / 256.0);
+    const __m256d kPeriod = _mm256_set1_pd(256.0);
+    const __m128i kMask = _mm_set1_epi32(255);
+    for (size_t i = 0; i < n; i += 4)
+    {
+        const __m256d kCoord = _mm256_loadu_pd(coords + i);
+        const __m256d kWrapped = _mm256_sub_pd(kCoord, _mm256_mul_pd(kPeriod,
+            _mm256_floor_pd(_mm256_mul_pd(kCoord, kInvPeriod))));
+        const __m256d kFloor = _mm256_floor_pd(kWrapped);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(cells + i),
+                         _mm_and_si128(_mm256_cvttpd_epi32(kFloor), kMask));
+        _mm_storeu_ps(fracs + i, _mm256_cvtpd_ps(_mm256_sub_pd(kWrapped, kFloor)));
+    }
+}
+
+TARGET_AVX512 static void SplitCoords_AVX512(const double* coords, int32_t* cells,
+                                             float* fracs, size_t n)
+{
+    const __m512d kInvPeriod = _mm512_set1_pd(1.0 / 256.0);
+    const __m512d kPeriod = _mm512_set1_pd(256.0);
+    const __m256i kMask = _mm256_set1_epi32(255);
+    for (size_t i = 0; i < n; i += 8)
+    {
+        const __m512d kCoord = _mm512_loadu_pd(coords + i);
+        const __m512d kWrapped = _mm512_sub_pd(kCoord, _mm512_mul_pd(kPeriod,
+            _mm512_floor_pd(_mm512_mul_pd(kCoord, kInvPeriod))));
+        const __m512d kFloor = _mm512_floor_pd(kWrapped);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(cells + i),
+                            _mm256_and_si256(_mm512_cvttpd_epi32(kFloor), kMask));
+        _mm256_storeu_ps(fracs + i, _mm512_cvtpd_ps(_mm512_sub_pd(kWrapped, kFloor)));
+    }
+}
+
+#endif // PERLIN_SIMD_X86
+
+// =============================================================================
+
+namespace PerlinSIMD
+{
+
+using Kernel3D = void (*)(const uint32_t*, const float*, const float*,
+                          const float*, float*, size_t);
+
+/**
+ * @brief Runs the kernel on whole blocks of lanes, the remaining tail is
+ *  copied into a zero padded block, so the kernels never read out of bounds
+ */
+static void RunKernel3D(Kernel3D kernel, uint32_t lanes, const uint32_t* perm,
+                        const float* xs, const float* ys, const float* zs,
+                        float* out, size_t n)
+{
+    const size_t kBlocked = n - n % lanes;
+    if (kBlocked > 0)
+        kernel(perm, xs, ys, zs, out, kBlocked);
+
+    const size_t kTail = n - kBlocked;
+    if (kTail == 0)
+        return;
+
+    constexpr uint32_t kMaxLanes = 16;
+    float x[kMaxLanes]{}, y[kMaxLanes]{}, z[kMaxLanes]{}, result[kMaxLanes];
+
+    std::copy_n(xs + kBlocked, kTail, x);
+    std::copy_n(ys + kBlocked, kTail, y);
+    std::copy_n(zs + kBlocked, kTail, z);
+
+    kernel(perm, x, y, z, result, lanes);
+
+    std::copy_n(result, kTail, out + kBlocked);
+}
+
+using Kernel2D = void (*)(const uint32_t*, const float*, const float*,
+                          float*, size_t);
+
+static void RunKernel2D(Kernel2D kernel, uint32_t lanes, const uint32_t* perm,
+                        const float* xs, const float* ys,
+                        float* out, size_t n)
+{
+    const size_t kBlocked = n - n % lanes;
+    if (kBlocked > 0)
+        kernel(perm, xs, ys, out, kBlocked);
+
+    const size_t kTail = n - kBlocked;
+    if (kTail == 0)
+        return;
+
+    constexpr uint32_t kMaxLanes = 16;
+    float x[kMaxLanes]{}, y[kMaxLanes]{}, result[kMaxLanes];
+
+    std::copy_n(xs + kBlocked, kTail, x);
+    std::copy_n(ys + kBlocked, kTail, y);
+
+    kernel(perm, x, y, result, lanes);
+
+    std::copy_n(result, kTail, out + kBlocked);
+}
+
+using Kernel3DSplit = void (*)(const uint32_t*,
+                               const int32_t*, const int32_t*, const int32_t*,
+                               const float*, const float*, const float*,
+                               float*, size_t);
+
+static void RunKernel3DSplit(Kernel3DSplit kernel, uint32_t lanes, const uint32_t* perm,
+                             const int32_t* cellXs, const int32_t* cellYs,
+                             const int32_t* cellZs,
+                             const float* xs, const float* ys, const float* zs,
+                             float* out, size_t n)
+{
+    const size_t kBlocked = n - n % lanes;
+    if (kBlocked > 0)
+        kernel(perm, cellXs, cellYs, cellZs, xs, ys, zs, out, kBlocked);
+
+    const size_t kTail = n - kBlocked;
+    if (kTail == 0)
+        return;
+
+    constexpr uint32_t kMaxLanes = 16;
+    int32_t cellX[kMaxLanes]{}, cellY[kMaxLanes]{}, cellZ[kMaxLanes]{};
+    float x[kMaxLanes]{}, y[kMaxLanes]{}, z[kMaxLanes]{}, result[kMaxLanes];
+
+    std::copy_n(cellXs + kBlocked, kTail, cellX);
+    std::copy_n(cellYs + kBlocked, kTail, cellY);
+    std::copy_n(cellZs + kBlocked, kTail, cellZ);
+    std::copy_n(xs + kBlocked, kTail, x);
+    std::copy_n(ys + kBlocked, kTail, y);
+    std::copy_n(zs + kBlocked, kTail, z);
+
+    kernel(perm, cellX, cellY, cellZ, x, y, z, result, lanes);
+
+    std::copy_n(result, kTail, out + kBlocked);
+}
+
+using Kernel2DSplit = void (*)(const uint32_t*, const int32_t*, const int32_t*,
+                               const float*, const float*, float*, size_t);
+
+static void RunKernel2DSplit(Kernel2DSplit kernel, uint32_t lanes, const uint32_t* perm,
+                             const int32_t* cellXs, const int32_t* cellYs,
+                             const float* xs, const float* ys,
+                             float* out, size_t n)
+{
+    const size_t kBlocked = n - n % lanes;
+    if (kBlocked > 0)
+        kernel(perm, cellXs, cellYs, xs, ys, out, kBlocked);
+
+    const size_t kTail = n - kBlocked;
+    if (kTail == 0)
+        return;
+
+    constexpr uint32_t kMaxLanes = 16;
+    int32_t cellX[kMaxLanes]{}, cellY[kMaxLanes]{};
+    float x[kMaxLanes]{}, y[kMaxLanes]{}, result[kMaxLanes];
+
+    std::copy_n(cellXs + kBlocked, kTail, cellX);
+    std::copy_n(cellYs + kBlocked, kTail, cellY);
+    std::copy_n(xs + kBlocked, kTail, x);
+    std::copy_n(ys + kBlocked, kTail, y);
+
+    kernel(perm, cellX, cellY, x, y, result, lanes);
+
+    std::copy_n(result, kTail, out + kBlocked);
+}
+
+using Kernel2DChannels = void (*)(const uint32_t*, const int32_t*, uint32_t,
+                                  const float*, const float*, float*, size_t, size_t);
+
+static void RunKernel2DChannels(Kernel2DChannels kernel, uint32_t lanes,
+                                const uint32_t* perm,
+                                const int32_t* offsets, uint32_t channelCount,
+                                const float* xs, const float* ys,
+                                float* out, size_t n)
+{
+    const size_t kBlocked = n - n % lanes;
+    if (kBlocked > 0)
+        kernel(perm, offsets, channelCount, xs, ys, out, n, kBlocked);
+
+    const size_t kTail = n - kBlocked;
+    if (kTail == 0)
+        return;
+
+    constexpr uint32_t kMaxLanes = 16;
+    float x[kMaxLanes]{}, y[kMaxLanes]{}, result[kMaxLanes * MAX_CHANNELS];
+
+    std::copy_n(xs + kBlocked, kTail, x);
+    std::copy_n(ys + kBlocked, kTail, y);
+
+    kernel(perm, offsets, channelCount, x, y, result, kMaxLanes, lanes);
+
+    for (uint32_t c = 0; c < channelCount; ++c)
+        std::copy_n(result + c*kMaxLanes, kTail, out + c*n + kBlocked);
+}
+
+using Kernel2DPeriodic = void (*)(const uint32_t*, float, float,
+                                  const float*, const float*, float*, size_t);
+
+static void RunKernel2DPeriodic(Kernel2DPeriodic kernel, uint32_t lanes,
+                                const uint32_t* perm, float periodX, float periodY,
+                                const float* xs, const float* ys,
+                                float* out, size_t n)
+{
+    const size_t kBlocked = n - n % lanes;
+    if (kBlocked > 0)
+        kernel(perm, periodX, periodY, xs, ys, out, kBlocked);
+
+    const size_t kTail = n - kBlocked;
+    if (kTail == 0)
+        return;
+
+    constexpr uint32_t kMaxLanes = 16;
+    float x[kMaxLanes]{}, y[kMaxLanes]{}, result[kMaxLanes];
+
+    std::copy_n(xs + kBlocked, kTail, x);
+    std::copy_n(ys + kBlocked, kTail, y);
+
+    kernel(perm, periodX, periodY, x, y, result, lanes);
+
+    std::copy_n(result, kTail, out + kBlocked);
+}
+
+
+ISA GetBestISA()
+{
+#ifdef PERLIN_SIMD_X86
+    static const ISA s_kBestISA = []() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return ISA::AVX512;
+        if (__builtin_cpu_supports("avx2"))
+            return ISA::AVX2;
+        if (__builtin_cpu_supports("sse4.1"))
+            return ISA::SSE41;
+        return ISA::Scalar;
+    }();
+    return s_kBestISA;
+#else
+    return ISA::Scalar;
+#endif
+}
+
+const char* GetISAName(ISA isa)
+{
+    switch (isa)
+    {
+        case ISA::SSE41:  return "SSE4.1";
+        case ISA::AVX2:   return "AVX2";
+        case ISA::AVX512: return "AVX-512";
+        default:          return "Scalar";
+    }
+}
+
+uint32_t GetLaneCount(ISA isa)
+{
+    switch (isa)
+    {
+        case ISA::SSE41:  return 4;
+        case ISA::AVX2:   return 8;
+        case ISA::AVX512: return 16;
+        default:          return 1;
+    }
+}
+
+bool Noise3D(ISA isa, const uint32_t* perm,
+             const float* xs, const float* ys, const float* zs,
+             float* out, size_t n)
+{
+#ifdef PERLIN_SIMD_X86
+    if (isa == ISA::Scalar || isa > GetBestISA())
+        return false;
+
+    Kernel3D kernel = nullptr;
+    switch (isa)
+    {
+        case ISA::SSE41:  kernel = Noise3D_SSE41; break;
+        case ISA::AVX2:   kernel = Noise3D_AVX2; break;
+        case ISA::AVX512: kernel = Noise3D_AVX512; break;
+        default: return false;
+    }
+
+    RunKernel3D(kernel, GetLaneCount(isa), perm, xs, ys, zs, out, n);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Noise2D(ISA isa, const uint32_t* perm,
+             const float* xs, const float* ys,
+             float* out, size_t n)
+{
+#ifdef PERLIN_SIMD_X86
+    if (isa == ISA::Scalar || isa > GetBestISA())
+        return false;
+
+    Kernel2D kernel = nullptr;
+    switch (isa)
+    {
+        case ISA::SSE41:  kernel = Noise2D_SSE41; break;
+        case ISA::AVX2:   kernel = Noise2D_AVX2; break;
+        case ISA::AVX512: kernel = Noise2D_AVX512; break;
+        default: return false;
+    }
+
+    RunKernel2D(kernel, GetLaneCount(isa), perm, xs, ys, out, n);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Noise3DSplit(ISA isa, const uint32_t* perm,
+                  const int32_t* cellXs, const int32_t* cellYs, const int32_t* cellZs,
+                  const float* xs, const float* ys, const float* zs,
+                  float* out, size_t n)
+{
+#ifdef PERLIN_SIMD_X86
+    if (isa == ISA::Scalar || isa > GetBestISA())
+        return false;
+
+    Kernel3DSplit kernel = nullptr;
+    switch (isa)
+    {
+        case ISA::SSE41:  kernel = Noise3DSplit_SSE41; break;
+        case ISA::AVX2:   kernel = Noise3DSplit_AVX2; break;
+        case ISA::AVX512: kernel = Noise3DSplit_AVX512; break;
+        default: return false;
+    }
+
+    RunKernel3DSplit(kernel, GetLaneCount(isa), perm,
+                     cellXs, cellYs, cellZs, xs, ys, zs, out, n);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Noise2DSplit(ISA isa, const uint32_t* perm,
+                  const int32_t* cellXs, const int32_t* cellYs,
+                  const float* xs, const float* ys,
+                  float* out, size_t n)
+{
+#ifdef PERLIN_SIMD_X86
+    if (isa == ISA::Scalar || isa > GetBestISA())
+        return false;
+
+    Kernel2DSplit kernel = nullptr;
+    switch (isa)
+    {
+        case ISA::SSE41:  kernel = Noise2DSplit_SSE41; break;
+        case ISA::AVX2:   kernel = Noise2DSplit_AVX2; break;
+        case ISA::AVX512: kernel = Noise2DSplit_AVX512; break;
+        default: return false;
+    }
+
+    RunKernel2DSplit(kernel, GetLaneCount(isa), perm,
+                     cellXs, cellYs, xs, ys, out, n);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Noise2DChannels(ISA isa, const uint32_t* perm,
+                     const int32_t* offsets, uint32_t channelCount,
+                     const float* xs, const float* ys,
+                     float* out, size_t n)
+{
+#ifdef PERLIN_SIMD_X86
+    if (isa == ISA::Scalar || isa > GetBestISA() || channelCount > MAX_CHANNELS)
+        return false;
+
+    Kernel2DChannels kernel = nullptr;
+    switch (isa)
+    {
+        case ISA::SSE41:  kernel = Noise2DChannels_SSE41; break;
+        case ISA::AVX2:   kernel = Noise2DChannels_AVX2; break;
+        case ISA::AVX512: kernel = Noise2DChannels_AVX512; break;
+        default: return false;
+    }
+
+    RunKernel2DChannels(kernel, GetLaneCount(isa), perm,
+                        offsets, channelCount, xs, ys, out, n);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Noise2DPeriodic(ISA isa, const uint32_t* perm,
+                     float periodX, float periodY,
+                     const float* xs, const float* ys,
+                     float* out, size_t n)
+{
+#ifdef PERLIN_SIMD_X86
+    if (isa == ISA::Scalar || isa > GetBestISA())
+        return false;
+
+    Kernel2DPeriodic kernel = nullptr;
+    switch (isa)
+    {
+        case ISA::SSE41:  kernel = Noise2DPeriodic_SSE41; break;
+        case ISA::AVX2:   kernel = Noise2DPeriodic_AVX2; break;
+        case ISA::AVX512: kernel = Noise2DPeriodic_AVX512; break;
+        default: return false;
+    }
+
+    RunKernel2DPeriodic(kernel, GetLaneCount(isa), perm,
+                        periodX, periodY, xs, ys, out, n);
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+bool SplitCoords(ISA isa, const double* coords, int32_t* cells, float* fracs,
+                 size_t n)
+{
+#ifdef PERLIN_SIMD_X86
+    if (isa == ISA::Scalar || isa > GetBestISA())
+        return false;
+
+    size_t lanes = 0;
+    switch (isa)
+    {
+        case ISA::SSE41:  lanes = 2; break;
+        case ISA::AVX2:   lanes = 4; break;
+        case ISA::AVX512: lanes = 8; break;
+        default: return false;
+    }
+
+    const size_t kBlocked = n - n % lanes;
+    if (kBlocked > 0)
+    {
+        switch (isa)
+        {
+            case ISA::SSE41:  SplitCoords_SSE41(coords, cells, fracs, kBlocked); break;
+            case ISA::AVX2:   SplitCoords_AVX2(coords, cells, fracs, kBlocked); break;
+            default:          SplitCoords_AVX512(coords, cells, fracs, kBlocked); break;
+        }
+    }
+
+    for (size_t i = kBlocked; i < n; ++i)
+    {
+        const double kWrapped = coords[i] - 256.0 * std::floor(coords[i] * (1.0 / 256.0));
+        const double kFloor = std::floor(kWrapped);
+        cells[i] = static_cast<int32_t>(kFloor) & 255;
+        fracs[i] = static_cast<float>(kWrapped - kFloor);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace PerlinSIMD
@@ -0,0 +1,112 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+
+/**
+ * @brief Vectorized batch kernels of the improved Perlin noise, 2D and 3D.
+ *  The kernels evaluate 4 (SSE4.1), 8 (AVX2) or 16 (AVX-512) samples at once,
+ *  the best instruction set available is chosen at runtime. Each kernel
+ *  performs the same operations in the same order as PerlinNoise<float>::Noise,
+ *  so the results are bit-identical to the scalar path, as long as the scalar
+ *  path is not contracted into FMA instructions by the compiler, in which case
+ *  they differ by at most PERLIN_SIMD_MAX_ERROR.
+ */
+namespace PerlinSIMD
+{
+    /**
+     * @brief Absolute error bound against the scalar PerlinNoise<float>,
+     *  i.e. 32 ULP of 1.0, FMA contraction of the scalar path stays below 20
+     */
+    constexpr float PERLIN_SIMD_MAX_ERROR = 32.0f / (1 << 23);
+
+    enum class ISA
+    {
+        Scalar = 0,
+        SSE41,
+        AVX2,
+        AVX512
+    };
+
+    /** @return The widest instruction set supported by the CPU, detected once */
+    ISA GetBestISA();
+
+    const char* GetISAName(ISA isa);
+
+    /** @return Number of samples evaluated at once by the instruction set */
+    uint32_t GetLaneCount(ISA isa);
+
+    /**
+     * @brief Evaluates 3D Perlin noise for n samples
+     * @param perm Permutation table of 512 entries, see PerlinNoise
+     * @return False if the instruction set is not available, nothing is written
+     */
+    bool Noise3D(ISA isa,
+                 const uint32_t* perm,
+                 const float* xs, const float* ys, const float* zs,
+                 float* out, size_t n);
+
+    /** @brief Evaluates 2D Perlin noise for n samples, @see Noise3D */
+    bool Noise2D(ISA isa,
+                 const uint32_t* perm,
+                 const float* xs, const float* ys,
+                 float* out, size_t n);
+
+    /**
+     * @brief Evaluates 3D Perlin noise for n samples given as lattice cells,
+     *  wrapped to [0,255] by the caller, and in-cell fractions in [0,1]
+     */
+    bool Noise3DSplit(ISA isa,
+                      const uint32_t* perm,
+                      const int32_t* cellXs, const int32_t* cellYs, const int32_t* cellZs,
+                      const float* xs, const float* ys, const float* zs,
+                      float* out, size_t n);
+
+    /** @brief 2D variant of Noise3DSplit */
+    bool Noise2DSplit(ISA isa,
+                      const uint32_t* perm,
+                      const int32_t* cellXs, const int32_t* cellYs,
+                      const float* xs, const float* ys,
+                      float* out, size_t n);
+
+    /**
+     * @brief Evaluates 2D Perlin noise of the lattice wrapping every
+     *  periodX x periodY cells for n samples, see PerlinNoise::NoisePeriodic
+     */
+    bool Noise2DPeriodic(ISA isa,
+                         const uint32_t* perm,
+                         float periodX, float periodY,
+                         const float* xs, const float* ys,
+                         float* out, size_t n);
+
+    /** @brief Maximum channel count of Noise2DChannels */
+    constexpr uint32_t MAX_CHANNELS = 8;
+
+    /**
+     * @brief Evaluates channelCount decorrelated 2D Perlin noises for n
+     *  samples. Channel c is the noise with its lattice cells offset by
+     *  offsets[c] along x, i.e. the permutation lookups start at an offset,
+     *  the floors, fractions and fades are shared between the channels.
+     * @param[out] out Planar, channel c at out + c*n
+     */
+    bool Noise2DChannels(ISA isa,
+                         const uint32_t* perm,
+                         const int32_t* offsets, uint32_t channelCount,
+                         const float* xs, const float* ys,
+                         float* out, size_t n);
+
+    /**
+     * @brief Splits n lattice coordinates into cells, wrapped to [0,255], and
+     *  in-cell fractions, the input of Noise3DSplit and Noise2DSplit
+     * @return False if the instruction set is not available, nothing is written
+     */
+    bool SplitCoords(ISA isa, const double* coords, int32_t* cells, float* fracs,
+                     size_t n);
+
+} // namespace PerlinSIMD
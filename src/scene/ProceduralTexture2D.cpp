@@ -8,10 +8,76 @@
 #include <memory>
 #include <vector>
 #include <limits>
+#include <numeric>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
 
 #define SGL_PROFILE
 #include <SGL/SGL.h>
 
+#include "JobSystem.h"
+#include "ScratchBuffer.h"
+
+
+/** @brief Maps a noise value in [-1,1] to 16-bit fixed point */
+static uint16_t QuantizeNoise(float value)
+{
+    return static_cast<uint16_t>(glm::clamp(value, -1.0f, 1.0f) * 32767.5f + 32768.0f);
+}
+
+static float DequantizeNoise(uint16_t value)
+{
+    return static_cast<float>(value) * (2.0f / 65535.0f) - 1.0f;
+}
+
+/**
+ * @brief Lattice offsets of the height and the extra channels along x, far
+ *  apart within the period of 256 cells, so the channels are uncorrelated
+ */
+static const int32_t s_kChannelOffsets[] = { 0, 97, 163, 211 };
+
+/** @brief Samples per task of the job system, about 64 KiB of values */
+static constexpr uint32_t s_kSamplesPerTask = 16384;
+
+/** @return Rows per task of the job system */
+static uint32_t GetRowGrain(uint32_t width)
+{
+    return glm::max(s_kSamplesPerTask / glm::max(width, 1U), 1U);
+}
+
+/** @brief Last version given to generated values, see GetValueVersion */
+static std::atomic<uint64_t> s_ValueVersion{ 0 };
+
+/**
+ * @brief Shift of the samples between two offsets, exact if both are whole
+ *  numbers and the sample positions stay below 2^24, where the positions
+ *  x + offset are the same floats whichever way they are summed
+ * @return False if the samples are not moved by whole samples or none of
+ *  them is kept
+ */
+static bool GetSampleShift(const glm::vec3& from, const glm::vec3& to,
+                           const glm::uvec2& size, glm::ivec2& shift)
+{
+    static constexpr float s_kExactLimit = 16777216.0f;
+
+    if (from.z != to.z)
+        return false;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        if (glm::floor(from[i]) != from[i] || glm::floor(to[i]) != to[i] ||
+            glm::max(glm::abs(from[i]), glm::abs(to[i])) + size[i] >= s_kExactLimit)
+            return false;
+
+        shift[i] = static_cast<int32_t>(to[i] - from[i]);
+        if (static_cast<uint32_t>(glm::abs(shift[i])) >= size[i])
+            return false;
+    }
+    return true;
+}
+
+// =============================================================================
 
 std::shared_ptr<ProceduralTexture2D> ProceduralTexture2D::Create(
     uint32_t width, uint32_t height)
@@ -24,9 +90,9 @@ std::shared_ptr<ProceduralTexture2D> ProceduralTexture2D::Create(
 ProceduralTexture2D::ProceduralTexture2D(uint32_t width, uint32_t height)
     : m_Width(width),
       m_Height(height),
-      m_FractalNoise(PerlinNoise<NoiseValue>()),
-      m_Texture(sgl::Texture2D::Create())
+      m_FractalNoise(PerlinNoise<NoiseValue>())
 {
+    SetOctavePrecision(OctavePrecision::Bits16);
     //GenerateValues();
     //UpdateTexture();
 }
@@ -35,28 +101,1044 @@ void ProceduralTexture2D::GenerateValues()
 {
     SGL_PROFILE_SCOPE();
 
+    if (m_Backend == Backend::Compute && CanUseCompute())
+    {
+        m_Values.resize(m_Width * m_Height);
+        GenerateValuesCompute();
+
+        // The values stay on the GPU, they are never moved
+        m_ValueKey = GenerationKey();
+        m_ShiftedVersion = 0;
+        m_PreviewStride = 0;
+        m_ValueVersion = ++s_ValueVersion;
+        return;
+    }
+
+    GenerateValuesInBackground();
+}
+
+void ProceduralTexture2D::GenerateValuesInBackground()
+{
+    m_ComputeGenerated = false;
+    m_PendingReadBack = false;
+
+    const GenerationKey kKey = GetGenerationKey();
+    glm::ivec2 shift;
+    const bool kShift = CanShiftValues(kKey, shift);
+
+    // The tiles keep the samples of a preview of the same settings
+    if (!(m_PreviewKey == kKey))
+        m_PreviewStride = 0;
+
+    if (kShift)
+    {
+        const std::vector<MapRegion> kRegions = ShiftValues(shift);
+        GenerateValuesCPU(kRegions);
+    }
+    else
+    {
+        m_Values.resize(m_Width * m_Height);
+        GenerateValuesCPU();
+    }
+
+    // Incomplete values cannot be moved by the next generation
+    m_ValueKey = kKey;
+    m_ValueKey.valid = !IsCancelled() && !m_Periodic && !m_UseNoiseGraph;
+    m_ShiftedVersion = kShift ? m_ValueVersion : 0;
+    m_ValueShift = kShift ? shift : glm::ivec2(0);
+    m_ValueVersion = ++s_ValueVersion;
+    m_PreviewStride = 0;
+}
+
+void ProceduralTexture2D::GeneratePreview(uint32_t stride)
+{
+    m_ComputeGenerated = false;
+    m_PendingReadBack = false;
+    m_Values.resize(static_cast<size_t>(m_Width) * m_Height);
+
+    // The grid of a coarser preview is part of this one
+    const GenerationKey kKey = GetGenerationKey();
+    const uint32_t kKept = m_PreviewKey == kKey && m_PreviewStride > stride &&
+                           m_PreviewStride % stride == 0 ? m_PreviewStride : 0;
+
+    // Incomplete values cannot be moved by the next generation
+    m_ValueKey = GenerationKey();
+    m_ShiftedVersion = 0;
+    m_PreviewStride = 0;
+
+    const glm::uvec2 kGrid = GetPreviewSize(GetSize(), stride);
+    m_PreviewValues.resize(static_cast<size_t>(kGrid.x) * kGrid.y);
+
+    std::vector<ValueRange> ranges(kGrid.y);
+    JobSystem::Get().ParallelFor("Noise preview rows", kGrid.y, GetRowGrain(kGrid.x),
+                                 [&](uint32_t begin, uint32_t end) {
+        std::vector<NoiseValue> xs, samples;
+        for (uint32_t row = begin; row < end && !IsCancelled(); ++row)
+        {
+            const uint32_t kY = row * stride;
+            const bool kKeptRow = kKept > 0 && kY % kKept == 0;
+
+            xs.clear();
+            for (uint32_t x = 0; x < m_Width; x += stride)
+                if (!kKeptRow || x % kKept != 0)
+                    xs.push_back(static_cast<NoiseValue>(x));
+            samples.resize(xs.size());
+            EvaluateSamples(xs.data(), xs.size(), kY, samples.data());
+
+            NoiseValue* values = &m_Values[static_cast<size_t>(kY) * m_Width];
+            NoiseValue* preview = &m_PreviewValues[static_cast<size_t>(row) * kGrid.x];
+            ValueRange& range = ranges[row];
+            for (uint32_t i = 0, sample = 0; i < kGrid.x; ++i)
+            {
+                const uint32_t kX = i * stride;
+                if (!kKeptRow || kX % kKept != 0)
+                    values[kX] = samples[sample++];
+
+                preview[i] = values[kX];
+                range.min = glm::min(range.min, preview[i]);
+                range.max = glm::max(range.max, preview[i]);
+            }
+        }
+    });
+
+    m_MinValue = std::numeric_limits<float>::max();
+    m_MaxValue = std::numeric_limits<float>::lowest();
+    MergeValueRanges(ranges);
+
+    if (!IsCancelled())
+    {
+        m_PreviewKey = kKey;
+        m_PreviewStride = stride;
+    }
+    m_ValueVersion = ++s_ValueVersion;
+}
+
+bool ProceduralTexture2D::CanGeneratePreview(uint32_t stride) const
+{
+    if (m_UseNoiseGraph || m_Periodic || m_Width <= stride || m_Height <= stride)
+        return false;
+
+    glm::ivec2 shift;
+    if (CanShiftValues(GetGenerationKey(), shift))
+        return false;
+
+    // Re-weighting the cached layers only sums them
+    return m_LayerCacheMode == LayerCacheMode::Off ||
+           m_EvaluationMode != EvaluationMode::Batch ||
+           m_GenerateGradients || m_GenerateChannels ||
+           !IsLayerCacheComplete();
+}
+
+void ProceduralTexture2D::CopySettings(const ProceduralTexture2D& other)
+{
+    m_FractalNoise = other.m_FractalNoise;
+    m_NoiseDimension = other.m_NoiseDimension;
+    m_GenerateGradients = other.m_GenerateGradients;
+    m_EvaluationMode = other.m_EvaluationMode;
+    m_TileSize = other.m_TileSize;
+    m_OctavePrecision = other.m_OctavePrecision;
+
+    m_GenerateChannels = other.m_GenerateChannels;
+    m_ChannelOctaves = other.m_ChannelOctaves;
+
+    m_Periodic = other.m_Periodic;
+    m_TilePeriod = other.m_TilePeriod;
+
+    m_UseNoiseGraph = other.m_UseNoiseGraph;
+    m_NoiseGraph = other.m_NoiseGraph;
+
+    SetLayerCacheMode(other.m_LayerCacheMode);
+    m_LayerCacheBudget = other.m_LayerCacheBudget;
+}
+
+void ProceduralTexture2D::CopyValues(const ProceduralTexture2D& other)
+{
+    m_Width = other.m_Width;
+    m_Height = other.m_Height;
+    m_Values = other.m_Values;
+    m_Gradients = other.m_Gradients;
+    m_ChannelValues = other.m_ChannelValues;
+    m_MinValue = other.m_MinValue;
+    m_MaxValue = other.m_MaxValue;
+
+    m_ValueKey = other.m_ValueKey;
+    m_ValueVersion = other.m_ValueVersion;
+    m_ShiftedVersion = other.m_ShiftedVersion;
+    m_ValueShift = other.m_ValueShift;
+    m_PreviewKey = other.m_PreviewKey;
+    m_PreviewStride = other.m_PreviewStride;
+}
+
+void ProceduralTexture2D::SwapValues(ProceduralTexture2D& other)
+{
+    std::swap(m_Width, other.m_Width);
+    std::swap(m_Height, other.m_Height);
+    m_Values.swap(other.m_Values);
+    m_Gradients.swap(other.m_Gradients);
+    m_ChannelValues.swap(other.m_ChannelValues);
+    std::swap(m_MinValue, other.m_MinValue);
+    std::swap(m_MaxValue, other.m_MaxValue);
+
+    std::swap(m_ValueKey, other.m_ValueKey);
+    std::swap(m_ValueVersion, other.m_ValueVersion);
+    std::swap(m_ShiftedVersion, other.m_ShiftedVersion);
+    std::swap(m_ValueShift, other.m_ValueShift);
+    std::swap(m_PreviewKey, other.m_PreviewKey);
+    std::swap(m_PreviewStride, other.m_PreviewStride);
+
+    std::swap(m_OctaveStats, other.m_OctaveStats);
+    std::swap(m_NoiseProgram, other.m_NoiseProgram);
+    m_NoiseGraphError.swap(other.m_NoiseGraphError);
+
+    std::swap(m_ComputeGenerated, other.m_ComputeGenerated);
+    std::swap(m_PendingReadBack, other.m_PendingReadBack);
+}
+
+bool ProceduralTexture2D::GetValueShift(uint64_t version, glm::ivec2& shift) const
+{
+    if (version == m_ValueVersion)
+    {
+        shift = glm::ivec2(0);
+        return true;
+    }
+    if (version == 0 || version != m_ShiftedVersion)
+        return false;
+
+    shift = m_ValueShift;
+    return true;
+}
+
+bool ProceduralTexture2D::CanShiftValues(const GenerationKey& key, glm::ivec2& shift) const
+{
+    if (!m_ValueKey.valid || m_Periodic || m_UseNoiseGraph)
+        return false;
+
+    // Nothing but the offset changed
+    GenerationKey moved = key;
+    moved.noise.offset = m_ValueKey.noise.offset;
+    if (!(moved == m_ValueKey) ||
+        !GetSampleShift(m_ValueKey.noise.offset, key.noise.offset, GetSize(), shift))
+        return false;
+
+    // The row modes step from the first sample of the row, a moved row
+    //  would not be the row evaluated at its new position
+    return shift.x == 0 || (m_EvaluationMode != EvaluationMode::Row &&
+                            m_EvaluationMode != EvaluationMode::Split);
+}
+
+std::vector<MapRegion> ProceduralTexture2D::ShiftValues(const glm::ivec2& shift)
+{
+    const glm::uvec2 kSize = GetSize();
+    ShiftMap(m_Values, kSize, 1, shift);
+    if (!m_Gradients.empty())
+        ShiftMap(m_Gradients, kSize, 1, shift);
+    if (!m_ChannelValues.empty())
+        ShiftMap(m_ChannelValues, kSize, CHANNEL_COUNT, shift);
+
+    // Range of the moved values, the evaluated ones are merged into it
+    const MapRegion kKept = GetKeptRegion(kSize, shift);
+    std::vector<ValueRange> ranges(kKept.end.y - kKept.begin.y);
+    JobSystem::Get().ParallelFor("Noise shift range", kKept.end.y - kKept.begin.y,
+                                 GetRowGrain(m_Width), [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const NoiseValue* kRow = &m_Values[(kKept.begin.y + i) * m_Width];
+            for (uint32_t x = kKept.begin.x; x < kKept.end.x; ++x)
+            {
+                ranges[i].min = glm::min(ranges[i].min, kRow[x]);
+                ranges[i].max = glm::max(ranges[i].max, kRow[x]);
+            }
+        }
+    });
+
+    m_MinValue = std::numeric_limits<float>::max();
+    m_MaxValue = std::numeric_limits<float>::lowest();
+    MergeValueRanges(ranges);
+
+    return GetExposedRegions(kSize, shift);
+}
+
+void ProceduralTexture2D::GenerateValuesCPU()
+{
+    m_MinValue = std::numeric_limits<float>::max();
+    m_MaxValue = std::numeric_limits<float>::lowest();
+
+    GenerateValuesCPU({ GetMapRegion() });
+}
+
+void ProceduralTexture2D::GenerateValuesCPU(const std::vector<MapRegion>& regions)
+{
+    UpdateOctaveStats();
+
+    if (m_GenerateChannels)
+    {
+        // The height joins the traversal of the channels when it would be
+        // evaluated by the same batches anyway
+        const bool kWithHeight = !m_UseNoiseGraph && !m_Periodic && !m_GenerateGradients &&
+                                 m_EvaluationMode == EvaluationMode::Batch &&
+                                 m_NoiseDimension == NoiseDimension::Noise2D;
+        GenerateChannels(kWithHeight, regions);
+        if (kWithHeight)
+        {
+            m_Gradients.clear();
+            return;
+        }
+    }
+    else
+        m_ChannelValues.clear();
+
+    // The sources follow the current octave culling settings. The graph and
+    //  the periodic noise are never moved, the regions are the whole map.
+    if (m_UseNoiseGraph &&
+        m_NoiseGraph.Compile(m_NoiseProgram, m_FractalNoise.precision,
+                             m_FractalNoise.targetSpacing, m_NoiseGraphError))
+    {
+        m_Gradients.clear();
+        m_NoiseProgram.Evaluate(m_Width, m_Height, m_Values.data(),
+                                m_MinValue, m_MaxValue);
+        return;
+    }
+
+    if (m_Periodic)
+    {
+        m_Gradients.clear();
+        GenerateValuesPeriodic();
+        return;
+    }
+
+    if (m_GenerateGradients)
+    {
+        GenerateValuesWithGradients(regions);
+        return;
+    }
+    m_Gradients.clear();
+
+    // Float layers sum to the same values as the tiles, which keep the
+    //  samples of the preview, while all layers are to be sampled anyway
+    const bool kKeepPreview = m_PreviewStride > 0 &&
+                              m_LayerCacheMode == LayerCacheMode::Float &&
+                              !IsLayerCacheComplete();
+    if (m_LayerCacheMode != LayerCacheMode::Off &&
+        m_EvaluationMode == EvaluationMode::Batch && !kKeepPreview &&
+        GenerateValuesFromLayers(regions))
+        return;
+
+    // Samples of a tile row are evaluated in a batch, the tiles across the
+    //  workers
+    GenerateTiles("Noise tiles", GetEvaluationTileSize(), regions,
+                  [this](const glm::uvec2& begin, const glm::uvec2& end) {
+        GenerateTile(begin, end);
+    });
+}
+
+void ProceduralTexture2D::GenerateTile(const glm::uvec2& begin, const glm::uvec2& end)
+{
+    const uint32_t kWidth = end.x - begin.x;
+    NoiseValue* xs = Scratch<0>(kWidth);
+    NoiseValue* ys = Scratch<1>(kWidth);
+    NoiseValue* zs = Scratch<2>(kWidth);
+    std::iota(xs, xs + kWidth, static_cast<NoiseValue>(begin.x));
+    std::fill_n(zs, kWidth, static_cast<NoiseValue>(0));
+
+    // The preview evaluates its samples the same way in these modes
+    const uint32_t kKept = m_EvaluationMode == EvaluationMode::PerSample ||
+                           m_EvaluationMode == EvaluationMode::Batch ? m_PreviewStride : 0;
+    NoiseValue* missing = Scratch<3>(kKept > 0 ? kWidth : 0);
+    NoiseValue* samples = Scratch<4>(kKept > 0 ? kWidth : 0);
+
+    for (uint32_t y = begin.y; y < end.y; ++y)
+    {
+        NoiseValue* row = &m_Values[y*m_Width + begin.x];
+
+        if (kKept > 0 && y % kKept == 0)
+        {
+            size_t missingCount = 0;
+            for (uint32_t x = begin.x; x < end.x; ++x)
+                if (x % kKept != 0)
+                    missing[missingCount++] = static_cast<NoiseValue>(x);
+            EvaluateSamples(missing, missingCount, y, samples);
+
+            for (uint32_t x = begin.x, sample = 0; x < end.x; ++x)
+                if (x % kKept != 0)
+                    row[x - begin.x] = samples[sample++];
+            continue;
+        }
+
+        const bool k2D = m_NoiseDimension == NoiseDimension::Noise2D;
+        const NoiseValue kY = static_cast<NoiseValue>(y);
+
+        switch (m_EvaluationMode)
+        {
+        case EvaluationMode::PerSample:
+            for (uint32_t x = 0; x < kWidth; ++x)
+                row[x] = k2D ? m_FractalNoise.Noise(xs[x], kY)
+                             : m_FractalNoise.Noise(xs[x], kY, 0);
+            break;
+        case EvaluationMode::Batch:
+            std::fill_n(ys, kWidth, kY);
+            if (k2D)
+                m_FractalNoise.NoiseN(xs, ys, row, kWidth);
+            else
+                m_FractalNoise.NoiseN(xs, ys, zs, row, kWidth);
+            break;
+        case EvaluationMode::Row:
+            if (k2D)
+                m_FractalNoise.NoiseRow(kY, xs[0], 1, kWidth, row);
+            else
+                m_FractalNoise.NoiseRow(kY, 0, xs[0], 1, kWidth, row);
+            break;
+        case EvaluationMode::Split:
+            if (k2D)
+                m_FractalNoise.NoiseRowSplit(y, begin.x, 1, kWidth, row);
+            else
+                m_FractalNoise.NoiseRowSplit(y, 0, begin.x, 1, kWidth, row);
+            break;
+        }
+    }
+}
+
+void ProceduralTexture2D::EvaluateSamples(const NoiseValue* xs, size_t count, uint32_t y,
+                                          NoiseValue* out) const
+{
+    const size_t kCount = count;
+    const bool k2D = m_NoiseDimension == NoiseDimension::Noise2D;
+    const NoiseValue kY = static_cast<NoiseValue>(y);
+
+    if (m_EvaluationMode == EvaluationMode::PerSample)
+    {
+        for (size_t i = 0; i < kCount; ++i)
+            out[i] = k2D ? m_FractalNoise.Noise(xs[i], kY)
+                         : m_FractalNoise.Noise(xs[i], kY, 0);
+        return;
+    }
+
+    NoiseValue* ys = Scratch<5>(kCount);
+    NoiseValue* zs = Scratch<6>(kCount);
+    std::fill_n(ys, kCount, kY);
+    std::fill_n(zs, kCount, static_cast<NoiseValue>(0));
+    if (k2D)
+        m_FractalNoise.NoiseN(xs, ys, out, kCount);
+    else
+        m_FractalNoise.NoiseN(xs, ys, zs, out, kCount);
+}
+
+glm::uvec2 ProceduralTexture2D::GetEvaluationTileSize() const
+{
+    // The row modes step from the first sample of the row, tiles narrower
+    //  than the map would round the positions differently
+    const bool kFullRows = m_EvaluationMode == EvaluationMode::Row ||
+                           m_EvaluationMode == EvaluationMode::Split;
+    return glm::uvec2(kFullRows || m_TileSize.x == 0 ? m_Width : m_TileSize.x,
+                      m_TileSize.y == 0 ? GetRowGrain(m_Width) : m_TileSize.y);
+}
+
+void ProceduralTexture2D::GenerateTiles(const char* name, const glm::uvec2& tileSize,
+                                        const std::vector<MapRegion>& regions,
+                                        const TileFunction& generate)
+{
+    const std::vector<MapRegion> kTiles = SplitTiles(regions, tileSize);
+
+    // Each tile takes its range while the values are still in the cache,
+    //  min and max are exact, the result does not depend on the tiling
+    std::vector<ValueRange> ranges(kTiles.size());
+    JobSystem::Get().ParallelFor(name, static_cast<uint32_t>(kTiles.size()), 1,
+                                 [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end && !IsCancelled(); ++i)
+        {
+            const MapRegion& kTile = kTiles[i];
+            generate(kTile.begin, kTile.end);
+
+            ValueRange& range = ranges[i];
+            for (uint32_t y = kTile.begin.y; y < kTile.end.y; ++y)
+            {
+                const NoiseValue* kRow = &m_Values[y*m_Width];
+                for (uint32_t x = kTile.begin.x; x < kTile.end.x; ++x)
+                {
+                    range.min = glm::min(range.min, kRow[x]);
+                    range.max = glm::max(range.max, kRow[x]);
+                }
+            }
+        }
+    });
+    MergeValueRanges(ranges);
+}
+
+void ProceduralTexture2D::MergeValueRanges(const std::vector<ValueRange>& ranges)
+{
+    for (const ValueRange& kRange : ranges)
+    {
+        m_MinValue = glm::min(m_MinValue, kRange.min);
+        m_MaxValue = glm::max(m_MaxValue, kRange.max);
+    }
+}
+
+uint64_t ProceduralTexture2D::GetValueHash() const
+{
+    // FNV-1a over the bits of the values
+    uint64_t hash = 14695981039346656037ULL;
+    for (const NoiseValue kValue : m_Values)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &kValue, sizeof(bits));
+        for (uint32_t i = 0; i < sizeof(bits); ++i)
+        {
+            hash ^= (bits >> (i * 8)) & 0xFF;
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+double ProceduralTexture2D::TimeGeneration(uint32_t runs)
+{
+    m_ComputeGenerated = false;
+    m_PendingReadBack = false;
+    m_PreviewStride = 0;
     m_Values.resize(m_Width * m_Height);
 
+    double fastest = std::numeric_limits<double>::max();
+    for (uint32_t i = 0; i < runs; ++i)
+    {
+        const auto kStart = std::chrono::steady_clock::now();
+        GenerateValuesCPU();
+        const std::chrono::duration<double, std::milli> kDuration =
+            std::chrono::steady_clock::now() - kStart;
+        fastest = std::min(fastest, kDuration.count());
+    }
+
+    // Not a move of the previous values
+    m_ValueKey = GenerationKey();
+    m_ShiftedVersion = 0;
+    m_ValueVersion = ++s_ValueVersion;
+    return fastest;
+}
+
+void ProceduralTexture2D::UpdateValueRange()
+{
+    SGL_PROFILE_SCOPE();
+
     m_MinValue = std::numeric_limits<float>::max();
-    m_MaxValue = std::numeric_limits<float>::min();
+    m_MaxValue = std::numeric_limits<float>::lowest();
+    for (const NoiseValue kValue : m_Values)
+    {
+        m_MinValue = glm::min(m_MinValue, kValue);
+        m_MaxValue = glm::max(m_MaxValue, kValue);
+    }
+}
 
-    for (uint32_t y = 0; y < m_Height; ++y)
-        for (uint32_t x = 0; x < m_Width; ++x)
+bool ProceduralTexture2D::InitComputeBackend(const std::string& source,
+                                             std::string& error)
+{
+    return m_ComputeBackend.Init(source, error);
+}
+
+bool ProceduralTexture2D::CanUseCompute()
+{
+    if (!m_ComputeBackend.IsReady())
+        m_ComputeFallbackReason = "The compute shader is not initialized";
+    else if (m_NoiseDimension != NoiseDimension::Noise2D)
+        m_ComputeFallbackReason = "The compute shader is 2D only";
+    else if (m_GenerateGradients || m_GenerateChannels)
+        m_ComputeFallbackReason = "The gradients and the channels are generated on the CPU";
+    else if (m_UseNoiseGraph || m_Periodic)
+        m_ComputeFallbackReason = "The noise graph and the periodic noise run on the CPU";
+    else
+        return NoiseComputeBackend::Supports(m_FractalNoise, m_ComputeFallbackReason);
+
+    return false;
+}
+
+void ProceduralTexture2D::GenerateValuesCompute()
+{
+    SGL_PROFILE_SCOPE();
+
+    UpdateOctaveStats();
+    m_Gradients.clear();
+    m_ChannelValues.clear();
+
+    // The shader writes the texture, it needs storage of a format images
+    //  support, RGB8 is not one of them
+    if (m_ComputeTextureSize != GetSize())
+    {
+        GetTexture()->SetData({
+            static_cast<int>(m_Width),
+            static_cast<int>(m_Height),
+            nullptr,
+            GL_RGBA8,
+            GL_RGBA,
+            GL_FLOAT,
+            false
+        });
+        m_ComputeTextureSize = GetSize();
+    }
+
+    m_ComputeBackend.Dispatch(m_FractalNoise, m_Width, m_Height, GetTexture()->GetID());
+
+    m_ComputeGenerated = true;
+    m_PendingReadBack = true;
+}
+
+void ProceduralTexture2D::ReadBackValues()
+{
+    if (!m_PendingReadBack)
+        return;
+
+    SGL_PROFILE_SCOPE();
+
+    m_ComputeBackend.ReadBack(m_Values.data(), m_Values.size());
+    UpdateValueRange();
+
+    m_PendingReadBack = false;
+}
+
+float ProceduralTexture2D::MeasureComputeParity()
+{
+    SGL_PROFILE_SCOPE();
+
+    if (!m_ComputeGenerated)
+        return 0.0f;
+
+    ReadBackValues();
+
+    // The compute values stay the current ones
+    const std::vector<NoiseValue> kComputeValues = m_Values;
+    const float kMinValue = m_MinValue;
+    const float kMaxValue = m_MaxValue;
+
+    GenerateValuesCPU();
+
+    float error = 0.0f;
+    for (size_t i = 0; i < m_Values.size(); ++i)
+        error = glm::max(error, glm::abs(m_Values[i] - kComputeValues[i]));
+
+    m_Values = kComputeValues;
+    m_MinValue = kMinValue;
+    m_MaxValue = kMaxValue;
+    return error;
+}
+
+float ProceduralTexture2D::MeasureSIMDParity() const
+{
+    SGL_PROFILE_SCOPE();
+
+    const PerlinNoise<float> kNoise(GetSeed());
+
+    // Both signs, cell borders and large offsets, over a few lattice periods
+    static constexpr size_t s_kSampleCount = 4099;
+    std::vector<float> xs(s_kSampleCount), ys(s_kSampleCount), zs(s_kSampleCount);
+    for (size_t i = 0; i < s_kSampleCount; ++i)
+    {
+        const float kT = static_cast<float>(i);
+        xs[i] = kT * 0.37f - 700.0f;
+        ys[i] = (i % 7 == 0) ? glm::floor(kT * 0.11f) : kT * -0.213f + 90.5f;
+        zs[i] = kT * 0.059f + (i % 2 == 0 ? 3000.25f : -12.0f);
+    }
+
+    std::vector<float> scalar2D(s_kSampleCount), scalar3D(s_kSampleCount);
+    for (size_t i = 0; i < s_kSampleCount; ++i)
+    {
+        scalar2D[i] = kNoise.Noise(xs[i], ys[i]);
+        scalar3D[i] = kNoise.Noise(xs[i], ys[i], zs[i]);
+    }
+
+    float error = 0.0f;
+    std::vector<float> simd(s_kSampleCount);
+    const int kBest = static_cast<int>(PerlinSIMD::GetBestISA());
+    for (int isa = static_cast<int>(PerlinSIMD::ISA::SSE41); isa <= kBest; ++isa)
+    {
+        const PerlinSIMD::ISA kISA = static_cast<PerlinSIMD::ISA>(isa);
+
+        if (PerlinSIMD::Noise2D(kISA, kNoise.GetPermutations(), xs.data(), ys.data(),
+                                simd.data(), s_kSampleCount))
+            for (size_t i = 0; i < s_kSampleCount; ++i)
+                error = glm::max(error, glm::abs(simd[i] - scalar2D[i]));
+
+        if (PerlinSIMD::Noise3D(kISA, kNoise.GetPermutations(), xs.data(), ys.data(),
+                                zs.data(), simd.data(), s_kSampleCount))
+            for (size_t i = 0; i < s_kSampleCount; ++i)
+                error = glm::max(error, glm::abs(simd[i] - scalar3D[i]));
+    }
+    return error;
+}
+
+void ProceduralTexture2D::GenerateChannels(bool withHeight,
+                                           const std::vector<MapRegion>& regions)
+{
+    m_ChannelValues.resize(static_cast<size_t>(m_Width) * m_Height * CHANNEL_COUNT);
+
+    // Height first, if evaluated, then the channels
+    const uint32_t kFirst = withHeight ? 0 : 1;
+    const uint32_t kCount = CHANNEL_COUNT + 1 - kFirst;
+    std::array<uint32_t, CHANNEL_COUNT + 1> octaves;
+    octaves[0] = m_FractalNoise.octaveCount;
+    for (uint32_t c = 0; c < CHANNEL_COUNT; ++c)
+        octaves[c + 1] = glm::min(m_ChannelOctaves[c], m_FractalNoise.octaveCount);
+
+    const auto kGenerateTile = [&](const glm::uvec2& begin, const glm::uvec2& end) {
+        if (IsCancelled())
+            return;
+
+        const uint32_t kWidth = end.x - begin.x;
+        NoiseValue* xs = Scratch<0>(kWidth);
+        NoiseValue* ys = Scratch<1>(kWidth);
+        NoiseValue* row = Scratch<2>(kWidth * kCount);
+        std::iota(xs, xs + kWidth, static_cast<NoiseValue>(begin.x));
+
+        for (uint32_t y = begin.y; y < end.y; ++y)
+        {
+            std::fill_n(ys, kWidth, static_cast<NoiseValue>(y));
+            m_FractalNoise.NoiseChannelsN(&s_kChannelOffsets[kFirst], &octaves[kFirst], kCount,
+                                          xs, ys, row, kWidth);
+
+            const size_t kIndex = static_cast<size_t>(y) * m_Width + begin.x;
+            const NoiseValue* kChannels = row;
+            if (withHeight)
+            {
+                std::copy_n(kChannels, kWidth, &m_Values[kIndex]);
+                kChannels += kWidth;
+            }
+
+            // Planar rows to the interleaved channel map
+            NoiseValue* interleaved = &m_ChannelValues[kIndex * CHANNEL_COUNT];
+            for (uint32_t c = 0; c < CHANNEL_COUNT; ++c)
+                for (uint32_t x = 0; x < kWidth; ++x)
+                    interleaved[x*CHANNEL_COUNT + c] = kChannels[c*kWidth + x];
+        }
+    };
+
+    if (withHeight)
+    {
+        GenerateTiles("Noise channel tiles", GetEvaluationTileSize(), regions, kGenerateTile);
+        return;
+    }
+
+    const std::vector<MapRegion> kTiles = SplitTiles(regions, GetEvaluationTileSize());
+    JobSystem::Get().ParallelFor("Noise channel tiles", static_cast<uint32_t>(kTiles.size()), 1,
+                                 [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i)
+            kGenerateTile(kTiles[i].begin, kTiles[i].end);
+    });
+}
+
+void ProceduralTexture2D::GenerateValuesPeriodic()
+{
+    const NoiseValue kPeriodX = static_cast<NoiseValue>(
+        m_TilePeriod > 0 ? m_TilePeriod : glm::max(m_Width, 2U) - 1);
+    const NoiseValue kPeriodY = static_cast<NoiseValue>(
+        m_TilePeriod > 0 ? m_TilePeriod : glm::max(m_Height, 2U) - 1);
+
+    GenerateTiles("Periodic noise tiles", GetEvaluationTileSize(), { GetMapRegion() },
+                  [&](const glm::uvec2& begin, const glm::uvec2& end) {
+        const uint32_t kWidth = end.x - begin.x;
+        NoiseValue* xs = Scratch<0>(kWidth);
+        NoiseValue* ys = Scratch<1>(kWidth);
+        std::iota(xs, xs + kWidth, static_cast<NoiseValue>(begin.x));
+
+        for (uint32_t y = begin.y; y < end.y; ++y)
+        {
+            std::fill_n(ys, kWidth, static_cast<NoiseValue>(y));
+            m_FractalNoise.NoisePeriodicN(xs, ys, kPeriodX, kPeriodY,
+                                          &m_Values[y*m_Width + begin.x], kWidth);
+        }
+    });
+}
+
+void ProceduralTexture2D::GenerateValuesWithGradients(const std::vector<MapRegion>& regions)
+{
+    m_Gradients.resize(m_Width * m_Height);
+
+    GenerateTiles("Noise gradient tiles", GetEvaluationTileSize(), regions,
+                  [this](const glm::uvec2& begin, const glm::uvec2& end) {
+        for (uint32_t y = begin.y; y < end.y; ++y)
+            for (uint32_t x = begin.x; x < end.x; ++x)
+            {
+                const uint32_t kIndex = y*m_Width + x;
+
+                glm::vec3 noise;
+                if (m_NoiseDimension == NoiseDimension::Noise2D)
+                    noise = m_FractalNoise.NoiseDeriv(x, y);
+                else
+                    noise = glm::vec3(m_FractalNoise.NoiseDeriv(x, y, 0));
+
+                m_Values[kIndex] = noise.x;
+                m_Gradients[kIndex] = Gradient(noise.y, noise.z);
+            }
+    });
+}
+
+bool ProceduralTexture2D::GenerateValuesFromLayers(const std::vector<MapRegion>& regions)
+{
+    const size_t kSampleCount = static_cast<size_t>(m_Width) * m_Height;
+    const uint32_t kOctaveCount = m_FractalNoise.octaveCount;
+    const uint32_t kBudget = m_FractalNoise.GetOctaveBudget();
+    const bool kQuantized = m_LayerCacheMode == LayerCacheMode::Quantized16;
+
+    const LayerCacheKey kKey = GetLayerCacheKey();
+    glm::ivec2 shift(0);
+    if (!(kKey == m_LayerCacheKey))
+    {
+        // Layers moved by whole samples are moved along, see below
+        LayerCacheKey moved = kKey;
+        moved.offset = m_LayerCacheKey.offset;
+        if (!(moved == m_LayerCacheKey) ||
+            !GetSampleShift(m_LayerCacheKey.offset, kKey.offset, GetSize(), shift))
+        {
+            // The storage is reused while the size stays the same
+            if (kKey.width != m_LayerCacheKey.width || kKey.height != m_LayerCacheKey.height)
+                ClearLayerCache();
+            m_CachedLayerCount = 0;
+            shift = glm::ivec2(0);
+        }
+        m_LayerCacheKey = kKey;
+    }
+
+    const size_t kBytesPerSample = kQuantized ? sizeof(uint16_t) : sizeof(NoiseValue);
+    const size_t kLayerCount = std::max(m_CachedLayerCount, kBudget);
+    if (kSampleCount * kBytesPerSample * kLayerCount > (m_LayerCacheBudget << 20))
+    {
+        ClearLayerCache();
+        return false;
+    }
+
+    if (shift != glm::ivec2(0))
+        ShiftLayers(shift);
+
+    // Only the octaves missing from the cache are sampled, the dropped ones
+    // are never sampled
+    for (uint32_t i = m_CachedLayerCount; i < kBudget; ++i)
+        SampleLayer(i, { GetMapRegion() });
+
+    // Partially sampled layers are not kept, they are sampled again
+    if (IsCancelled())
+        return true;
+    m_CachedLayerCount = static_cast<uint32_t>(kLayerCount);
+
+    // Same weighting and order of operations as FractalNoise::NoiseN
+    std::vector<NoiseValue> weights(kOctaveCount);
+    NoiseValue max = (NoiseValue)0;
+    NoiseValue amplitude = (NoiseValue)1;
+
+    for (uint32_t i = 0; i < kOctaveCount; ++i)
+    {
+        weights[i] = i < kBudget ? amplitude * m_FractalNoise.GetOctaveFade(i)
+                                 : (NoiseValue)0;
+        max += amplitude;
+        amplitude *= m_FractalNoise.gain;
+    }
+
+    // The octaves are summed per row of a tile, the loops are contiguous
+    // and vectorized by the compiler. The range is taken per tile.
+    const std::vector<MapRegion> kTiles =
+        SplitTiles(regions, glm::uvec2(m_Width, GetRowGrain(m_Width)));
+    std::vector<ValueRange> ranges(kTiles.size());
+    JobSystem::Get().ParallelFor("Noise layer sums", static_cast<uint32_t>(kTiles.size()), 1,
+                                 [&](uint32_t begin, uint32_t end) {
+        for (uint32_t tile = begin; tile < end && !IsCancelled(); ++tile)
+        {
+            const MapRegion& kTile = kTiles[tile];
+            ValueRange& range = ranges[tile];
+
+            for (uint32_t y = kTile.begin.y; y < kTile.end.y; ++y)
+            {
+                const size_t kBegin = static_cast<size_t>(y) * m_Width + kTile.begin.x;
+                const size_t kEnd = kBegin + (kTile.end.x - kTile.begin.x);
+                NoiseValue* values = m_Values.data();
+                std::fill(values + kBegin, values + kEnd, (NoiseValue)0);
+
+                for (uint32_t i = 0; i < kOctaveCount; ++i)
+                {
+                    const NoiseValue kWeight = weights[i];
+                    if (kWeight > (NoiseValue)0 && kQuantized)
+                    {
+                        const uint16_t* quantized = m_QuantizedLayers[i].data();
+                        for (size_t s = kBegin; s < kEnd; ++s)
+                            values[s] += DequantizeNoise(quantized[s]) * kWeight;
+                    }
+                    else if (kWeight > (NoiseValue)0)
+                    {
+                        const NoiseValue* cached = m_Layers[i].data();
+                        for (size_t s = kBegin; s < kEnd; ++s)
+                            values[s] += cached[s] * kWeight;
+                    }
+                }
+
+                for (size_t s = kBegin; s < kEnd; ++s)
+                {
+                    values[s] = (values[s] / max + (NoiseValue)1.0) / (NoiseValue)2.0;
+                    range.min = glm::min(range.min, values[s]);
+                    range.max = glm::max(range.max, values[s]);
+                }
+            }
+        }
+    });
+    MergeValueRanges(ranges);
+
+    return true;
+}
+
+void ProceduralTexture2D::SampleLayer(uint32_t octave, const std::vector<MapRegion>& regions)
+{
+    const size_t kSampleCount = static_cast<size_t>(m_Width) * m_Height;
+    const bool kQuantized = m_LayerCacheMode == LayerCacheMode::Quantized16;
+    if (kQuantized && octave == m_QuantizedLayers.size())
+        m_QuantizedLayers.emplace_back(kSampleCount);
+    else if (!kQuantized && octave == m_Layers.size())
+        m_Layers.emplace_back(kSampleCount);
+
+    const std::vector<MapRegion> kTiles =
+        SplitTiles(regions, glm::uvec2(m_Width, GetRowGrain(m_Width)));
+    JobSystem::Get().ParallelFor("Noise layer rows", static_cast<uint32_t>(kTiles.size()), 1,
+                                 [&](uint32_t begin, uint32_t end) {
+        for (uint32_t tile = begin; tile < end && !IsCancelled(); ++tile)
         {
-            const uint32_t kIndex = y*m_Width + x;
-            const float kValue = m_FractalNoise.Noise(x, y, 0);
+            const MapRegion& kTile = kTiles[tile];
+            const uint32_t kWidth = kTile.end.x - kTile.begin.x;
+
+            NoiseValue* xs = Scratch<0>(kWidth);
+            NoiseValue* ys = Scratch<1>(kWidth);
+            NoiseValue* zs = Scratch<2>(kWidth);
+            NoiseValue* row = Scratch<3>(kWidth);
+            std::iota(xs, xs + kWidth, static_cast<NoiseValue>(kTile.begin.x));
+            std::fill_n(zs, kWidth, static_cast<NoiseValue>(0));
 
-            m_Values[kIndex] = kValue;
+            for (uint32_t y = kTile.begin.y; y < kTile.end.y; ++y)
+            {
+                const size_t kIndex = static_cast<size_t>(y) * m_Width + kTile.begin.x;
+                NoiseValue* out = kQuantized ? row : &m_Layers[octave][kIndex];
 
-            m_MinValue = glm::min(m_MinValue, kValue);
-            m_MaxValue = glm::max(m_MaxValue, kValue);
+                std::fill_n(ys, kWidth, static_cast<NoiseValue>(y));
+
+                if (m_NoiseDimension == NoiseDimension::Noise2D)
+                    m_FractalNoise.OctaveN(octave, xs, ys, out, kWidth);
+                else
+                    m_FractalNoise.OctaveN(octave, xs, ys, zs, out, kWidth);
+
+                if (kQuantized)
+                    std::transform(row, row + kWidth,
+                                   &m_QuantizedLayers[octave][kIndex], QuantizeNoise);
+            }
         }
+    });
+}
+
+void ProceduralTexture2D::ShiftLayers(const glm::ivec2& shift)
+{
+    const glm::uvec2 kSize = GetSize();
+    const std::vector<MapRegion> kExposed = GetExposedRegions(kSize, shift);
+
+    for (uint32_t i = 0; i < m_CachedLayerCount; ++i)
+    {
+        if (m_LayerCacheMode == LayerCacheMode::Quantized16)
+            ShiftMap(m_QuantizedLayers[i], kSize, 1, shift);
+        else
+            ShiftMap(m_Layers[i], kSize, 1, shift);
+        SampleLayer(i, kExposed);
+    }
+
+    // Partially moved layers are sampled again
+    if (IsCancelled())
+        m_CachedLayerCount = 0;
+}
+
+void ProceduralTexture2D::ClearLayerCache()
+{
+    m_Layers = {};
+    m_QuantizedLayers = {};
+    m_CachedLayerCount = 0;
+}
+
+bool ProceduralTexture2D::IsLayerCacheComplete() const
+{
+    return GetLayerCacheKey() == m_LayerCacheKey &&
+           m_CachedLayerCount >= m_FractalNoise.GetOctaveBudget();
+}
+
+void ProceduralTexture2D::UpdateOctaveStats()
+{
+    const uint32_t kSpacingBudget = m_FractalNoise.GetDerivOctaveBudget();
+    const uint32_t kBudget = m_GenerateGradients ? kSpacingBudget
+                                                 : m_FractalNoise.GetOctaveBudget();
+
+    m_OctaveStats.selected = m_FractalNoise.octaveCount;
+    m_OctaveStats.evaluated = kBudget;
+    m_OctaveStats.belowPrecision = kSpacingBudget - kBudget;
+    m_OctaveStats.belowSpacing = m_FractalNoise.octaveCount - kSpacingBudget;
+
+    m_OctaveStats.faded = 0;
+    for (uint32_t i = 0; i < kBudget; ++i)
+        m_OctaveStats.faded += m_FractalNoise.GetOctaveFade(i) < 1.0f ? 1 : 0;
+}
+
+ProceduralTexture2D::LayerCacheKey ProceduralTexture2D::GetLayerCacheKey() const
+{
+    return {
+        m_Width,
+        m_Height,
+        m_FractalNoise.GetSeed(),
+        m_FractalNoise.scale,
+        m_FractalNoise.offset,
+        m_FractalNoise.lacunarity,
+        m_FractalNoise.basis,
+        m_FractalNoise.worleyNoise.GetCellFunction(),
+        m_FractalNoise.worleyNoise.GetCellDistance(),
+        m_NoiseDimension
+    };
+}
+
+bool ProceduralTexture2D::LayerCacheKey::operator==(const LayerCacheKey& other) const
+{
+    return width == other.width &&
+           height == other.height &&
+           seed == other.seed &&
+           scale == other.scale &&
+           offset == other.offset &&
+           lacunarity == other.lacunarity &&
+           basis == other.basis &&
+           cellFunction == other.cellFunction &&
+           cellDistance == other.cellDistance &&
+           dimension == other.dimension;
+}
+
+ProceduralTexture2D::GenerationKey ProceduralTexture2D::GetGenerationKey() const
+{
+    GenerationKey key;
+    key.noise = GetLayerCacheKey();
+    key.gain = m_FractalNoise.gain;
+    key.octaveCount = m_FractalNoise.octaveCount;
+    key.precision = m_FractalNoise.precision;
+    key.targetSpacing = m_FractalNoise.targetSpacing;
+    key.evaluationMode = m_EvaluationMode;
+    key.layerCacheMode = m_LayerCacheMode;
+    key.gradients = m_GenerateGradients;
+    key.channels = m_GenerateChannels;
+    key.channelOctaves = m_ChannelOctaves;
+    key.valid = true;
+    return key;
+}
+
+bool ProceduralTexture2D::GenerationKey::operator==(const GenerationKey& other) const
+{
+    return noise == other.noise &&
+           gain == other.gain &&
+           octaveCount == other.octaveCount &&
+           precision == other.precision &&
+           targetSpacing == other.targetSpacing &&
+           evaluationMode == other.evaluationMode &&
+           layerCacheMode == other.layerCacheMode &&
+           gradients == other.gradients &&
+           channels == other.channels &&
+           channelOctaves == other.channelOctaves &&
+           valid == other.valid;
 }
 
 void ProceduralTexture2D::UpdateTexture()
 {
     SGL_PROFILE_SCOPE();
 
+    // Written by the compute shader already, there are no channels
+    if (m_ComputeGenerated)
+        return;
+
     std::vector<glm::vec3> grayscaleValues;
     grayscaleValues.reserve(m_Values.size());
     std::transform(m_Values.begin(), m_Values.end(),
@@ -64,7 +1146,7 @@ void ProceduralTexture2D::UpdateTexture()
                    [](float v) { return glm::vec3(v); });
 
     // TODO better
-    m_Texture->SetData({
+    GetTexture()->SetData({
         static_cast<int>(m_Width),
         static_cast<int>(m_Height),
         static_cast<const void*>(grayscaleValues.data()),
@@ -73,6 +1155,42 @@ void ProceduralTexture2D::UpdateTexture()
         GL_FLOAT,
         false
     });
+    m_ComputeTextureSize = glm::uvec2(0);
+
+    UpdateChannelTexture();
+}
+
+const std::shared_ptr<sgl::Texture2D>& ProceduralTexture2D::GetTexture() const
+{
+    if (!m_Texture)
+        m_Texture = sgl::Texture2D::Create();
+    return m_Texture;
+}
+
+const std::shared_ptr<sgl::Texture2D>& ProceduralTexture2D::GetChannelTexture() const
+{
+    if (!m_ChannelTexture)
+        m_ChannelTexture = sgl::Texture2D::Create();
+    return m_ChannelTexture;
+}
+
+void ProceduralTexture2D::UpdateChannelTexture()
+{
+    SGL_PROFILE_SCOPE();
+
+    if (m_ChannelValues.empty())
+        return;
+
+    static_assert(CHANNEL_COUNT == 3, "The channel texture is RGB");
+    GetChannelTexture()->SetData({
+        static_cast<int>(m_Width),
+        static_cast<int>(m_Height),
+        static_cast<const void*>(m_ChannelValues.data()),
+        GL_RGB8,
+        GL_RGB,
+        GL_FLOAT,
+        false
+    });
 }
 
 void ProceduralTexture2D::SetSize(const glm::uvec2& size)
@@ -86,3 +1204,56 @@ void ProceduralTexture2D::SetScale(float scale)
     scale = glm::max(0.001f, scale);
     m_FractalNoise.scale = scale;
 }
+
+void ProceduralTexture2D::SetLayerCacheMode(LayerCacheMode mode)
+{
+    if (mode != m_LayerCacheMode)
+        ClearLayerCache();
+    m_LayerCacheMode = mode;
+}
+
+void ProceduralTexture2D::SetOctavePrecision(OctavePrecision precision)
+{
+    m_OctavePrecision = precision;
+    switch (precision)
+    {
+    case OctavePrecision::Exact:  m_FractalNoise.precision = 0.0f; break;
+    case OctavePrecision::Bits16: m_FractalNoise.precision = 1.0f / 65535.0f; break;
+    case OctavePrecision::Bits8:  m_FractalNoise.precision = 1.0f / 255.0f; break;
+    }
+}
+
+bool ProceduralTexture2D::SetNoiseGraph(const NoiseGraph& graph)
+{
+    if (!graph.Compile(m_NoiseProgram, m_FractalNoise.precision,
+                       m_FractalNoise.targetSpacing, m_NoiseGraphError))
+        return false;
+
+    m_NoiseGraph = graph;
+    return true;
+}
+
+float ProceduralTexture2D::GetSeamError() const
+{
+    if (m_Values.size() != static_cast<size_t>(m_Width) * m_Height || m_Values.empty())
+        return 0.0f;
+
+    float error = 0.0f;
+    for (uint32_t y = 0; y < m_Height; ++y)
+        error = glm::max(error, glm::abs(m_Values[y*m_Width] -
+                                         m_Values[y*m_Width + m_Width - 1]));
+    for (uint32_t x = 0; x < m_Width; ++x)
+        error = glm::max(error, glm::abs(m_Values[x] -
+                                         m_Values[(m_Height - 1)*m_Width + x]));
+    return error;
+}
+
+size_t ProceduralTexture2D::GetLayerCacheSize() const
+{
+    size_t size = 0;
+    for (const auto& layer : m_Layers)
+        size += layer.size() * sizeof(NoiseValue);
+    for (const auto& layer : m_QuantizedLayers)
+        size += layer.size() * sizeof(uint16_t);
+    return size;
+}
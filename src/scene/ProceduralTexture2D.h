@@ -5,14 +5,21 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <vector>
 #include <memory>
+#include <limits>
+#include <functional>
 
 #include <glm/glm.hpp>
 #include <SGL/opengl/Texture2D.h>
 
 #include "PerlinNoise.h"
 #include "FractalNoise.h"
+#include "NoiseGraph.h"
+#include "NoiseCompute.h"
+#include "MapRegion.h"
 
 
 // TODO template
@@ -20,6 +27,66 @@ class ProceduralTexture2D
 {
 public:
     using NoiseValue = float;
+    using Gradient = glm::vec2;
+
+    /** @brief Lattice the height map is sampled from */
+    enum class NoiseDimension
+    {
+        Noise2D = 0,    ///< 2D lattice, 4 corners per octave
+        Noise3D,        ///< Slice of the 3D lattice at z = 0, 8 corners
+    };
+
+    /** @brief Entry point of FractalNoise the rows are evaluated with */
+    enum class EvaluationMode
+    {
+        PerSample = 0,  ///< Noise() per sample, reference
+        Batch,          ///< NoiseN() per row, SIMD kernels
+        Row,            ///< NoiseRow(), row and cell invariants hoisted
+        Split,          ///< NoiseRowSplit(), lattice cell split off in double
+    };
+
+    /** @brief Storage of the per-octave noise layers kept between generations */
+    enum class LayerCacheMode
+    {
+        Off = 0,
+        Float,          ///< Exact, 4 bytes per sample and octave
+        Quantized16,    ///< 16-bit fixed point, error below 2^-15
+    };
+
+    /** @brief Step of the stored values, octaves that cannot change it are dropped */
+    enum class OctavePrecision
+    {
+        Exact = 0,      ///< All octaves are evaluated
+        Bits16,         ///< 1/65535, the step of 16-bit heights
+        Bits8,          ///< 1/255, the step of the 8-bit texture
+    };
+
+    /** @brief Where the values are generated */
+    enum class Backend
+    {
+        CPU = 0,
+        Compute,        ///< Compute shader, see NoiseComputeBackend
+    };
+
+    /** @brief Octaves of the last generation, see FractalNoise::GetOctaveBudget */
+    struct OctaveStats
+    {
+        uint32_t selected{ 0 };         ///< Octave count of the settings
+        uint32_t evaluated{ 0 };
+        uint32_t faded{ 0 };            ///< Evaluated, partially faded out
+        uint32_t belowPrecision{ 0 };   ///< Dropped, below the precision
+        uint32_t belowSpacing{ 0 };     ///< Dropped, faded out or zero amplitude
+    };
+
+    /** @brief Noise channels generated alongside the height, see SetGenerateChannels */
+    enum class Channel
+    {
+        Temperature = 0,
+        Moisture,
+        Detail,         ///< Mask of small scale variations
+        Count
+    };
+    static constexpr uint32_t CHANNEL_COUNT = static_cast<uint32_t>(Channel::Count);
 
     static std::shared_ptr<ProceduralTexture2D> Create(uint32_t width,
                                                        uint32_t height);
@@ -40,10 +107,72 @@ public:
         return m_Values[ std::min(index, m_Values.size()-1) ];
     }
 
-    /** @brief Generates values based on the set size */
+    /**
+     * @brief Generates values based on the set size. When only x and y of
+     *  the offset changed by whole samples, the previous values are moved
+     *  and only the exposed rows and columns are evaluated, see
+     *  GetValueShift.
+     */
     void GenerateValues();
+    /**
+     * @brief Generates the values on the CPU whatever the backend, without
+     *  OpenGL or the SGL profiler, so that it may run on a worker thread
+     */
+    void GenerateValuesInBackground();
 
-    /** @brief Updates the texture with the generated values */
+    /**
+     * @brief Evaluates the height on the CPU at every stride-th sample along
+     *  both axes only, for a coarse preview while the settings change, see
+     *  GetPreviewValues. A coarser preview of the same settings keeps its
+     *  samples, the next generation keeps all of them when it evaluates
+     *  them the same way. The other values are undefined until then, the
+     *  range is the one of the preview.
+     */
+    void GeneratePreview(uint32_t stride);
+    /**
+     * @return False if the preview would not look like the values, for the
+     *  noise graph and periodic noise, or if the values are moved or summed
+     *  from cached layers about as fast
+     */
+    bool CanGeneratePreview(uint32_t stride) const;
+    /**
+     * @return Heights of the last preview, GetPreviewSize samples row by
+     *  row. Kept by SwapValues.
+     */
+    const std::vector<NoiseValue>& GetPreviewValues() const { return m_PreviewValues; }
+    /** @return Samples of the preview of a map, the first and every stride-th one */
+    static glm::uvec2 GetPreviewSize(const glm::uvec2& size, uint32_t stride) {
+        return (glm::max(size, glm::uvec2(1)) - 1U) / stride + 1U;
+    }
+
+    /**
+     * @brief The CPU generation stops early once the flag is set, the values
+     *  are incomplete then. Null to never cancel.
+     */
+    void SetCancelFlag(const std::atomic<bool>* cancel) { m_Cancel = cancel; }
+    bool IsCancelled() const { return m_Cancel && m_Cancel->load(std::memory_order_relaxed); }
+
+    /** @brief Copies the generation settings, but the size and the backend */
+    void CopySettings(const ProceduralTexture2D& other);
+    /** @brief Copies the values, gradients and channels along with their size */
+    void CopyValues(const ProceduralTexture2D& other);
+    /**
+     * @brief Exchanges the generated data and its size with other, the
+     *  vectors keep their addresses. The textures are not updated.
+     */
+    void SwapValues(ProceduralTexture2D& other);
+
+    /** @return Identifies the values, changes with every generation */
+    uint64_t GetValueVersion() const { return m_ValueVersion; }
+    /**
+     * @brief Tells whether the values are those of version moved by whole
+     *  samples, value (x, y) being the previous one at (x + shift.x,
+     *  y + shift.y). The shift is 0 for the current version.
+     * @return False if the values were evaluated anew since version
+     */
+    bool GetValueShift(uint64_t version, glm::ivec2& shift) const;
+
+    /** @brief Updates the textures with the generated values and channels */
     void UpdateTexture();
 
     /** @param size x: Width, y: height */
@@ -52,39 +181,385 @@ public:
 
     std::vector<NoiseValue>& GetValues() { return m_Values; }
     const std::vector<NoiseValue>& GetValues() const { return m_Values; }
+    /**
+     * @return Analytic partial derivatives (d/dx, d/dy) of the values per
+     *  sample, empty unless the gradients are generated
+     */
+    const std::vector<Gradient>& GetGradients() const { return m_Gradients; }
     float GetMinValue() const { return m_MinValue; }
     float GetMaxValue() const { return m_MaxValue; }
 
-    const std::shared_ptr<sgl::Texture2D>& GetTexture() const { return m_Texture; }
+    /**
+     * @brief Created on first use, the values can be generated without a GL
+     *  context, the texture needs the context current
+     */
+    const std::shared_ptr<sgl::Texture2D>& GetTexture() const;
+
+    /**
+     * @return Values of the extra channels, interleaved, CHANNEL_COUNT per
+     *  sample in [0,1], empty unless the channels are generated
+     */
+    const std::vector<NoiseValue>& GetChannelValues() const { return m_ChannelValues; }
+    NoiseValue GetChannelValue(uint32_t index, Channel channel) const {
+        return m_ChannelValues[index * CHANNEL_COUNT + static_cast<uint32_t>(channel)];
+    }
+    /** @brief RGB: temperature, moisture, detail, same size as the height texture */
+    const std::shared_ptr<sgl::Texture2D>& GetChannelTexture() const;
 
     // Noise function settings
 
-    void SetSeed(int32_t seed) {
-        m_FractalNoise.perlinNoise.SetSeed(seed);
-        m_FractalNoise.perlinNoise.GeneratePermutations();
-    }
+    void SetSeed(int32_t seed) { m_FractalNoise.SetSeed(seed); }
     void SetOctaves(int octaves) { m_FractalNoise.octaveCount = octaves; }
     void SetScale(float scale);
-    void SetOffset(float offset) { m_FractalNoise.offset = offset; }
+    /**
+     * @brief Offset of the samples per axis, in samples. Whole numbers let
+     *  the next generation move the values instead of evaluating them.
+     */
+    void SetOffset(const glm::vec3& offset) { m_FractalNoise.offset = offset; }
     void SetGain(float gain) { m_FractalNoise.gain = gain; }
     void SetLacunarity(float lacunarity) { m_FractalNoise.lacunarity = lacunarity; }
+    void SetNoiseDimension(NoiseDimension dimension) { m_NoiseDimension = dimension; }
+    void SetNoiseBasis(NoiseBasis basis) { m_FractalNoise.basis = basis; }
+    /** @brief Value of the Worley basis, see WorleyNoise */
+    void SetCellFunction(WorleySIMD::CellFunction function) {
+        m_FractalNoise.worleyNoise.SetCellFunction(function);
+    }
+    void SetCellDistance(WorleySIMD::CellDistance distance) {
+        m_FractalNoise.worleyNoise.SetCellDistance(distance);
+    }
+    /** @brief Generate the gradient field along with the values */
+    void SetGenerateGradients(bool enabled) { m_GenerateGradients = enabled; }
+    void SetEvaluationMode(EvaluationMode mode) { m_EvaluationMode = mode; }
+    void SetOctavePrecision(OctavePrecision precision);
+    /**
+     * @brief Octaves with a wavelength below twice the spacing, in samples,
+     *  are faded out and dropped, 0 disables. Far terrain regions sampled
+     *  coarser than their vertices use a larger spacing.
+     */
+    void SetTargetSpacing(float spacing) { m_FractalNoise.targetSpacing = glm::max(0.0f, spacing); }
+    /**
+     * @brief Generates the temperature, moisture and detail channels with
+     *  the fractal noise settings, decorrelated by lattice offsets. All
+     *  channels share one traversal of the octaves, together with the height
+     *  when it uses the batch evaluation of the 2D fractal noise.
+     */
+    void SetGenerateChannels(bool enabled) { m_GenerateChannels = enabled; }
+    /** @brief Octaves summed by the channel, at most the octaves of the height */
+    void SetChannelOctaves(Channel channel, int octaves) {
+        m_ChannelOctaves[static_cast<uint32_t>(channel)] = static_cast<uint32_t>(glm::max(octaves, 1));
+    }
+
+    /**
+     * @brief Generates the values with the noise graph instead of the fractal
+     *  noise settings, 2D only and without gradients. The octave precision
+     *  and target spacing apply to the sources of the graph.
+     */
+    void SetUseNoiseGraph(bool enabled) { m_UseNoiseGraph = enabled; }
+    /** @return False if the graph does not compile, the previous one is kept */
+    bool SetNoiseGraph(const NoiseGraph& graph);
+
+    /**
+     * @brief Generates fractal noise that tiles exactly with the period, see
+     *  FractalNoise::NoisePeriodicN. Used instead of the evaluation mode,
+     *  the gradients and the layer cache, not by the noise graph.
+     */
+    void SetPeriodic(bool enabled) { m_Periodic = enabled; }
+    /**
+     * @brief Period in samples along both axes, 0 for the size minus one, so
+     *  that the last row and column repeat the first ones and tiles placed
+     *  next to each other share their edge vertices
+     */
+    void SetTilePeriod(uint32_t period) { m_TilePeriod = period; }
+
+    /**
+     * @brief Generates the values with the compute shader when the settings
+     *  allow it, otherwise on the CPU, see GetComputeFallbackReason. The
+     *  values are written to the texture directly and read back to the CPU
+     *  by ReadBackValues only.
+     */
+    void SetBackend(Backend backend) { m_Backend = backend; }
+    /**
+     * @brief Compiles the compute shader, needs a current OpenGL context
+     * @return False if it does not compile, error has the log
+     */
+    bool InitComputeBackend(const std::string& source, std::string& error);
+    /**
+     * @brief Copies the values generated by the compute shader to the CPU
+     *  and updates the value range, no-op if they are there already. Call
+     *  before the values, the gradients or the range are used.
+     */
+    void ReadBackValues();
+    /**
+     * @brief Tiles of the CPU generation, evaluated across the workers. The
+     *  values and the range do not depend on the tile size or the worker
+     *  count. 0 selects the full width or a row count per task.
+     */
+    void SetTileSize(const glm::uvec2& size) { m_TileSize = size; }
+    /** @return FNV-1a hash of the bits of the values */
+    uint64_t GetValueHash() const;
+    /**
+     * @brief Generates the whole map on the CPU runs times with the current
+     *  settings, for the calibration, see AutoTuner
+     * @return Duration of the fastest run, in ms
+     */
+    double TimeGeneration(uint32_t runs);
+    /**
+     * @brief Generates the map on the CPU as well, for the current settings
+     * @return Largest difference between the CPU and the compute shader
+     *  values, 0 if the values were not generated by the compute shader
+     */
+    float MeasureComputeParity();
+    /**
+     * @brief Evaluates the 2D and 3D Perlin noise of the seed with the SIMD
+     *  kernel of every instruction set available and with the scalar path
+     * @return Largest difference, within PerlinSIMD::PERLIN_SIMD_MAX_ERROR
+     *  unless a kernel diverged
+     */
+    float MeasureSIMDParity() const;
 
-    int32_t GetSeed() const { return m_FractalNoise.perlinNoise.GetSeed(); }
+    int32_t GetSeed() const { return m_FractalNoise.GetSeed(); }
     int GetOctaves() const { return m_FractalNoise.octaveCount; }
     float GetScale() const { return m_FractalNoise.scale; }
-    float GetOffset() const { return m_FractalNoise.offset; }
+    glm::vec3 GetOffset() const { return m_FractalNoise.offset; }
     float GetGain() const { return m_FractalNoise.gain; }
     float GetLacunarity() const { return m_FractalNoise.lacunarity; }
+    /**
+     * @brief Keeps the raw noise of each octave, so that changes of the gain
+     *  or fewer octaves only re-weight the layers and more octaves only
+     *  sample the new ones. Only used by the batch evaluation and bypassed
+     *  when the gradients are generated.
+     */
+    void SetLayerCacheMode(LayerCacheMode mode);
+    /** @brief The cache is dropped for maps whose layers exceed the budget */
+    void SetLayerCacheBudget(size_t megabytes) { m_LayerCacheBudget = megabytes; }
+    NoiseDimension GetNoiseDimension() const { return m_NoiseDimension; }
+    NoiseBasis GetNoiseBasis() const { return m_FractalNoise.basis; }
+    WorleySIMD::CellFunction GetCellFunction() const {
+        return m_FractalNoise.worleyNoise.GetCellFunction();
+    }
+    WorleySIMD::CellDistance GetCellDistance() const {
+        return m_FractalNoise.worleyNoise.GetCellDistance();
+    }
+    bool GetGenerateGradients() const { return m_GenerateGradients; }
+    EvaluationMode GetEvaluationMode() const { return m_EvaluationMode; }
+    glm::uvec2 GetTileSize() const { return m_TileSize; }
+    OctavePrecision GetOctavePrecision() const { return m_OctavePrecision; }
+    float GetTargetSpacing() const { return m_FractalNoise.targetSpacing; }
+    const OctaveStats& GetOctaveStats() const { return m_OctaveStats; }
+    bool GetGenerateChannels() const { return m_GenerateChannels; }
+    int GetChannelOctaves(Channel channel) const {
+        return static_cast<int>(m_ChannelOctaves[static_cast<uint32_t>(channel)]);
+    }
+    Backend GetBackend() const { return m_Backend; }
+    bool IsComputeBackendReady() const { return m_ComputeBackend.IsReady(); }
+    /** @return True if the last values were generated by the compute shader */
+    bool IsComputeGenerated() const { return m_ComputeGenerated; }
+    /** @return Why the last generation ran on the CPU, empty if it did not */
+    const std::string& GetComputeFallbackReason() const { return m_ComputeFallbackReason; }
+    bool HasPendingReadBack() const { return m_PendingReadBack; }
+    bool GetPeriodic() const { return m_Periodic; }
+    uint32_t GetTilePeriod() const { return m_TilePeriod; }
+    /**
+     * @return Largest difference between the first and the last row and
+     *  column of the values, 0 if the map tiles seamlessly with the default
+     *  period
+     */
+    float GetSeamError() const;
+    bool GetUseNoiseGraph() const { return m_UseNoiseGraph; }
+    const NoiseGraph& GetNoiseGraph() const { return m_NoiseGraph; }
+    /** @return Why the last graph set did not compile, empty if it did */
+    const std::string& GetNoiseGraphError() const { return m_NoiseGraphError; }
+    const NoiseProgram& GetNoiseProgram() const { return m_NoiseProgram; }
+    LayerCacheMode GetLayerCacheMode() const { return m_LayerCacheMode; }
+    size_t GetLayerCacheBudget() const { return m_LayerCacheBudget; }
+    /** @return Number of octave layers currently cached */
+    uint32_t GetCachedLayerCount() const { return m_CachedLayerCount; }
+    /** @return Memory used by the cached layers in bytes */
+    size_t GetLayerCacheSize() const;
+
+private:
+    /**
+     * @brief Evaluates the extra channels of the regions row by row, along
+     *  with the height as one more channel if withHeight
+     */
+    void GenerateChannels(bool withHeight, const std::vector<MapRegion>& regions);
+    void UpdateChannelTexture();
+
+    using TileFunction = std::function<void(const glm::uvec2&, const glm::uvec2&)>;
+
+    /** @brief Per thread row scratch of the tile functions, see GetScratchBuffer */
+    template <uint32_t Slot>
+    static NoiseValue* Scratch(size_t n)
+    {
+        return GetScratchBuffer<NoiseValue, ProceduralTexture2D, Slot>(n);
+    }
+
+    struct ValueRange
+    {
+        NoiseValue min{ std::numeric_limits<NoiseValue>::max() };
+        NoiseValue max{ std::numeric_limits<NoiseValue>::lowest() };
+    };
+
+    /**
+     * @brief Evaluates the tile [begin,end) with the evaluation mode, but
+     *  the samples of the preview in the values
+     */
+    void GenerateTile(const glm::uvec2& begin, const glm::uvec2& end);
+    /**
+     * @brief Evaluates the height at xs of row y, in a batch unless per
+     *  sample, the same values as GenerateTile in these modes
+     */
+    void EvaluateSamples(const NoiseValue* xs, size_t count, uint32_t y, NoiseValue* out) const;
+    /** @return Tile size of the settings, full rows for the row modes */
+    glm::uvec2 GetEvaluationTileSize() const;
+    /**
+     * @brief Runs generate(begin, end) for the tiles of the regions across
+     *  the workers, takes the range of each tile right after it and merges
+     *  them into the current range
+     */
+    void GenerateTiles(const char* name, const glm::uvec2& tileSize,
+                       const std::vector<MapRegion>& regions,
+                       const TileFunction& generate);
+    void MergeValueRanges(const std::vector<ValueRange>& ranges);
+    MapRegion GetMapRegion() const { return { glm::uvec2(0), GetSize() }; }
+    /** @brief Sets the min and max value from the values */
+    void UpdateValueRange();
+
+    /** @return False if the compute shader cannot generate the current settings */
+    bool CanUseCompute();
+    void GenerateValuesCompute();
+    /** @brief Evaluates the values on the CPU, see GenerateValues */
+    void GenerateValuesCPU();
+    /**
+     * @brief Evaluates the values of the regions on the CPU, their range is
+     *  merged into the current one
+     */
+    void GenerateValuesCPU(const std::vector<MapRegion>& regions);
+
+    /** @brief Evaluates the periodic values row by row */
+    void GenerateValuesPeriodic();
+
+    /** @brief Evaluates the values with the gradients, sample by sample */
+    void GenerateValuesWithGradients(const std::vector<MapRegion>& regions);
+
+    /**
+     * @brief Samples the missing octave layers and sums them in the regions
+     * @return False if the layers do not fit the budget, nothing is written
+     */
+    bool GenerateValuesFromLayers(const std::vector<MapRegion>& regions);
+    /** @brief Samples the raw noise of an octave in the regions of its layer */
+    void SampleLayer(uint32_t octave, const std::vector<MapRegion>& regions);
+    /** @brief Moves the cached layers by shift and samples the exposed regions */
+    void ShiftLayers(const glm::ivec2& shift);
+    void ClearLayerCache();
+    /** @return True if the layers of the settings are all cached */
+    bool IsLayerCacheComplete() const;
+    void UpdateOctaveStats();
+
+    /** @brief Settings the cached layers depend on, all but gain and octaves */
+    struct LayerCacheKey
+    {
+        uint32_t width{ 0 };
+        uint32_t height{ 0 };
+        int32_t seed{ 0 };
+        float scale{ 0 };
+        glm::vec3 offset{ 0 };
+        float lacunarity{ 0 };
+        NoiseBasis basis{ NoiseBasis::Perlin };
+        WorleySIMD::CellFunction cellFunction{ WorleySIMD::CellFunction::F1 };
+        WorleySIMD::CellDistance cellDistance{ WorleySIMD::CellDistance::Euclidean };
+        NoiseDimension dimension{ NoiseDimension::Noise2D };
+
+        bool operator==(const LayerCacheKey& other) const;
+    };
+    LayerCacheKey GetLayerCacheKey() const;
+
+    /** @brief Settings the values depend on, see CanShiftValues */
+    struct GenerationKey
+    {
+        LayerCacheKey noise;
+        float gain{ 0 };
+        uint32_t octaveCount{ 0 };
+        float precision{ 0 };
+        float targetSpacing{ 0 };
+        EvaluationMode evaluationMode{ EvaluationMode::Batch };
+        LayerCacheMode layerCacheMode{ LayerCacheMode::Off };
+        bool gradients{ false };
+        bool channels{ false };
+        std::array<uint32_t, CHANNEL_COUNT> channelOctaves{};
+        bool valid{ false };    ///< False for values that may not be moved
+
+        bool operator==(const GenerationKey& other) const;
+    };
+    GenerationKey GetGenerationKey() const;
+
+    /**
+     * @return True if the values may be moved by whole samples to the
+     *  settings of key instead of being evaluated, see GetValueShift
+     */
+    bool CanShiftValues(const GenerationKey& key, glm::ivec2& shift) const;
+    /**
+     * @brief Moves the values, gradients and channels by shift and sets the
+     *  range of the moved values
+     * @return Regions left to evaluate
+     */
+    std::vector<MapRegion> ShiftValues(const glm::ivec2& shift);
 
 private:
     uint32_t m_Width{ 0 };
     uint32_t m_Height{ 0 };
 
     FractalNoise<NoiseValue> m_FractalNoise;
+    NoiseDimension m_NoiseDimension{ NoiseDimension::Noise2D };
     std::vector<NoiseValue> m_Values;
+    std::vector<Gradient> m_Gradients;
+    bool m_GenerateGradients{ false };
+    EvaluationMode m_EvaluationMode{ EvaluationMode::Batch };
+    glm::uvec2 m_TileSize{ 256, 16 };
+    OctavePrecision m_OctavePrecision{ OctavePrecision::Exact };
+    OctaveStats m_OctaveStats;
+
+    bool m_GenerateChannels{ false };
+    std::array<uint32_t, CHANNEL_COUNT> m_ChannelOctaves{ 2, 3, 8 };
+    std::vector<NoiseValue> m_ChannelValues;
+    mutable std::shared_ptr<sgl::Texture2D> m_ChannelTexture;
+
+    Backend m_Backend{ Backend::CPU };
+    NoiseComputeBackend m_ComputeBackend;
+    std::string m_ComputeFallbackReason;
+    bool m_ComputeGenerated{ false };
+    bool m_PendingReadBack{ false };
+    glm::uvec2 m_ComputeTextureSize{ 0 };   ///< Of the RGBA8 texture storage
+
+    bool m_Periodic{ false };
+    uint32_t m_TilePeriod{ 0 };
+
+    bool m_UseNoiseGraph{ false };
+    NoiseGraph m_NoiseGraph{ NoiseGraph::CreateDefault() };
+    NoiseProgram m_NoiseProgram;
+    std::string m_NoiseGraphError;
+
+    LayerCacheMode m_LayerCacheMode{ LayerCacheMode::Off };
+    size_t m_LayerCacheBudget{ 256 };   ///< MiB
+    LayerCacheKey m_LayerCacheKey;
+    uint32_t m_CachedLayerCount{ 0 };
+    std::vector<std::vector<NoiseValue>> m_Layers;
+    std::vector<std::vector<uint16_t>> m_QuantizedLayers;
 
     float m_MinValue{ 0.0 };
     float m_MaxValue{ 0.0 };
 
-    std::shared_ptr<sgl::Texture2D> m_Texture;
+    // Settings and identity of the values, they move with the values
+    GenerationKey m_ValueKey;
+    uint64_t m_ValueVersion{ 0 };
+    uint64_t m_ShiftedVersion{ 0 };     ///< The values were moved from, 0 if none
+    glm::ivec2 m_ValueShift{ 0 };
+    GenerationKey m_PreviewKey;
+    uint32_t m_PreviewStride{ 0 };      ///< Of the preview samples in the values, 0 if none
+
+    std::vector<NoiseValue> m_PreviewValues;
+
+    const std::atomic<bool>* m_Cancel{ nullptr };
+
+    mutable std::shared_ptr<sgl::Texture2D> m_Texture;
 };
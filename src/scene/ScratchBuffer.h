@@ -0,0 +1,29 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+
+/**
+ * @brief Scratch buffer of at least n elements owned by the calling thread,
+ *  reused across the rows and tiles the thread evaluates instead of being
+ *  allocated per call. It only grows, up to the widest row seen.
+ *  Each Owner and Slot pair is a separate buffer, functions that call each
+ *  other use different slots. The buffer is only valid until the next call
+ *  with the same pair on this thread, it must not be held across a wait on
+ *  the job system, which may run other tasks on this thread.
+ */
+template <typename T, typename Owner, uint32_t Slot>
+T* GetScratchBuffer(size_t n)
+{
+    thread_local std::vector<T> s_Buffer;
+    if (s_Buffer.size() < n)
+        s_Buffer.resize(n);
+    return s_Buffer.data();
+}
@@ -0,0 +1,429 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "SimplexNoiseSIMD.h"
+#include "ScratchBuffer.h"
+
+
+/**
+ * @brief Simplex noise, same interface as PerlinNoise.
+ *  Samples the corners of the simplex (triangle in 2D, tetrahedron in 3D)
+ *  containing the point, instead of the hypercube: 3 corners in 2D, 4 in 3D,
+ *  with radially symmetric kernels, which avoids the axis-aligned artefacts.
+ *  Stefan Gustavson. Simplex noise demystified. 2005.
+ *  [online]. https://weber.itn.liu.se/~stegu/simplexnoise/simplexnoise.pdf
+ */
+template <typename T>
+class SimplexNoise
+{
+public:
+    SimplexNoise(int32_t seed = std::random_device{}())
+        : m_Seed(seed)
+    {
+        GeneratePermutations();
+    }
+
+    int32_t GetSeed() const { return m_Seed; }
+    /** @brief Just sets the seed, generate the permutations to see the diff. */
+    void SetSeed(int32_t seed) { m_Seed = seed; }
+
+    /** @brief Generate random lookup for permutations containing all numbers
+     * from 0..255, the same lookup as of PerlinNoise with the same seed */
+    void GeneratePermutations()
+    {
+        std::iota(m_P.begin(), m_P.begin() + PERMUTATION_COUNT, 0);
+
+        std::default_random_engine rndEngine(m_Seed);
+        std::shuffle(m_P.begin(), m_P.begin() + PERMUTATION_COUNT, rndEngine);
+
+        for (uint32_t i = 0; i < PERMUTATION_COUNT; ++i)
+            m_P[PERMUTATION_COUNT + i] = m_P[i];
+    }
+
+    /** @return Simplex 2D noise value in [-1,1] */
+    T Noise(T x, T y) const
+    {
+        // Skew the input space to find the simplex cell
+        const T s = (x + y) * F2;
+        const T i = glm::floor(x + s);
+        const T j = glm::floor(y + s);
+
+        // Unskew the cell origin back to (x,y) space
+        const T t = (i + j) * G2;
+        const T x0 = x - (i - t);
+        const T y0 = y - (j - t);
+
+        return NoiseInCell((int32_t)i & 255, (int32_t)j & 255, x0, y0);
+    }
+
+    /**
+     * @return Simplex 2D noise value in [-1,1] of the point at x0,y0 relative
+     *  to the origin of the skewed cell ii,jj, wrapped to [0,255]
+     */
+    T NoiseInCell(int32_t ii, int32_t jj, T x0, T y0) const
+    {
+        // Lower or upper triangle of the cell
+        const int32_t i1 = x0 > y0 ? 1 : 0;
+        const int32_t j1 = 1 - i1;
+
+        const T x1 = x0 - (T)i1 + G2;
+        const T y1 = y0 - (T)j1 + G2;
+        const T x2 = x0 - (T)1 + (T)2 * G2;
+        const T y2 = y0 - (T)1 + (T)2 * G2;
+
+        return (Corner(m_P[ii      + m_P[jj     ]], x0, y0) +
+                Corner(m_P[ii + i1 + m_P[jj + j1]], x1, y1) +
+                Corner(m_P[ii + 1  + m_P[jj + 1 ]], x2, y2)) * SCALE_2D;
+    }
+
+    /** @return Simplex 3D noise value in [-1,1] */
+    T Noise(T x, T y, T z) const
+    {
+        return NoiseDeriv(x, y, z).x;
+    }
+
+    /**
+     * @brief Evaluates out[i] = Noise(xs[i], ys[i]) for n samples, for floats
+     *  by the SIMD kernel of the set instruction set, see SimplexNoiseSIMD.h
+     */
+    void NoiseN(const T* xs, const T* ys, T* out, size_t n) const
+    {
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (SimplexSIMD::Noise2D(m_ISA, m_P.data(), xs, ys, out, n))
+                return;
+        }
+
+        for (size_t i = 0; i < n; ++i)
+            out[i] = Noise(xs[i], ys[i]);
+    }
+
+    /**
+     * @brief Evaluates channelCount decorrelated 2D noises for n samples,
+     *  channel c is Noise(x + offsets[c], y), see PerlinNoise::NoiseChannelsN.
+     *  The lattice is not shared, each channel is a batch of its own.
+     * @param[out] out Planar, channel c at out + c*n
+     */
+    void NoiseChannelsN(const int32_t* offsets, uint32_t channelCount,
+                        const T* xs, const T* ys, T* out, size_t n) const
+    {
+        T* shiftedX = Scratch<T, 3>(n);
+        for (uint32_t c = 0; c < channelCount; ++c)
+        {
+            for (size_t i = 0; i < n; ++i)
+                shiftedX[i] = xs[i] + (T)offsets[c];
+            NoiseN(shiftedX, ys, out + c*n, n);
+        }
+    }
+
+    /** @brief Evaluates out[i] = Noise(xs[i], ys[i], zs[i]) for n samples */
+    void NoiseN(const T* xs, const T* ys, const T* zs, T* out, size_t n) const
+    {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = Noise(xs[i], ys[i], zs[i]);
+    }
+
+    /**
+     * @brief Evaluates out[i] = Noise(xs[i], ys[i]) for coordinates given in
+     *  double. The skewed cell is found in double and split off as a 64-bit
+     *  integer, only the offset within the cell is evaluated in T, so the
+     *  precision does not degrade far from the origin.
+     */
+    void NoiseSplitN(const double* xs, const double* ys, T* out, size_t n) const
+    {
+        int32_t* cellX = Scratch<int32_t, 0>(n);
+        int32_t* cellY = Scratch<int32_t, 1>(n);
+        T* offsetX = Scratch<T, 0>(n);
+        T* offsetY = Scratch<T, 1>(n);
+        for (size_t s = 0; s < n; ++s)
+        {
+            const double kSkew = (xs[s] + ys[s]) * F2_EXACT;
+            const double i = std::floor(xs[s] + kSkew);
+            const double j = std::floor(ys[s] + kSkew);
+            const double t = (i + j) * G2_EXACT;
+
+            cellX[s] = static_cast<int32_t>(static_cast<int64_t>(i) & 255);
+            cellY[s] = static_cast<int32_t>(static_cast<int64_t>(j) & 255);
+            offsetX[s] = static_cast<T>(xs[s] - (i - t));
+            offsetY[s] = static_cast<T>(ys[s] - (j - t));
+        }
+
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (SimplexSIMD::Noise2DSplit(m_ISA, m_P.data(), cellX, cellY,
+                                          offsetX, offsetY, out, n))
+                return;
+        }
+
+        for (size_t s = 0; s < n; ++s)
+            out[s] = NoiseInCell(cellX[s], cellY[s], offsetX[s], offsetY[s]);
+    }
+
+    /** @brief 3D variant of NoiseSplitN, scalar only */
+    void NoiseSplitN(const double* xs, const double* ys, const double* zs,
+                     T* out, size_t n) const
+    {
+        for (size_t s = 0; s < n; ++s)
+        {
+            const double kSkew = (xs[s] + ys[s] + zs[s]) * F3_EXACT;
+            const double i = std::floor(xs[s] + kSkew);
+            const double j = std::floor(ys[s] + kSkew);
+            const double k = std::floor(zs[s] + kSkew);
+            const double t = (i + j + k) * G3_EXACT;
+
+            const glm::vec<3, T> kOffset(static_cast<T>(xs[s] - (i - t)),
+                                         static_cast<T>(ys[s] - (j - t)),
+                                         static_cast<T>(zs[s] - (k - t)));
+            out[s] = NoiseDerivInCell(static_cast<int32_t>(static_cast<int64_t>(i) & 255),
+                                      static_cast<int32_t>(static_cast<int64_t>(j) & 255),
+                                      static_cast<int32_t>(static_cast<int64_t>(k) & 255),
+                                      kOffset).x;
+        }
+    }
+
+    /**
+     * @brief Evaluates out[i] = Noise(x0 + i*dx, y, z) for count samples.
+     *  The simplex of a sample depends on all of its coordinates, so the row
+     *  is expanded and evaluated by NoiseN.
+     */
+    void NoiseRow(T y, T z, T x0, T dx, size_t count, T* out) const
+    {
+        T* xs = Scratch<T, 0>(count);
+        T* ys = Scratch<T, 1>(count);
+        T* zs = Scratch<T, 2>(count);
+        for (size_t i = 0; i < count; ++i)
+            xs[i] = x0 + (T)i * dx;
+        std::fill_n(ys, count, y);
+        std::fill_n(zs, count, z);
+        NoiseN(xs, ys, zs, out, count);
+    }
+
+    /** @brief Evaluates out[i] = Noise(x0 + i*dx, y) for count samples */
+    void NoiseRow(T y, T x0, T dx, size_t count, T* out) const
+    {
+        T* xs = Scratch<T, 0>(count);
+        T* ys = Scratch<T, 1>(count);
+        for (size_t i = 0; i < count; ++i)
+            xs[i] = x0 + (T)i * dx;
+        std::fill_n(ys, count, y);
+        NoiseN(xs, ys, out, count);
+    }
+
+    PerlinSIMD::ISA GetISA() const { return m_ISA; }
+    /** @brief Instruction sets without a kernel fall back to the scalar path */
+    void SetISA(PerlinSIMD::ISA isa) { m_ISA = isa; }
+
+    /**
+     * @return Simplex 2D noise value in [-1,1] along with its analytic
+     *  partial derivatives, x: value, y: d/dx, z: d/dy
+     */
+    glm::vec<3, T> NoiseDeriv(T x, T y) const
+    {
+        // Skew the input space to find the simplex cell
+        const T s = (x + y) * F2;
+        const T i = glm::floor(x + s);
+        const T j = glm::floor(y + s);
+
+        // Unskew the cell origin back to (x,y) space
+        const T t = (i + j) * G2;
+        const glm::vec<2, T> d0(x - (i - t), y - (j - t));
+
+        // Lower or upper triangle of the cell
+        const glm::vec<2, T> kOffset1 = d0.x > d0.y ? glm::vec<2, T>(1, 0)
+                                                    : glm::vec<2, T>(0, 1);
+
+        const glm::vec<2, T> d1 = d0 - kOffset1 + G2;
+        const glm::vec<2, T> d2 = d0 - (T)1 + (T)2 * G2;
+
+        const int32_t ii = (int32_t)i & 255;
+        const int32_t jj = (int32_t)j & 255;
+        const int32_t i1 = (int32_t)kOffset1.x;
+        const int32_t j1 = (int32_t)kOffset1.y;
+
+        glm::vec<3, T> result(0);
+        AddCorner(result, m_P[ii      + m_P[jj     ]], d0);
+        AddCorner(result, m_P[ii + i1 + m_P[jj + j1]], d1);
+        AddCorner(result, m_P[ii + 1  + m_P[jj + 1 ]], d2);
+
+        return result * SCALE_2D;
+    }
+
+    /**
+     * @return Simplex 3D noise value in [-1,1] along with its analytic
+     *  partial derivatives, x: value, yzw: d/dx, d/dy, d/dz
+     */
+    glm::vec<4, T> NoiseDeriv(T x, T y, T z) const
+    {
+        const T s = (x + y + z) * F3;
+        const T i = glm::floor(x + s);
+        const T j = glm::floor(y + s);
+        const T k = glm::floor(z + s);
+
+        const T t = (i + j + k) * G3;
+        const glm::vec<3, T> d0(x - (i - t), y - (j - t), z - (k - t));
+
+        return NoiseDerivInCell((int32_t)i & 255, (int32_t)j & 255, (int32_t)k & 255, d0);
+    }
+
+    /**
+     * @return Simplex 3D noise value and derivatives, see NoiseDeriv, of the
+     *  point at d0 relative to the origin of the skewed cell ii,jj,kk
+     */
+    glm::vec<4, T> NoiseDerivInCell(int32_t ii, int32_t jj, int32_t kk,
+                                    const glm::vec<3, T>& d0) const
+    {
+        // Which of the six tetrahedra of the cell contains the point
+        glm::vec<3, T> kOffset1, kOffset2;
+        if (d0.x >= d0.y)
+        {
+            if (d0.y >= d0.z)
+                { kOffset1 = {1, 0, 0}; kOffset2 = {1, 1, 0}; }
+            else if (d0.x >= d0.z)
+                { kOffset1 = {1, 0, 0}; kOffset2 = {1, 0, 1}; }
+            else
+                { kOffset1 = {0, 0, 1}; kOffset2 = {1, 0, 1}; }
+        }
+        else
+        {
+            if (d0.y < d0.z)
+                { kOffset1 = {0, 0, 1}; kOffset2 = {0, 1, 1}; }
+            else if (d0.x < d0.z)
+                { kOffset1 = {0, 1, 0}; kOffset2 = {0, 1, 1}; }
+            else
+                { kOffset1 = {0, 1, 0}; kOffset2 = {1, 1, 0}; }
+        }
+
+        const glm::vec<3, T> d1 = d0 - kOffset1 + G3;
+        const glm::vec<3, T> d2 = d0 - kOffset2 + (T)2 * G3;
+        const glm::vec<3, T> d3 = d0 - (T)1 + (T)3 * G3;
+
+        const glm::ivec3 o1(kOffset1);
+        const glm::ivec3 o2(kOffset2);
+
+        glm::vec<4, T> result(0);
+        AddCorner(result, m_P[ii + m_P[jj + m_P[kk]]], d0);
+        AddCorner(result,
+                  m_P[ii + o1.x + m_P[jj + o1.y + m_P[kk + o1.z]]], d1);
+        AddCorner(result,
+                  m_P[ii + o2.x + m_P[jj + o2.y + m_P[kk + o2.z]]], d2);
+        AddCorner(result, m_P[ii + 1 + m_P[jj + 1 + m_P[kk + 1]]], d3);
+
+        return result * SCALE_3D;
+    }
+
+private:
+    /** @brief Per thread scratch of the row and split paths, see GetScratchBuffer */
+    template <typename U, uint32_t Slot>
+    static U* Scratch(size_t n) { return GetScratchBuffer<U, SimplexNoise, Slot>(n); }
+
+    /** @return Contribution t^4 * g.d of a corner, where t = r^2 - |d|^2 */
+    T Corner(uint32_t hash, T x, T y) const
+    {
+        const T t = RADIUS_SQ_2D - x * x - y * y;
+        if (t <= (T)0)
+            return (T)0;
+
+        // Same directions as GradVec2
+        const int h = hash & 7;
+        const T u = h < 6 ? x : y;
+        const T v = h < 4 ? y : (T)0;
+        const T t2 = t * t;
+        return t2 * t2 * (((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v));
+    }
+
+    /**
+     * @brief Adds the contribution (t^4 * g.d) of a corner and its derivative
+     *  (t^4 * g - 8 t^3 * (g.d) * d), where t = r^2 - |d|^2
+     */
+    void AddCorner(glm::vec<3, T>& result, uint32_t hash,
+                   const glm::vec<2, T>& d) const
+    {
+        const T t = RADIUS_SQ_2D - glm::dot(d, d);
+        if (t <= (T)0)
+            return;
+
+        const glm::vec<2, T> g = GradVec2(hash);
+        const T kGradDot = glm::dot(g, d);
+        const T t2 = t * t;
+        const T t4 = t2 * t2;
+
+        const glm::vec<2, T> kDeriv = t4 * g - (T)8 * t2 * t * kGradDot * d;
+        result += glm::vec<3, T>(t4 * kGradDot, kDeriv.x, kDeriv.y);
+    }
+
+    void AddCorner(glm::vec<4, T>& result, uint32_t hash,
+                   const glm::vec<3, T>& d) const
+    {
+        const T t = RADIUS_SQ_3D - glm::dot(d, d);
+        if (t <= (T)0)
+            return;
+
+        const glm::vec<3, T> g = GradVec3(hash);
+        const T kGradDot = glm::dot(g, d);
+        const T t2 = t * t;
+        const T t4 = t2 * t2;
+
+        const glm::vec<3, T> kDeriv = t4 * g - (T)8 * t2 * t * kGradDot * d;
+        result += glm::vec<4, T>(t4 * kGradDot, kDeriv.x, kDeriv.y, kDeriv.z);
+    }
+
+    /** @return One of 8 directions, 4 diagonal and 4 axis-aligned */
+    glm::vec<2, T> GradVec2(int hash) const
+    {
+        int h = hash & 7;
+        return glm::vec<2, T>(
+            h < 6 ? ((h & 1) == 0 ? (T)1 : (T)-1) : (T)0,
+            h < 4 ? ((h & 2) == 0 ? (T)1 : (T)-1)
+                  : h < 6 ? (T)0 : ((h & 1) == 0 ? (T)1 : (T)-1));
+    }
+
+    /** @return One of 12 directions to the edges of a cube */
+    glm::vec<3, T> GradVec3(int hash) const
+    {
+        int h = hash & 15;
+        glm::vec<3, T> g(0);
+        g[h < 8 ? 0 : 1] = (h & 1) == 0 ? (T)1 : (T)-1;
+        g[h < 4 ? 1 : h == 12 || h == 14 ? 0 : 2] = (h & 2) == 0 ? (T)1 : (T)-1;
+        return g;
+    }
+
+private:
+    static const size_t PERMUTATION_COUNT = 256;
+
+    // Skewing and unskewing factors, the split path skews in double with the
+    //  exact factors, the rounded ones shear the lattice far from the origin
+    static constexpr double F2_EXACT = 0.36602540378443864676;  // (sqrt(3) - 1) / 2
+    static constexpr double G2_EXACT = 0.21132486540518711775;  // (3 - sqrt(3)) / 6
+    static constexpr double F3_EXACT = 1.0 / 3.0;
+    static constexpr double G3_EXACT = 1.0 / 6.0;
+    static constexpr T F2 = (T)F2_EXACT;
+    static constexpr T G2 = (T)G2_EXACT;
+    static constexpr T F3 = (T)1 / (T)3;
+    static constexpr T G3 = (T)1 / (T)6;
+
+    // Squared radius of the kernels, 0.5 keeps the 3D noise continuous across
+    //  the simplex boundaries, scale of the sum to [-1,1]
+    static constexpr T RADIUS_SQ_2D = (T)0.5;
+    static constexpr T RADIUS_SQ_3D = (T)0.5;
+    static constexpr T SCALE_2D = (T)70.0;
+    static constexpr T SCALE_3D = (T)76.0;
+
+    std::array<uint32_t, PERMUTATION_COUNT*2> m_P;    ///< Permutations
+    int32_t m_Seed{ 0 };
+
+    PerlinSIMD::ISA m_ISA{ PerlinSIMD::GetBestISA() };
+};
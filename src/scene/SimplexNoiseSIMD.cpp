@@ -0,0 +1,359 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SimplexNoiseSIMD.h"
+
+#include <algorithm>
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+    #define SIMPLEX_SIMD_X86
+    #include <immintrin.h>
+#endif
+
+// Must match the constants of SimplexNoise<float>
+#define SIMPLEX_F2 0.36602540378443864676f
+#define SIMPLEX_G2 0.21132486540518711775f
+#define SIMPLEX_RADIUS_SQ_2D 0.5f
+#define SIMPLEX_SCALE_2D 70.0f
+
+#ifdef SIMPLEX_SIMD_X86
+
+#define TARGET_AVX2   __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+
+// =============================================================================
+// AVX2, 8 samples
+
+TARGET_AVX2 static inline __m256i Gather8(const uint32_t* perm, __m256i idx)
+{
+    return _mm256_i32gather_epi32(reinterpret_cast<const int*>(perm), idx, 4);
+}
+
+/** @brief t^4 * g.d of a corner, zero outside of the kernel radius */
+TARGET_AVX2 static inline __m256 Corner8(__m256i hash, __m256 x, __m256 y)
+{
+    const __m256 t = _mm256_sub_ps(
+        _mm256_sub_ps(_mm256_set1_ps(SIMPLEX_RADIUS_SQ_2D), _mm256_mul_ps(x, x)),
+        _mm256_mul_ps(y, y));
+    const __m256 kInside = _mm256_cmp_ps(t, _mm256_setzero_ps(), _CMP_GT_OQ);
+
+    const __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(7));
+    const __m256 kLt6 = _mm256_castsi256_ps(
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(6), h));
+    const __m256 kLt4 = _mm256_castsi256_ps(
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+
+    const __m256 u = _mm256_blendv_ps(y, x, kLt6);
+    const __m256 v = _mm256_and_ps(y, kLt4);
+
+    const __m256 kSignU = _mm256_castsi256_ps(
+        _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31));
+    const __m256 kSignV = _mm256_castsi256_ps(
+        _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+    const __m256 kGrad = _mm256_add_ps(_mm256_xor_ps(u, kSignU),
+                                       _mm256_xor_ps(v, kSignV));
+
+    const __m256 t2 = _mm256_mul_ps(t, t);
+    return _mm256_and_ps(_mm256_mul_ps(_mm256_mul_ps(t2, t2), kGrad), kInside);
+}
+
+/** @brief Noise of samples given as wrapped skewed cells and in-cell offsets */
+TARGET_AVX2 static inline __m256 Noise2D8Cell(const uint32_t* perm,
+                                              __m256i ii, __m256i jj,
+                                              __m256 x0, __m256 y0)
+{
+    const __m256 kG2 = _mm256_set1_ps(SIMPLEX_G2);
+    const __m256 kOnef = _mm256_set1_ps(1.f);
+    const __m256i kOne = _mm256_set1_epi32(1);
+
+    const __m256 kLower = _mm256_cmp_ps(x0, y0, _CMP_GT_OQ);
+    const __m256 i1 = _mm256_and_ps(kLower, kOnef);
+    const __m256 j1 = _mm256_andnot_ps(kLower, kOnef);
+
+    const __m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, i1), kG2);
+    const __m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, j1), kG2);
+    const __m256 kG2x2 = _mm256_mul_ps(_mm256_set1_ps(2.f), kG2);
+    const __m256 x2 = _mm256_add_ps(_mm256_sub_ps(x0, kOnef), kG2x2);
+    const __m256 y2 = _mm256_add_ps(_mm256_sub_ps(y0, kOnef), kG2x2);
+
+    const __m256i ii1 = _mm256_add_epi32(ii, _mm256_cvttps_epi32(i1));
+    const __m256i jj1 = _mm256_add_epi32(jj, _mm256_cvttps_epi32(j1));
+
+    const __m256i h0 = Gather8(perm, _mm256_add_epi32(ii, Gather8(perm, jj)));
+    const __m256i h1 = Gather8(perm, _mm256_add_epi32(ii1, Gather8(perm, jj1)));
+    const __m256i h2 = Gather8(perm, _mm256_add_epi32(
+        _mm256_add_epi32(ii, kOne),
+        Gather8(perm, _mm256_add_epi32(jj, kOne))));
+
+    return _mm256_mul_ps(
+        _mm256_add_ps(_mm256_add_ps(Corner8(h0, x0, y0), Corner8(h1, x1, y1)),
+                      Corner8(h2, x2, y2)),
+        _mm256_set1_ps(SIMPLEX_SCALE_2D));
+}
+
+TARGET_AVX2 static inline __m256 Noise2D8(const uint32_t* perm,
+                                          __m256 x, __m256 y)
+{
+    const __m256 kG2 = _mm256_set1_ps(SIMPLEX_G2);
+    const __m256i kMask = _mm256_set1_epi32(255);
+
+    const __m256 s = _mm256_mul_ps(_mm256_add_ps(x, y),
+                                   _mm256_set1_ps(SIMPLEX_F2));
+    const __m256 i = _mm256_floor_ps(_mm256_add_ps(x, s));
+    const __m256 j = _mm256_floor_ps(_mm256_add_ps(y, s));
+
+    const __m256 t = _mm256_mul_ps(_mm256_add_ps(i, j), kG2);
+    const __m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(i, t));
+    const __m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(j, t));
+
+    const __m256i ii = _mm256_and_si256(_mm256_cvttps_epi32(i), kMask);
+    const __m256i jj = _mm256_and_si256(_mm256_cvttps_epi32(j), kMask);
+
+    return Noise2D8Cell(perm, ii, jj, x0, y0);
+}
+
+TARGET_AVX2 static void Noise2D_AVX2(const uint32_t* perm,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 8)
+    {
+        _mm256_storeu_ps(out + i, Noise2D8(perm, _mm256_loadu_ps(xs + i),
+                                                 _mm256_loadu_ps(ys + i)));
+    }
+}
+
+TARGET_AVX2 static void Noise2DSplit_AVX2(const uint32_t* perm,
+    const int32_t* cellXs, const int32_t* cellYs,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 8)
+    {
+        _mm256_storeu_ps(out + i, Noise2D8Cell(perm,
+                                               _mm256_loadu_si256((const __m256i*)(cellXs + i)),
+                                               _mm256_loadu_si256((const __m256i*)(cellYs + i)),
+                                               _mm256_loadu_ps(xs + i),
+                                               _mm256_loadu_ps(ys + i)));
+    }
+}
+
+// =============================================================================
+// AVX-512, 16 samples
+
+TARGET_AVX512 static inline __m512i Gather16(const uint32_t* perm, __m512i idx)
+{
+    return _mm512_i32gather_epi32(idx, reinterpret_cast<const int*>(perm), 4);
+}
+
+TARGET_AVX512 static inline __m512 Corner16(__m512i hash, __m512 x, __m512 y)
+{
+    const __m512 t = _mm512_sub_ps(
+        _mm512_sub_ps(_mm512_set1_ps(SIMPLEX_RADIUS_SQ_2D), _mm512_mul_ps(x, x)),
+        _mm512_mul_ps(y, y));
+    const __mmask16 kInside = _mm512_cmp_ps_mask(t, _mm512_setzero_ps(),
+                                                 _CMP_GT_OQ);
+
+    const __m512i h = _mm512_and_si512(hash, _mm512_set1_epi32(7));
+    const __mmask16 kLt6 = _mm512_cmplt_epi32_mask(h, _mm512_set1_epi32(6));
+    const __mmask16 kLt4 = _mm512_cmplt_epi32_mask(h, _mm512_set1_epi32(4));
+
+    const __m512 u = _mm512_mask_blend_ps(kLt6, y, x);
+    const __m512 v = _mm512_maskz_mov_ps(kLt4, y);
+
+    const __m512i kSignU =
+        _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(1)), 31);
+    const __m512i kSignV =
+        _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(2)), 30);
+    const __m512 kGrad = _mm512_add_ps(
+        _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(u), kSignU)),
+        _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(v), kSignV)));
+
+    const __m512 t2 = _mm512_mul_ps(t, t);
+    return _mm512_maskz_mov_ps(kInside,
+                               _mm512_mul_ps(_mm512_mul_ps(t2, t2), kGrad));
+}
+
+/** @brief Noise of samples given as wrapped skewed cells and in-cell offsets */
+TARGET_AVX512 static inline __m512 Noise2D16Cell(const uint32_t* perm,
+                                                 __m512i ii, __m512i jj,
+                                                 __m512 x0, __m512 y0)
+{
+    const __m512 kG2 = _mm512_set1_ps(SIMPLEX_G2);
+    const __m512 kOnef = _mm512_set1_ps(1.f);
+    const __m512i kOne = _mm512_set1_epi32(1);
+
+    const __mmask16 kLower = _mm512_cmp_ps_mask(x0, y0, _CMP_GT_OQ);
+    const __m512 i1 = _mm512_maskz_mov_ps(kLower, kOnef);
+    const __m512 j1 = _mm512_maskz_mov_ps(~kLower, kOnef);
+
+    const __m512 x1 = _mm512_add_ps(_mm512_sub_ps(x0, i1), kG2);
+    const __m512 y1 = _mm512_add_ps(_mm512_sub_ps(y0, j1), kG2);
+    const __m512 kG2x2 = _mm512_mul_ps(_mm512_set1_ps(2.f), kG2);
+    const __m512 x2 = _mm512_add_ps(_mm512_sub_ps(x0, kOnef), kG2x2);
+    const __m512 y2 = _mm512_add_ps(_mm512_sub_ps(y0, kOnef), kG2x2);
+
+    const __m512i ii1 = _mm512_add_epi32(ii, _mm512_cvttps_epi32(i1));
+    const __m512i jj1 = _mm512_add_epi32(jj, _mm512_cvttps_epi32(j1));
+
+    const __m512i h0 = Gather16(perm, _mm512_add_epi32(ii, Gather16(perm, jj)));
+    const __m512i h1 = Gather16(perm, _mm512_add_epi32(ii1, Gather16(perm, jj1)));
+    const __m512i h2 = Gather16(perm, _mm512_add_epi32(
+        _mm512_add_epi32(ii, kOne),
+        Gather16(perm, _mm512_add_epi32(jj, kOne))));
+
+    return _mm512_mul_ps(
+        _mm512_add_ps(_mm512_add_ps(Corner16(h0, x0, y0), Corner16(h1, x1, y1)),
+                      Corner16(h2, x2, y2)),
+        _mm512_set1_ps(SIMPLEX_SCALE_2D));
+}
+
+TARGET_AVX512 static inline __m512 Noise2D16(const uint32_t* perm,
+                                             __m512 x, __m512 y)
+{
+    const __m512 kG2 = _mm512_set1_ps(SIMPLEX_G2);
+    const __m512i kMask = _mm512_set1_epi32(255);
+
+    const __m512 s = _mm512_mul_ps(_mm512_add_ps(x, y),
+                                   _mm512_set1_ps(SIMPLEX_F2));
+    const __m512 i = _mm512_roundscale_ps(_mm512_add_ps(x, s),
+                                          _MM_FROUND_TO_NEG_INF);
+    const __m512 j = _mm512_roundscale_ps(_mm512_add_ps(y, s),
+                                          _MM_FROUND_TO_NEG_INF);
+
+    const __m512 t = _mm512_mul_ps(_mm512_add_ps(i, j), kG2);
+    const __m512 x0 = _mm512_sub_ps(x, _mm512_sub_ps(i, t));
+    const __m512 y0 = _mm512_sub_ps(y, _mm512_sub_ps(j, t));
+
+    const __m512i ii = _mm512_and_si512(_mm512_cvttps_epi32(i), kMask);
+    const __m512i jj = _mm512_and_si512(_mm512_cvttps_epi32(j), kMask);
+
+    return Noise2D16Cell(perm, ii, jj, x0, y0);
+}
+
+TARGET_AVX512 static void Noise2D_AVX512(const uint32_t* perm,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 16)
+    {
+        _mm512_storeu_ps(out + i, Noise2D16(perm, _mm512_loadu_ps(xs + i),
+                                                  _mm512_loadu_ps(ys + i)));
+    }
+}
+
+TARGET_AVX512 static void Noise2DSplit_AVX512(const uint32_t* perm,
+    const int32_t* cellXs, const int32_t* cellYs,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i += 16)
+    {
+        _mm512_storeu_ps(out + i, Noise2D16Cell(perm,
+                                                _mm512_loadu_si512(cellXs + i),
+                                                _mm512_loadu_si512(cellYs + i),
+                                                _mm512_loadu_ps(xs + i),
+                                                _mm512_loadu_ps(ys + i)));
+    }
+}
+
+#endif // SIMPLEX_SIMD_X86
+
+// =============================================================================
+
+namespace SimplexSIMD
+{
+
+using Kernel2D = void (*)(const uint32_t*, const float*, const float*,
+                          float*, size_t);
+
+bool Noise2D(PerlinSIMD::ISA isa, const uint32_t* perm,
+             const float* xs, const float* ys,
+             float* out, size_t n)
+{
+#ifdef SIMPLEX_SIMD_X86
+    using PerlinSIMD::ISA;
+    if (isa == ISA::Scalar || isa > PerlinSIMD::GetBestISA())
+        return false;
+
+    Kernel2D kernel = nullptr;
+    switch (isa)
+    {
+        case ISA::AVX2:   kernel = Noise2D_AVX2; break;
+        case ISA::AVX512: kernel = Noise2D_AVX512; break;
+        default: return false;
+    }
+
+    // Whole blocks of lanes, the tail goes through a zero padded block
+    const uint32_t kLanes = PerlinSIMD::GetLaneCount(isa);
+    const size_t kBlocked = n - n % kLanes;
+    if (kBlocked > 0)
+        kernel(perm, xs, ys, out, kBlocked);
+
+    const size_t kTail = n - kBlocked;
+    if (kTail == 0)
+        return true;
+
+    constexpr uint32_t kMaxLanes = 16;
+    float x[kMaxLanes]{}, y[kMaxLanes]{}, result[kMaxLanes];
+
+    std::copy_n(xs + kBlocked, kTail, x);
+    std::copy_n(ys + kBlocked, kTail, y);
+
+    kernel(perm, x, y, result, kLanes);
+
+    std::copy_n(result, kTail, out + kBlocked);
+    return true;
+#else
+    return false;
+#endif
+}
+
+using Kernel2DSplit = void (*)(const uint32_t*, const int32_t*, const int32_t*,
+                               const float*, const float*, float*, size_t);
+
+bool Noise2DSplit(PerlinSIMD::ISA isa, const uint32_t* perm,
+                  const int32_t* cellXs, const int32_t* cellYs,
+                  const float* xs, const float* ys,
+                  float* out, size_t n)
+{
+#ifdef SIMPLEX_SIMD_X86
+    using PerlinSIMD::ISA;
+    if (isa == ISA::Scalar || isa > PerlinSIMD::GetBestISA())
+        return false;
+
+    Kernel2DSplit kernel = nullptr;
+    switch (isa)
+    {
+        case ISA::AVX2:   kernel = Noise2DSplit_AVX2; break;
+        case ISA::AVX512: kernel = Noise2DSplit_AVX512; break;
+        default: return false;
+    }
+
+    const uint32_t kLanes = PerlinSIMD::GetLaneCount(isa);
+    const size_t kBlocked = n - n % kLanes;
+    if (kBlocked > 0)
+        kernel(perm, cellXs, cellYs, xs, ys, out, kBlocked);
+
+    const size_t kTail = n - kBlocked;
+    if (kTail == 0)
+        return true;
+
+    constexpr uint32_t kMaxLanes = 16;
+    int32_t cellX[kMaxLanes]{}, cellY[kMaxLanes]{};
+    float x[kMaxLanes]{}, y[kMaxLanes]{}, result[kMaxLanes];
+
+    std::copy_n(cellXs + kBlocked, kTail, cellX);
+    std::copy_n(cellYs + kBlocked, kTail, cellY);
+    std::copy_n(xs + kBlocked, kTail, x);
+    std::copy_n(ys + kBlocked, kTail, y);
+
+    kernel(perm, cellX, cellY, x, y, result, kLanes);
+
+    std::copy_n(result, kTail, out + kBlocked);
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace SimplexSIMD
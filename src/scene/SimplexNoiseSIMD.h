@@ -0,0 +1,42 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "PerlinNoiseSIMD.h"
+
+
+/**
+ * @brief Vectorized batch kernel of the 2D simplex noise, branch-free over 8
+ *  (AVX2) or 16 (AVX-512) samples. Mirrors SimplexNoise<float>::Noise
+ *  operation by operation, the results are bit-identical to the scalar path,
+ *  see PerlinSIMD for the instruction set selection and the error bound.
+ */
+namespace SimplexSIMD
+{
+    /**
+     * @brief Evaluates 2D simplex noise for n samples
+     * @param perm Permutation table of 512 entries, see SimplexNoise
+     * @return False if the instruction set has no kernel or is not available
+     */
+    bool Noise2D(PerlinSIMD::ISA isa,
+                 const uint32_t* perm,
+                 const float* xs, const float* ys,
+                 float* out, size_t n);
+
+    /**
+     * @brief Evaluates 2D simplex noise for n samples given as skewed cells,
+     *  wrapped to [0,255] by the caller, and offsets from the cell origin
+     */
+    bool Noise2DSplit(PerlinSIMD::ISA isa,
+                      const uint32_t* perm,
+                      const int32_t* cellXs, const int32_t* cellYs,
+                      const float* xs, const float* ys,
+                      float* out, size_t n);
+
+} // namespace SimplexSIMD
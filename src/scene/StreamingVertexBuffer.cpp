@@ -0,0 +1,128 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "StreamingVertexBuffer.h"
+
+#include <cstring>
+
+#define SGL_PROFILE
+#include <SGL/SGL.h>
+
+
+static constexpr GLbitfield s_kMapFlags =
+    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+/** @brief Of the segment offsets, above the alignments drivers ask for */
+static constexpr size_t s_kSegmentAlignment = 256;
+static constexpr GLuint64 s_kWaitTimeout = 1000000;    ///< In ns, retried
+
+// =============================================================================
+
+StreamingVertexBuffer::StreamingVertexBuffer(uint32_t stride)
+    : m_Stride(stride)
+{
+    glCreateVertexArrays(1, &m_VertexArray);
+}
+
+StreamingVertexBuffer::~StreamingVertexBuffer()
+{
+    Release();
+    glDeleteVertexArrays(1, &m_VertexArray);
+}
+
+void StreamingVertexBuffer::SetAttribute(uint32_t location, int32_t components,
+                                         uint32_t offset)
+{
+    glEnableVertexArrayAttrib(m_VertexArray, location);
+    glVertexArrayAttribFormat(m_VertexArray, location, components, GL_FLOAT, GL_FALSE, offset);
+    glVertexArrayAttribBinding(m_VertexArray, location, 0);
+}
+
+void StreamingVertexBuffer::Upload(const void* data, size_t size)
+{
+    // Grown, or shrunk to a quarter, a fresh storage needs no fences
+    if (size > m_SegmentSize || size < m_SegmentSize / 4)
+        Reallocate(size);
+    else
+    {
+        // The draws from the current segment were all issued before
+        m_Fences[m_Segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_Segment = (m_Segment + 1) % SEGMENT_COUNT;
+        WaitForSegment(m_Segment);
+    }
+
+    if (m_Mapped == nullptr)
+        return;
+
+    const size_t kOffset = m_Segment * m_SegmentSize;
+    std::memcpy(m_Mapped + kOffset, data, size);
+    glVertexArrayVertexBuffer(m_VertexArray, 0, m_Buffer, static_cast<GLintptr>(kOffset),
+                              static_cast<GLsizei>(m_Stride));
+}
+
+void StreamingVertexBuffer::Bind() const
+{
+    glBindVertexArray(m_VertexArray);
+}
+
+void StreamingVertexBuffer::Reallocate(size_t size)
+{
+    Release();
+
+    m_SegmentSize = (size + s_kSegmentAlignment - 1) / s_kSegmentAlignment * s_kSegmentAlignment;
+    m_Segment = 0;
+    ++m_ReallocationCount;
+    if (m_SegmentSize == 0)
+        return;
+
+    const GLsizeiptr kSize = static_cast<GLsizeiptr>(m_SegmentSize * SEGMENT_COUNT);
+    glCreateBuffers(1, &m_Buffer);
+    glNamedBufferStorage(m_Buffer, kSize, nullptr, s_kMapFlags);
+    m_Mapped = static_cast<uint8_t*>(glMapNamedBufferRange(m_Buffer, 0, kSize, s_kMapFlags));
+}
+
+void StreamingVertexBuffer::Release()
+{
+    // Deleting the buffer waits for the draws from it, if the driver must
+    for (void*& fence : m_Fences)
+    {
+        if (fence != nullptr)
+            glDeleteSync(static_cast<GLsync>(fence));
+        fence = nullptr;
+    }
+
+    if (m_Buffer != 0)
+    {
+        glUnmapNamedBuffer(m_Buffer);
+        glDeleteBuffers(1, &m_Buffer);
+    }
+    m_Buffer = 0;
+    m_Mapped = nullptr;
+    m_SegmentSize = 0;
+}
+
+void StreamingVertexBuffer::WaitForSegment(uint32_t segment)
+{
+    void*& fence = m_Fences[segment];
+    if (fence == nullptr)
+        return;
+
+    const GLsync kFence = static_cast<GLsync>(fence);
+    GLenum status = glClientWaitSync(kFence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+        ++m_StallCount;
+
+        // The first wait flushes, so the fence is sure to be signaled
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        do
+        {
+            status = glClientWaitSync(kFence, flags, s_kWaitTimeout);
+            flags = 0;
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+
+    glDeleteSync(kFence);
+    fence = nullptr;
+}
@@ -0,0 +1,67 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * @brief Vertex buffer of immutable storage mapped once, persistently and
+ *  coherently, as a ring of segments with a vertex array of its own. Every
+ *  upload is written to the next segment once the GPU finished the draws
+ *  from it, see its fence, so the draws from the current segment never stall
+ *  the writer. The storage is only reallocated when the vertices outgrow it.
+ *  Needs OpenGL 4.5, on the thread of the context only.
+ */
+class StreamingVertexBuffer
+{
+public:
+    /** @brief Double buffered, a segment holds all the vertices of a terrain */
+    static constexpr uint32_t SEGMENT_COUNT = 2;
+
+    explicit StreamingVertexBuffer(uint32_t stride);
+    ~StreamingVertexBuffer();
+
+    StreamingVertexBuffer(const StreamingVertexBuffer&) = delete;
+    StreamingVertexBuffer& operator=(const StreamingVertexBuffer&) = delete;
+
+    /** @brief Float attribute of the shader location, offset in the vertex */
+    void SetAttribute(uint32_t location, int32_t components, uint32_t offset);
+
+    /** @brief Copies the vertices to the next segment and draws from it */
+    void Upload(const void* data, size_t size);
+
+    /** @brief Binds the vertex array, reading the segment of the last upload */
+    void Bind() const;
+
+    size_t GetSegmentSize() const { return m_SegmentSize; }
+    /** @return Uploads that waited for the GPU to release their segment */
+    uint32_t GetStallCount() const { return m_StallCount; }
+    uint32_t GetReallocationCount() const { return m_ReallocationCount; }
+
+private:
+    void Reallocate(size_t size);
+    void Release();
+    /** @brief Blocks until the draws issued before the segment's fence finished */
+    void WaitForSegment(uint32_t segment);
+
+private:
+    uint32_t m_Stride{ 0 };
+    uint32_t m_VertexArray{ 0 };
+    uint32_t m_Buffer{ 0 };
+    uint8_t* m_Mapped{ nullptr };
+
+    size_t m_SegmentSize{ 0 };
+    uint32_t m_Segment{ 0 };            ///< Drawn from
+
+    /** @brief Of the draws from each segment issued before it was left */
+    std::array<void*, SEGMENT_COUNT> m_Fences{};
+
+    uint32_t m_StallCount{ 0 };
+    uint32_t m_ReallocationCount{ 0 };
+};
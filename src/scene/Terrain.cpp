@@ -6,8 +6,11 @@
 #include "Terrain.h"
 
 #include <memory>
+#include <cstddef>
 #include <vector>
 #include <limits>
+#include <cstring>
+#include <algorithm>
 
 #include <glm/glm.hpp>
 #include <glm/gtx/string_cast.hpp>
@@ -15,10 +18,15 @@
 #define SGL_PROFILE
 #include <SGL/SGL.h>
 
+#include "JobSystem.h"
+#include "ResumableTask.h"
+#include "NormalSIMD.h"
+
 #define TRIANGLES_PER_QUAD 2
 #define INDICES_PER_TRIANGLE 3
 
 
+
 std::unique_ptr<Terrain> Terrain::CreateUniq(
     const glm::uvec2& size,
     const std::vector<float>& heightMap)
@@ -34,7 +42,7 @@ Terrain::Terrain(const glm::uvec2& size,
     : m_HeightMap(heightMap),
       m_Size(size)
 {
-    Generate();
+    GenerateMesh();
 }
 
 Terrain::~Terrain()
@@ -46,205 +54,453 @@ void Terrain::Generate()
 {
     SGL_PROFILE_SCOPE();
 
-    GenerateTexCoords();
-    GeneratePositions();
+    GenerateMesh();
+    UpdateVAO();
+}
+
+void Terrain::GenerateMesh()
+{
+    const uint64_t kVertexCount = GetVertexCount();
+    m_MemoryTraffic.clear();
+
+    // The indices only depend on the size, the next UpdateVAO acquires those
+    //  of a new one from the cache, generated unless another terrain has it
+    if (m_Size != m_MeshKey.size)
+        m_MemoryTraffic.push_back({ "Terrain index band", 0,
+                                    GridIndexBuffer::GetByteSize(m_Size, GetTopology()) });
 
-    if (m_UseFallOffMap)
+    GenerateVertices();
+    m_MemoryTraffic.push_back({ "Terrain vertices", kVertexCount * sizeof(float),
+                                kVertexCount * sizeof(Vertex) });
+
+    if (HasGradientMap())
     {
-        GenerateFallOffMap();
-        ApplyFallOffMap();
+        GenerateNormalsFromGradients({ { glm::uvec2(0), m_Size } });
+        m_MemoryTraffic.push_back({ "Terrain gradient normals",
+                                    kVertexCount * sizeof(glm::vec2),
+                                    kVertexCount * sizeof(Normal) });
+    }
+    else
+    {
+        // Every row of heights is copied out of the vertices once per task
+        GenerateNormalsGather();
+        m_MemoryTraffic.push_back({ "Terrain normal rows", kVertexCount * sizeof(float),
+                                    kVertexCount * sizeof(Normal) });
     }
 
-    GenerateIndices();
-    GenerateNormals();
-
-    UpdateVAO();
+    m_MeshKey = GetMeshKey();
 }
 
-void Terrain::GenerateTexCoords()
+void Terrain::GenerateMesh(const glm::ivec2& shift)
 {
-    SGL_PROFILE_SCOPE();
+    const glm::uvec2 kShift(glm::abs(shift));
+    if (!(GetMeshKey() == m_MeshKey) || m_Periodic ||
+        kShift.x >= m_Size.x || kShift.y >= m_Size.y)
+    {
+        GenerateMesh();
+        return;
+    }
 
-    const glm::uvec2 kSize = m_Size;
-    m_TexCoords.resize( GetVertexCount() );
+    // The face normals only depend on the height differences and the
+    //  vertices are whole units apart, so the moved normals are the computed
+    //  ones. The rest of the vertices is written again, as cheap as moving it.
+    ShiftMap(m_Vertices, m_Size, 1, shift);
+    GenerateVertices();
+
+    const uint64_t kVertexCount = GetVertexCount();
+    const MapRegion kKept = GetKeptRegion(m_Size, shift);
+    const uint64_t kKeptCount = static_cast<uint64_t>(kKept.end.x - kKept.begin.x) *
+                                (kKept.end.y - kKept.begin.y);
+    m_MemoryTraffic.clear();
+    m_MemoryTraffic.push_back({ "Terrain shift", kKeptCount * sizeof(Vertex),
+                                kKeptCount * sizeof(Vertex) });
+    m_MemoryTraffic.push_back({ "Terrain vertices", kVertexCount * sizeof(float),
+                                kVertexCount * sizeof(Vertex) });
+
+    const std::vector<MapRegion> kExposed = GetExposedRegions(m_Size, shift);
+    if (HasGradientMap())
+        GenerateNormalsFromGradients(kExposed);
+    else
+    {
+        // The kept vertices next to the exposed ones have new faces, the ones
+        //  moved onto the border lost the faces outside of the map
+        for (const MapRegion& kRegion : kExposed)
+            GenerateNormals({ glm::max(kRegion.begin, glm::uvec2(1)) - 1U,
+                              glm::min(kRegion.end + 1U, m_Size) });
+
+        GenerateNormals({ glm::uvec2(0), glm::uvec2(m_Size.x, 1) });
+        GenerateNormals({ glm::uvec2(0, m_Size.y - 1), m_Size });
+        GenerateNormals({ glm::uvec2(0), glm::uvec2(1, m_Size.y) });
+        GenerateNormals({ glm::uvec2(m_Size.x - 1, 0), m_Size });
+    }
+}
 
-    for (uint32_t y = 0; y < kSize.y; ++y)
-        for (uint32_t x = 0; x < kSize.x; ++x)
-        {
-            const uint32_t kIndex = y * kSize.x + x;
-            m_TexCoords[kIndex].x = x / static_cast<float>(kSize.x - 1);
-            m_TexCoords[kIndex].y = y / static_cast<float>(kSize.y - 1);
-        }
+void Terrain::CopySettings(const Terrain& other)
+{
+    m_TileScale = other.m_TileScale;
+    m_HeightScale = other.m_HeightScale;
+    m_Periodic = other.m_Periodic;
+    m_InstanceGrid = other.m_InstanceGrid;
+    m_VerticesPerTask = other.m_VerticesPerTask;
+    m_TriangleStrips = other.m_TriangleStrips;
+    m_UseFallOffMap = other.m_UseFallOffMap;
+    m_FallOffEdge0 = other.m_FallOffEdge0;
+    m_FallOffEdge1 = other.m_FallOffEdge1;
 }
 
-void Terrain::GeneratePositions()
+void Terrain::SwapMesh(Terrain& other)
 {
-    SGL_PROFILE_SCOPE();
+    std::swap(m_Size, other.m_Size);
+    m_Vertices.swap(other.m_Vertices);
+    m_MemoryTraffic.swap(other.m_MemoryTraffic);
 
-    const glm::vec2 kSize = m_Size;
+    std::swap(m_MeshKey, other.m_MeshKey);
+    std::swap(m_HeightMapVersion, other.m_HeightMapVersion);
+}
 
-    // Account for tile scaling
-    const glm::vec2 kWorldSize = GetWorldSize();
-    const glm::vec2 kCenterOffset = kWorldSize*0.5f;
+void Terrain::UseTriangleStrips(bool enabled)
+{
+    m_TriangleStrips = enabled;
+    if (m_Indices)
+        GenerateIndices();
+}
 
-    m_Positions.resize( GetVertexCount() );
+uint32_t Terrain::GetRowGrain() const
+{
+    return glm::max(m_VerticesPerTask / glm::max(m_Size.x, 1U), 1U);
+}
 
-    for (uint32_t y = 0; y < kSize.y; ++y)
-        for (uint32_t x = 0; x < kSize.x; ++x)
-        {
-            const uint32_t kIndex = y * kSize.x + x;
-            auto& position = m_Positions[kIndex];
+Terrain::MeshKey Terrain::GetMeshKey() const
+{
+    return {
+        m_Size,
+        m_Periodic,
+        HasGradientMap()
+    };
+}
 
-            position.x = m_TexCoords[kIndex].x * kWorldSize.x - kCenterOffset.x;
-            position.z = m_TexCoords[kIndex].y * kWorldSize.y - kCenterOffset.y;
-            position.y = GetHeightScaled(kIndex);
-        }
+bool Terrain::MeshKey::operator==(const MeshKey& other) const
+{
+    return size == other.size &&
+           periodic == other.periodic &&
+           gradients == other.gradients;
 }
 
-void Terrain::GenerateIndices()
+void Terrain::GenerateVertices()
 {
-    SGL_PROFILE_SCOPE();
+    const glm::uvec2 kSize = m_Size;
 
-    const glm::vec2 kSize = m_Size - 1U;
+    // One unit per vertex and the heights as they are, the vertex shader
+    //  scales them and applies the falloff
+    const glm::vec2 kCenterOffset = glm::vec2(kSize - 1U) * 0.5f;
 
-    m_Indices.resize(kSize.x*kSize.y *
-                     TRIANGLES_PER_QUAD*INDICES_PER_TRIANGLE);
+    // Kept when the size is, the shift moved the normals
+    m_Vertices.resize( GetVertexCount() );
 
-    uint32_t index = 0;
-    for (uint32_t y = 0; y < kSize.y; ++y)
-        for (uint32_t x = 0; x < kSize.x; ++x)
-        {
-            const uint32_t kVertexIndex = y * m_Size.x + x;
-            // Top triangle
-            m_Indices[index++] = kVertexIndex;
-            m_Indices[index++] = kVertexIndex + m_Size.x + 1;
-            m_Indices[index++] = kVertexIndex + 1;
-            // Bottom triangle
-            m_Indices[index++] = kVertexIndex;
-            m_Indices[index++] = kVertexIndex + m_Size.x;
-            m_Indices[index++] = kVertexIndex + m_Size.x + 1;
-        }
+    JobSystem::Get().ParallelFor("Terrain vertices", kSize.y, GetRowGrain(),
+                                 [&](uint32_t begin, uint32_t end) {
+        for (uint32_t y = begin; y < end; ++y)
+            for (uint32_t x = 0; x < kSize.x; ++x)
+            {
+                const uint32_t kIndex = y * kSize.x + x;
+                Vertex& vertex = m_Vertices[kIndex];
+
+                vertex.texCoord.x = x / static_cast<float>(kSize.x - 1);
+                vertex.texCoord.y = y / static_cast<float>(kSize.y - 1);
+
+                vertex.position.x = static_cast<float>(x) - kCenterOffset.x;
+                vertex.position.z = static_cast<float>(y) - kCenterOffset.y;
+                vertex.position.y = GetHeight(kIndex);
+            }
+    });
 }
 
-void Terrain::GenerateNormals()
+void Terrain::GenerateIndices()
 {
-    SGL_PROFILE_SCOPE();
-
-    m_Normals.resize( GetVertexCount(), Normal(0.0f) );
+    const GridIndexBuffer::Topology kTopology = GetTopology();
+    if (m_Indices && m_Indices->GetSize() == m_UploadedSize &&
+        m_Indices->GetTopology() == kTopology)
+        return;
 
-    const uint32_t kIndexCount = GetIndexCount();
-    SGL_ASSERT(kIndexCount % INDICES_PER_TRIANGLE == 0 )
+    bool generated = false;
+    m_Indices = GridIndexBuffer::Acquire(m_UploadedSize, kTopology, generated);
+}
 
-    for (uint32_t i = 0; i < kIndexCount; i += INDICES_PER_TRIANGLE)
+void Terrain::GenerateNormals()
+{
+    // Summed per triangle
+    for (Vertex& vertex : m_Vertices)
+        vertex.normal = Normal(0.0f);
+
+    // Summed in order on one thread, a resumable task may pause between
+    //  the rows
+    const uint32_t kRowGrain = GetRowGrain();
+    for (uint32_t y = 0; y + 1 < m_Size.y; ++y)
     {
-        const auto kIdx1 = m_Indices[i + 0];
-        const auto kIdx2 = m_Indices[i + 1];
-        const auto kIdx3 = m_Indices[i + 2];
-
-        const auto& v0 = m_Positions[kIdx1];
-        const auto& v1 = m_Positions[kIdx2];
-        const auto& v2 = m_Positions[kIdx3];
-
-        const Normal kNormal = glm::normalize(
-            glm::cross(v1 - v0, v2 - v0)
-        );
-
-        // Save for each vertex
-        m_Normals[kIdx1] += kNormal;
-        m_Normals[kIdx2] += kNormal;
-        m_Normals[kIdx3] += kNormal;
+        if (y % kRowGrain == 0 && y > 0)
+            ResumableTask::Yield("Terrain normals", static_cast<float>(y) / (m_Size.y - 1));
+
+        for (uint32_t x = 0; x + 1 < m_Size.x; ++x)
+        {
+            // The triangles of the quad as listed by GridIndexBuffer
+            const uint32_t kVertexIndex = y * m_Size.x + x;
+            const uint32_t kTriangles[TRIANGLES_PER_QUAD][INDICES_PER_TRIANGLE] = {
+                { kVertexIndex, kVertexIndex + m_Size.x + 1, kVertexIndex + 1 },
+                { kVertexIndex, kVertexIndex + m_Size.x, kVertexIndex + m_Size.x + 1 }
+            };
+
+            for (const auto& kTriangle : kTriangles)
+            {
+                const auto& v0 = m_Vertices[kTriangle[0]].position;
+                const auto& v1 = m_Vertices[kTriangle[1]].position;
+                const auto& v2 = m_Vertices[kTriangle[2]].position;
+
+                const Normal kNormal = glm::normalize(
+                    glm::cross(v1 - v0, v2 - v0)
+                );
+
+                // Save for each vertex
+                for (const uint32_t kIndex : kTriangle)
+                    m_Vertices[kIndex].normal += kNormal;
+            }
+        }
     }
 
+    SumPeriodicEdgeNormals();
+
     // Normalize each vertex normal
-    for (auto& normal : m_Normals)
-    {
-        normal = glm::normalize(normal);
-    }
+    JobSystem::Get().ParallelFor("Terrain normalize", GetVertexCount(), m_VerticesPerTask,
+                                 [this](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i)
+            m_Vertices[i].normal = glm::normalize(m_Vertices[i].normal);
+    });
 }
 
-void Terrain::UpdateVAO()
+void Terrain::GenerateNormalsGather()
 {
-    SGL_PROFILE_SCOPE();
-
-    const auto kVertexCount = GetVertexCount();
-    std::vector<Vertex> vertices(kVertexCount);
+    const glm::uvec2 kSize = m_Size;
 
-    for (size_t i = 0; i < kVertexCount; ++i)
+    // Grids without inner vertices only have borders
+    if (kSize.x > 2 && kSize.y > 2)
     {
-        vertices[i].position = m_Positions[i];
-        vertices[i].normal = m_Normals[i];
-        vertices[i].texCoord = m_TexCoords[i];
+        std::vector<float> xs(kSize.x), zs(kSize.y);
+        for (uint32_t x = 0; x < kSize.x; ++x)
+            xs[x] = m_Vertices[x].position.x;
+        for (uint32_t y = 0; y < kSize.y; ++y)
+            zs[y] = m_Vertices[y * kSize.x].position.z;
+
+        const PerlinSIMD::ISA kISA = std::min(PerlinSIMD::GetBestISA(), PerlinSIMD::ISA::AVX2);
+        const uint32_t kInner = kSize.x - 2;
+
+        JobSystem::Get().ParallelFor("Terrain normal rows", kSize.y - 2, GetRowGrain(),
+                                     [&](uint32_t begin, uint32_t end) {
+            // Heights of the rows above, of and below the vertices
+            std::vector<float> rows[3];
+            const auto kCopyRow = [&](std::vector<float>& row, uint32_t y) {
+                row.resize(kSize.x);
+                for (uint32_t x = 0; x < kSize.x; ++x)
+                    row[x] = m_Vertices[y * kSize.x + x].position.y;
+            };
+            kCopyRow(rows[0], begin);
+            kCopyRow(rows[1], begin + 1);
+
+            std::vector<float> normals(3 * kInner);
+            float* const kNormals[3] = { normals.data(), normals.data() + kInner,
+                                         normals.data() + 2 * kInner };
+
+            for (uint32_t y = begin + 1; y < end + 1; ++y)
+            {
+                kCopyRow(rows[2], y + 1);
+
+                const float kZs[3] = { zs[y - 1], zs[y], zs[y + 1] };
+                const float* const kRows[3] = { rows[0].data(), rows[1].data(), rows[2].data() };
+                if (NormalSIMD::RowNormals(kISA, xs.data(), kZs, kRows, kNormals, kInner))
+                {
+                    for (uint32_t i = 0; i < kInner; ++i)
+                        m_Vertices[y * kSize.x + 1 + i].normal =
+                            Normal(kNormals[0][i], kNormals[1][i], kNormals[2][i]);
+                }
+                else
+                    GenerateNormals({ glm::uvec2(1, y), glm::uvec2(kSize.x - 1, y + 1) });
+
+                std::swap(rows[0], rows[1]);
+                std::swap(rows[1], rows[2]);
+            }
+        });
     }
 
-    // TODO recreate or reallocate?
-
-    auto vbo = sgl::VertexBuffer::Create(
-        vertices.data(),
-        vertices.size() * sizeof(Vertex)
-    );
-
-    vbo->SetLayout({
-        { sgl::ElementType::Float3, "position" },
-        { sgl::ElementType::Float3, "normal" },
-        { sgl::ElementType::Float2, "texCoord" }
-    });
+    // The border vertices have fewer triangles, those of a periodic map also
+    //  the ones of the opposite border. The columns leave out the corners, so
+    //  none is normalized twice.
+    const MapRegion kBorders[] = {
+        { glm::uvec2(0), glm::uvec2(kSize.x, 1) },
+        { glm::uvec2(0, kSize.y - 1), kSize },
+        { glm::uvec2(0, 1), glm::uvec2(1, kSize.y - 1) },
+        { glm::uvec2(kSize.x - 1, 1), glm::uvec2(kSize.x, kSize.y - 1) }
+    };
+    for (const MapRegion& kBorder : kBorders)
+        SumNormals(kBorder);
+
+    SumPeriodicEdgeNormals();
+
+    for (const MapRegion& kBorder : kBorders)
+        for (uint32_t y = kBorder.begin.y; y < kBorder.end.y; ++y)
+            for (uint32_t x = kBorder.begin.x; x < kBorder.end.x; ++x)
+            {
+                Normal& normal = m_Vertices[y * kSize.x + x].normal;
+                normal = glm::normalize(normal);
+            }
+}
 
-    auto ibo = sgl::IndexBuffer::Create(
-        m_Indices.data(),
-        m_Indices.size()
-    );
+bool Terrain::CheckNormals()
+{
+    // The current normals stay
+    const std::vector<Vertex> kVertices = m_Vertices;
 
-    m_VAO.ClearVertexBuffers();
-    m_VAO.ClearIndexBuffer();
+    GenerateNormalsGather();
+    std::vector<Normal> gathered(m_Vertices.size());
+    for (size_t i = 0; i < m_Vertices.size(); ++i)
+        gathered[i] = m_Vertices[i].normal;
 
-    m_VAO.AddVertexBuffer(vbo);
-    m_VAO.SetIndexBuffer(ibo);
+    GenerateNormals();
+    bool identical = true;
+    for (size_t i = 0; i < m_Vertices.size(); ++i)
+        identical &= std::memcmp(&gathered[i], &m_Vertices[i].normal, sizeof(Normal)) == 0;
 
-    // TODO clear generated data
+    m_Vertices = kVertices;
+    return identical;
 }
 
-void Terrain::Render() const
+void Terrain::SumPeriodicEdgeNormals()
 {
-    m_VAO.Bind();
-
-    glDrawElements(GL_TRIANGLES,
-                   m_Indices.size(),
-                   GL_UNSIGNED_INT, 0);
+    // The edges of a periodic map are the same vertices, sum both sides,
+    //  the corners get all four after both passes
+    if (m_Periodic && m_Size.x > 1 && m_Size.y > 1)
+    {
+        for (uint32_t y = 0; y < m_Size.y; ++y)
+        {
+            const uint32_t kFirst = y * m_Size.x;
+            const uint32_t kLast = kFirst + m_Size.x - 1;
+            m_Vertices[kFirst].normal = m_Vertices[kLast].normal =
+                m_Vertices[kFirst].normal + m_Vertices[kLast].normal;
+        }
+        for (uint32_t x = 0; x < m_Size.x; ++x)
+        {
+            const uint32_t kLast = (m_Size.y - 1) * m_Size.x + x;
+            m_Vertices[x].normal = m_Vertices[kLast].normal =
+                m_Vertices[x].normal + m_Vertices[kLast].normal;
+        }
+    }
 }
 
-void Terrain::GenerateFallOffMap()
+void Terrain::GenerateNormals(const MapRegion& region)
 {
-    SGL_PROFILE_SCOPE();
+    SumNormals(region);
 
-    m_FallOffMap.resize(m_Size.x * m_Size.y);
+    for (uint32_t y = region.begin.y; y < region.end.y; ++y)
+        for (uint32_t x = region.begin.x; x < region.end.x; ++x)
+        {
+            Normal& normal = m_Vertices[y * m_Size.x + x].normal;
+            normal = glm::normalize(normal);
+        }
+}
 
-    for (uint32_t y = 0; y < m_Size.y; ++y)
-        for (uint32_t x = 0; x < m_Size.x; ++x)
+void Terrain::SumNormals(const MapRegion& region)
+{
+    const auto kInRegion = [&](uint32_t index) {
+        const uint32_t kX = index % m_Size.x;
+        const uint32_t kY = index / m_Size.x;
+        return kX >= region.begin.x && kX < region.end.x &&
+               kY >= region.begin.y && kY < region.end.y;
+    };
+
+    for (uint32_t y = region.begin.y; y < region.end.y; ++y)
+        for (uint32_t x = region.begin.x; x < region.end.x; ++x)
+            m_Vertices[y * m_Size.x + x].normal = Normal(0.0f);
+
+    // The quads around the region, row by row like the indices, so every
+    //  vertex sums its faces in the same order
+    const glm::uvec2 kQuadBegin = glm::max(region.begin, glm::uvec2(1)) - 1U;
+    const glm::uvec2 kQuadEnd = glm::min(region.end, m_Size - 1U);
+
+    for (uint32_t y = kQuadBegin.y; y < kQuadEnd.y; ++y)
+        for (uint32_t x = kQuadBegin.x; x < kQuadEnd.x; ++x)
         {
-            m_FallOffMap[y * m_Size.x + x] =
-                Smoothstep(m_FallOffEdge0,
-                           m_FallOffEdge1,
-                           glm::max(
-                            glm::abs(x / static_cast<float>(m_Size.x)*2.f-1.f),
-                            glm::abs(y / static_cast<float>(m_Size.y)*2.f-1.f)
-                           )
+            const uint32_t kVertexIndex = y * m_Size.x + x;
+            const uint32_t kTriangles[TRIANGLES_PER_QUAD][INDICES_PER_TRIANGLE] = {
+                { kVertexIndex, kVertexIndex + m_Size.x + 1, kVertexIndex + 1 },
+                { kVertexIndex, kVertexIndex + m_Size.x, kVertexIndex + m_Size.x + 1 }
+            };
+
+            for (const auto& kTriangle : kTriangles)
+            {
+                const auto& v0 = m_Vertices[kTriangle[0]].position;
+                const auto& v1 = m_Vertices[kTriangle[1]].position;
+                const auto& v2 = m_Vertices[kTriangle[2]].position;
+
+                const Normal kNormal = glm::normalize(
+                    glm::cross(v1 - v0, v2 - v0)
                 );
+
+                for (const uint32_t kIndex : kTriangle)
+                    if (kInRegion(kIndex))
+                        m_Vertices[kIndex].normal += kNormal;
+            }
         }
 }
 
-void Terrain::ApplyFallOffMap()
+void Terrain::GenerateNormalsFromGradients(const std::vector<MapRegion>& regions)
 {
-    SGL_PROFILE_SCOPE();
+    const auto& kGradientMap = *m_GradientMap;
 
-    for (uint32_t y = 0; y < m_Size.y; ++y)
-        for (uint32_t x = 0; x < m_Size.x; ++x)
+    const std::vector<MapRegion> kTiles = SplitTiles(regions, glm::uvec2(256));
+    JobSystem::Get().ParallelFor("Terrain gradient normals", static_cast<uint32_t>(kTiles.size()), 1,
+                                 [&](uint32_t begin, uint32_t end) {
+        for (uint32_t tile = begin; tile < end; ++tile)
         {
-            const uint32_t kIndex = y * m_Size.x + x;
-            m_Positions[kIndex].y =
-                glm::clamp(
-                    m_HeightMap[kIndex] - m_FallOffMap[kIndex],
-                    0.f,
-                    1.f)
-                * m_HeightScale;
+            const MapRegion& kTile = kTiles[tile];
+            for (uint32_t y = kTile.begin.y; y < kTile.end.y; ++y)
+                for (uint32_t x = kTile.begin.x; x < kTile.end.x; ++x)
+                {
+                    // Of the unscaled grid, vertices are one unit apart
+                    const uint32_t kIndex = y * m_Size.x + x;
+                    const glm::vec2 kGradient = kGradientMap[kIndex];
+
+                    m_Vertices[kIndex].normal = glm::normalize(
+                        Normal(-kGradient.x, 1.f, -kGradient.y)
+                    );
+                }
         }
-}
\ No newline at end of file
+    });
+}
+
+void Terrain::UpdateVAO()
+{
+    SGL_PROFILE_SCOPE();
+
+    if (!m_VertexBuffer)
+    {
+        m_VertexBuffer = std::make_unique<StreamingVertexBuffer>(sizeof(Vertex));
+        m_VertexBuffer->SetAttribute(0, 3, offsetof(Vertex, position));
+        m_VertexBuffer->SetAttribute(1, 3, offsetof(Vertex, normal));
+        m_VertexBuffer->SetAttribute(2, 2, offsetof(Vertex, texCoord));
+    }
+
+    // Already interleaved by the generation, the storage is kept
+    m_VertexBuffer->Upload(m_Vertices.data(), m_Vertices.size() * sizeof(Vertex));
+    m_UploadedSize = m_Size;
+
+    // Along with the vertices, the worker generating the next mesh changes
+    //  neither, see SwapMesh
+    GenerateIndices();
+    GridIndexBuffer::ReleaseUnused();
+}
+
+void Terrain::Render() const
+{
+    if (!m_Indices || !m_VertexBuffer)
+        return;
+
+    m_VertexBuffer->Bind();
+    m_Indices->Draw(m_InstanceGrid * m_InstanceGrid);
+}
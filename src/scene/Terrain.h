@@ -12,7 +12,9 @@
 
 #include <glm/glm.hpp>
 
-#include <SGL/opengl/VertexArray.h>
+#include "MapRegion.h"
+#include "GridIndexBuffer.h"
+#include "StreamingVertexBuffer.h"
 
 
 /**
@@ -26,7 +28,8 @@ public:
         const std::vector<float>& heightMap);
 public:
     /**
-     * @brief Generates vertices for rendering
+     * @brief Generates the vertices, uploaded for rendering by the first
+     *  UpdateVAO, so a terrain may be created without an OpenGL context
      * @param size Size in the X and Z axis, centered at the origin
      */
     Terrain(const glm::uvec2& size,
@@ -42,8 +45,92 @@ public:
     // TODO call it "Update?"
     void Generate();
 
+    /**
+     * @brief CPU part of Generate, builds the mesh data without touching
+     *  OpenGL or the SGL profiler, so it may run on a worker thread. The
+     *  mesh is drawn once uploaded by UpdateVAO.
+     */
+    void GenerateMesh();
+    /**
+     * @brief Generates the mesh for the height map moved by whole samples
+     *  since the last generation, height (x, y) being the previous one at
+     *  (x + shift.x, y + shift.y), see ProceduralTexture2D::GetValueShift.
+     *  The heights are written again, the normals are moved and computed
+     *  along the exposed edges only. Generates the whole mesh if the size
+     *  or the normal source changed or when periodic.
+     */
+    void GenerateMesh(const glm::ivec2& shift);
+    /**
+     * @brief Copies the vertices to the next segment of the persistently
+     *  mapped vertex buffer, see StreamingVertexBuffer, and acquires the
+     *  indices of their size. The indices are shared by the terrains of the
+     *  size and uploaded once, see GridIndexBuffer.
+     */
+    void UpdateVAO();
+    /**
+     * @brief Computes the normals from the heights of the mesh by the gather
+     *  and by the scatter over the triangles, the normals stay the current ones
+     * @return True if the normals are bitwise identical
+     */
+    bool CheckNormals();
+
+    /** @brief Copies all settings but the size, which belongs to the mesh */
+    void CopySettings(const Terrain& other);
+    /**
+     * @brief Exchanges the generated mesh data and its size with other, the
+     *  height maps stay bound to their terrains and the uploaded buffers
+     *  until the next UpdateVAO
+     */
+    void SwapMesh(Terrain& other);
+
+    /**
+     * @brief Tags the mesh with the version of the height map values it is
+     *  generated from, see ProceduralTexture2D::GetValueVersion
+     */
+    void SetHeightMapVersion(uint64_t version) { m_HeightMapVersion = version; }
+    uint64_t GetHeightMapVersion() const { return m_HeightMapVersion; }
+
+    /**
+     * @brief Lowers the heights towards the edges of the map. Applied by the
+     *  vertex shader like the tile and the height scale, the mesh is of the
+     *  unscaled grid, see ProceduralTerrain::Render
+     */
     void UseFallOffMap(bool enabled) { m_UseFallOffMap = enabled; }
 
+    /**
+     * @brief Sets the partial derivatives (d/dx, d/dy) of the height map per
+     *  sample. If set and of the same size as the height map, the normals are
+     *  computed from them directly, instead of averaging the face normals.
+     */
+    void SetGradientMap(const std::vector<glm::vec2>* gradientMap) {
+        m_GradientMap = gradientMap;
+    }
+
+    /**
+     * @brief Marks the height map as periodic, its last row and column repeat
+     *  the first ones. The normals of the edges then average the faces of
+     *  both sides, so tiles placed next to each other are shaded seamlessly.
+     */
+    void SetPeriodic(bool enabled) { m_Periodic = enabled; }
+
+    /**
+     * @brief Renders the tile count x count times with instancing, the
+     *  instances share the vertex and index buffers and are offset by the
+     *  world size in the vertex shader, see ProceduralTerrain::Render
+     */
+    void SetInstanceGrid(uint32_t count) { m_InstanceGrid = glm::max(count, 1U); }
+
+    /**
+     * @brief Draws the rows of quads as triangle strips with primitive
+     *  restart instead of a triangle list, the same triangles with a third of
+     *  the indices. Takes effect at once, the indices are cached per size.
+     *  On the thread of the context.
+     */
+    void UseTriangleStrips(bool enabled);
+
+    /** @brief Grain of the job system tasks, the mesh does not depend on it */
+    void SetVerticesPerTask(uint32_t count) { m_VerticesPerTask = glm::max(count, 1U); }
+
     // -------------------------------------------------------------------------
 
     /** @return Size of the terrain in X and Z coordinates */
@@ -61,12 +148,43 @@ public:
     float GetHeightScale() const { return m_HeightScale; }
 
     uint32_t GetVertexCount() const { return m_Size.x * m_Size.y; }
-    uint32_t GetIndexCount() const { return m_Indices.size(); }
-    uint32_t GetTriangleCount() const { return m_Indices.size() / 3; }
+    /** @return Indices drawn, most of them from the shared band of rows */
+    uint64_t GetIndexCount() const {
+        return m_Indices ? m_Indices->GetDrawnIndexCount() : 0;
+    }
+    uint32_t GetTriangleCount() const {
+        return m_Size.x > 1 && m_Size.y > 1 ? (m_Size.x - 1) * (m_Size.y - 1) * 2 : 0;
+    }
+    const GridIndexBuffer* GetIndexBuffer() const { return m_Indices.get(); }
+    /** @return Null until the first UpdateVAO */
+    const StreamingVertexBuffer* GetVertexBuffer() const { return m_VertexBuffer.get(); }
+    /**
+     * @return Size of the mesh of the last UpdateVAO, the one drawn. It lags
+     *  GetSize while the next size is generated.
+     */
+    glm::uvec2 GetUploadedSize() const { return m_UploadedSize; }
 
+    bool GetPeriodic() const { return m_Periodic; }
+    uint32_t GetInstanceGrid() const { return m_InstanceGrid; }
+    uint32_t GetVerticesPerTask() const { return m_VerticesPerTask; }
+    bool GetUseTriangleStrips() const { return m_TriangleStrips; }
+
+    bool GetUseFallOffMap() const { return m_UseFallOffMap; }
     float GetFallOffMapEdge0() const { return m_FallOffEdge0; }
     float GetFallOffMapEdge1() const { return m_FallOffEdge1; }
 
+    /**
+     * @brief Bytes a stage of the last mesh generation loaded and stored,
+     *  as issued by the kernel, before the caches
+     */
+    struct StageTraffic
+    {
+        const char* stage;
+        uint64_t bytesRead;
+        uint64_t bytesWritten;
+    };
+    const std::vector<StageTraffic>& GetMemoryTraffic() const { return m_MemoryTraffic; }
+
     // -------------------------------------------------------------------------
 
     void SetSize(const glm::vec2& size) { m_Size = size; }
@@ -80,9 +198,9 @@ private:
     using Position = glm::vec3;
     using Normal = glm::vec3;
     using TexCoord = glm::vec2;
-    using Index = uint32_t;
 
-    // Interleaved Data, might be better for the GPU
+    // Interleaved as uploaded, see UpdateVAO and the attributes of
+    //  shaders/Terrain.vert
     struct Vertex {
         Position position;
         Normal   normal;
@@ -98,53 +216,99 @@ private:
         return m_HeightMap[ glm::min(index, m_HeightMap.size()-1) ];
     }
 
-    inline float GetHeightScaled(size_t index) const
-    {
-        return GetHeight(index) * m_HeightScale;
-    }
-
-    // Generates values from top-left (0,0) to bottom right (1,1)
-    void GenerateTexCoords();
-    void GeneratePositions();
+    /**
+     * @brief Texture coordinates from top-left (0,0) to bottom right (1,1),
+     *  positions of the unscaled grid and heights in one pass over the
+     *  vertices
+     */
+    void GenerateVertices();
+    /**
+     * @brief Sums the normals of the triangles into their vertices in the
+     *  order of the triangle list, serially, the reference of
+     *  GenerateNormalsGather
+     */
     void GenerateNormals();
+    /**
+     * @brief Sums the six triangles around each vertex from the heights of
+     *  its neighbours, the rows across the workers and vectorized, see
+     *  NormalSIMD. Bitwise identical to GenerateNormals.
+     */
+    void GenerateNormalsGather();
+    /**
+     * @brief Normals of the vertices in the region, summed over the same
+     *  triangles in the same order as by GenerateNormals
+     */
+    void GenerateNormals(const MapRegion& region);
+    /** @brief GenerateNormals(region) without the normalization */
+    void SumNormals(const MapRegion& region);
+    /** @brief Adds the sums of the opposite edges of a periodic map */
+    void SumPeriodicEdgeNormals();
+    void GenerateNormalsFromGradients(const std::vector<MapRegion>& regions);
+    /**
+     * @brief Acquires the indices of the uploaded size and the topology
+     *  from the cache, on the thread of the context, see UpdateVAO
+     */
     void GenerateIndices();
-
-    void UpdateVAO();
+    GridIndexBuffer::Topology GetTopology() const {
+        return m_TriangleStrips ? GridIndexBuffer::Topology::TriangleStrips
+                                : GridIndexBuffer::Topology::Triangles;
+    }
+    /** @return Rows per task of the job system */
+    uint32_t GetRowGrain() const;
 
     void SetupColorRegions();
     void FillColorRegionSearchMap();
     void GenerateColorData();
 
-    void GenerateFallOffMap();
-    void ApplyFallOffMap();
-
-    constexpr float Smoothstep(float edge0, float edge1, float x) const {
-        float t = glm::clamp((x - edge0) / (edge1 - edge0), 0.f, 1.f);
-        return t * t * (3.f - 2.f * t);
+    bool HasGradientMap() const {
+        return m_GradientMap && m_GradientMap->size() == m_HeightMap.size();
     }
 
+    /**
+     * @brief Settings the mesh depends on, see GenerateMesh(shift), the
+     *  scales and the falloff are applied by the vertex shader
+     */
+    struct MeshKey
+    {
+        glm::uvec2 size{ 0 };
+        bool periodic{ false };
+        bool gradients{ false };
+
+        bool operator==(const MeshKey& other) const;
+    };
+    MeshKey GetMeshKey() const;
+
 private:
     const std::vector<float>& m_HeightMap;
+    const std::vector<glm::vec2>* m_GradientMap{ nullptr };
 
     glm::uvec2 m_Size{ 0 };
     float m_TileScale{ 1.0 }; // Scaling factor of X and Z coord (per tile)
     float m_HeightScale{ 1.0 }; // Scaling factor of Y coord, the height
+    bool m_Periodic{ false };
+    uint32_t m_InstanceGrid{ 1 };
+    uint32_t m_VerticesPerTask{ 65536 };
+    bool m_TriangleStrips{ true };
 
     // -------------------------------------------------------------------------
     // Data on CPU will be "batched"
     //  better for updating data, and in render, for e.g. collision detection
 
-    std::vector<Position> m_Positions;
-    std::vector<Normal> m_Normals;
-    std::vector<TexCoord> m_TexCoords;
-    std::vector<Index>  m_Indices;
+    std::vector<Vertex> m_Vertices;
+    std::vector<StageTraffic> m_MemoryTraffic;
+
+    MeshKey m_MeshKey;                  ///< Of the generated mesh
+    uint64_t m_HeightMapVersion{ 0 };
 
-    sgl::VertexArray m_VAO;
+    /** @brief Created by the first UpdateVAO, on the thread of the context */
+    std::unique_ptr<StreamingVertexBuffer> m_VertexBuffer;
+    glm::uvec2 m_UploadedSize{ 0 };     ///< Of the mesh drawn, see GetUploadedSize
+    /** @brief Of the uploaded size, shared with the terrains of the size */
+    std::shared_ptr<const GridIndexBuffer> m_Indices;
 
     // -------------------------------------------------------------------------
-    // Falloff map
+    // Falloff map, computed by the vertex shader
 
-    std::vector<float> m_FallOffMap;
     bool m_UseFallOffMap{ false };
 
     float m_FallOffEdge0{ 0.0 };
@@ -0,0 +1,503 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "WorleyNoiseSIMD.h"
+#include "ScratchBuffer.h"
+
+
+/**
+ * @brief Cellular noise, same interface as PerlinNoise.
+ *  Each lattice cell holds one jittered feature point, the value is computed
+ *  from the distances to the nearest and second nearest points in the 3x3
+ *  (3x3x3) neighbourhood of the sample: F1 gives plateaus and cells, F2 - F1
+ *  the cracks between them.
+ *  Steven Worley. A cellular texture basis function. SIGGRAPH 1996.
+ *  The cells wrap every 256 like the permutations of the lattice noises.
+ */
+template <typename T>
+class WorleyNoise
+{
+public:
+    using CellFunction = WorleySIMD::CellFunction;
+    using CellDistance = WorleySIMD::CellDistance;
+
+    WorleyNoise(int32_t seed = std::random_device{}())
+        : m_Seed(seed)
+    {
+        GeneratePermutations();
+    }
+
+    int32_t GetSeed() const { return m_Seed; }
+    /** @brief Just sets the seed, generate the permutations to see the diff. */
+    void SetSeed(int32_t seed) { m_Seed = seed; }
+
+    /**
+     * @brief Derives the hash seed of the feature points, there is no
+     *  permutation table, the name keeps the interface of the lattice noises
+     */
+    void GeneratePermutations()
+    {
+        m_HashSeed = Mix(static_cast<uint32_t>(m_Seed) * WorleySIMD::HASH_PRIME_Z);
+    }
+
+    CellFunction GetCellFunction() const { return m_Function; }
+    void SetCellFunction(CellFunction function) { m_Function = function; }
+    CellDistance GetCellDistance() const { return m_Distance; }
+    void SetCellDistance(CellDistance distance) { m_Distance = distance; }
+
+    /** @return Cellular 2D noise value, the distance clamped to 1 mapped to [-1,1] */
+    T Noise(T x, T y) const
+    {
+        const T kFloorX = glm::floor(x);
+        const T kFloorY = glm::floor(y);
+        return NoiseInCell((int32_t)kFloorX & 255, (int32_t)kFloorY & 255,
+                           x - kFloorX, y - kFloorY);
+    }
+
+    /**
+     * @return Cellular 2D noise value of the point at the fraction x,y within
+     *  the cell X,Y, wrapped to [0,255]
+     */
+    T NoiseInCell(int32_t X, int32_t Y, T x, T y) const
+    {
+        T f1 = FAR;
+        T f2 = FAR;
+        for (int32_t j = -1; j <= 1; ++j)
+            for (int32_t i = -1; i <= 1; ++i)
+            {
+                const uint32_t kHash = Hash((X + i) & 255, (Y + j) & 255);
+                const T dx = ((T)i + Jitter(kHash, 0)) - x;
+                const T dy = ((T)j + Jitter(kHash, 10)) - y;
+                const T d = Distance(dx, dy);
+
+                f2 = glm::min(f2, glm::max(f1, d));
+                f1 = glm::min(f1, d);
+            }
+
+        return Finish(f1, f2);
+    }
+
+    /**
+     * @return Cellular 2D noise value of the lattice wrapping every
+     *  periodX x periodY cells, see PerlinNoise::NoisePeriodic
+     */
+    T NoisePeriodic(T x, T y, T periodX, T periodY) const
+    {
+        const T kFloorX = glm::floor(x);
+        const T kFloorY = glm::floor(y);
+        const int32_t kPeriodX = (int32_t)periodX;
+        const int32_t kPeriodY = (int32_t)periodY;
+        const int32_t X = (((int32_t)kFloorX % kPeriodX) + kPeriodX) % kPeriodX;
+        const int32_t Y = (((int32_t)kFloorY % kPeriodY) + kPeriodY) % kPeriodY;
+        const T dx0 = x - kFloorX;
+        const T dy0 = y - kFloorY;
+
+        T f1 = FAR;
+        T f2 = FAR;
+        for (int32_t j = -1; j <= 1; ++j)
+            for (int32_t i = -1; i <= 1; ++i)
+            {
+                const uint32_t kHash = Hash(((X + i + kPeriodX) % kPeriodX) & 255,
+                                            ((Y + j + kPeriodY) % kPeriodY) & 255);
+                const T dx = ((T)i + Jitter(kHash, 0)) - dx0;
+                const T dy = ((T)j + Jitter(kHash, 10)) - dy0;
+                const T d = Distance(dx, dy);
+
+                f2 = glm::min(f2, glm::max(f1, d));
+                f1 = glm::min(f1, d);
+            }
+
+        return Finish(f1, f2);
+    }
+
+    /** @brief Evaluates out[i] = NoisePeriodic(xs[i], ys[i], periodX, periodY) */
+    void NoisePeriodicN(const T* xs, const T* ys, T periodX, T periodY,
+                        T* out, size_t n) const
+    {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = NoisePeriodic(xs[i], ys[i], periodX, periodY);
+    }
+
+    /** @return Cellular 3D noise value, see Noise */
+    T Noise(T x, T y, T z) const
+    {
+        const T kFloorX = glm::floor(x);
+        const T kFloorY = glm::floor(y);
+        const T kFloorZ = glm::floor(z);
+        return NoiseInCell((int32_t)kFloorX & 255, (int32_t)kFloorY & 255,
+                           (int32_t)kFloorZ & 255,
+                           x - kFloorX, y - kFloorY, z - kFloorZ);
+    }
+
+    /** @return Cellular 3D noise value within the cell X,Y,Z, 27 feature points */
+    T NoiseInCell(int32_t X, int32_t Y, int32_t Z, T x, T y, T z) const
+    {
+        T f1 = FAR;
+        T f2 = FAR;
+        for (int32_t k = -1; k <= 1; ++k)
+            for (int32_t j = -1; j <= 1; ++j)
+                for (int32_t i = -1; i <= 1; ++i)
+                {
+                    const uint32_t kHash = Hash((X + i) & 255, (Y + j) & 255,
+                                                (Z + k) & 255);
+                    const T dx = ((T)i + Jitter(kHash, 0)) - x;
+                    const T dy = ((T)j + Jitter(kHash, 10)) - y;
+                    const T dz = ((T)k + Jitter(kHash, 20)) - z;
+                    const T d = Distance(dx, dy, dz);
+
+                    f2 = glm::min(f2, glm::max(f1, d));
+                    f1 = glm::min(f1, d);
+                }
+
+        return Finish(f1, f2);
+    }
+
+    /**
+     * @brief Evaluates out[i] = Noise(xs[i], ys[i]) for n samples, for floats
+     *  by the SIMD kernel of the set instruction set, see WorleyNoiseSIMD.h
+     */
+    void NoiseN(const T* xs, const T* ys, T* out, size_t n) const
+    {
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (WorleySIMD::Noise2D(m_ISA, m_HashSeed, m_Function, m_Distance,
+                                    xs, ys, out, n))
+                return;
+        }
+
+        for (size_t i = 0; i < n; ++i)
+            out[i] = Noise(xs[i], ys[i]);
+    }
+
+    /**
+     * @brief Evaluates channelCount decorrelated 2D noises for n samples,
+     *  channel c is Noise(x + offsets[c], y), see PerlinNoise::NoiseChannelsN.
+     *  The lattice is not shared, each channel is a batch of its own.
+     * @param[out] out Planar, channel c at out + c*n
+     */
+    void NoiseChannelsN(const int32_t* offsets, uint32_t channelCount,
+                        const T* xs, const T* ys, T* out, size_t n) const
+    {
+        T* shiftedX = Scratch<T, 3>(n);
+        for (uint32_t c = 0; c < channelCount; ++c)
+        {
+            for (size_t i = 0; i < n; ++i)
+                shiftedX[i] = xs[i] + (T)offsets[c];
+            NoiseN(shiftedX, ys, out + c*n, n);
+        }
+    }
+
+    /** @brief Evaluates out[i] = Noise(xs[i], ys[i], zs[i]) for n samples */
+    void NoiseN(const T* xs, const T* ys, const T* zs, T* out, size_t n) const
+    {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = Noise(xs[i], ys[i], zs[i]);
+    }
+
+    /**
+     * @brief Evaluates out[i] = Noise(xs[i], ys[i]) for coordinates given in
+     *  double, split into cell and fraction, see PerlinNoise::NoiseSplitN
+     */
+    void NoiseSplitN(const double* xs, const double* ys, T* out, size_t n) const
+    {
+        int32_t* cellX = Scratch<int32_t, 0>(n);
+        int32_t* cellY = Scratch<int32_t, 1>(n);
+        T* fracX = Scratch<T, 0>(n);
+        T* fracY = Scratch<T, 1>(n);
+        SplitCoords(xs, cellX, fracX, n);
+        SplitCoords(ys, cellY, fracY, n);
+
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (WorleySIMD::Noise2DSplit(m_ISA, m_HashSeed, m_Function, m_Distance,
+                                         cellX, cellY, fracX, fracY, out, n))
+                return;
+        }
+
+        for (size_t i = 0; i < n; ++i)
+            out[i] = NoiseInCell(cellX[i], cellY[i], fracX[i], fracY[i]);
+    }
+
+    /** @brief 3D variant of NoiseSplitN, scalar only */
+    void NoiseSplitN(const double* xs, const double* ys, const double* zs,
+                     T* out, size_t n) const
+    {
+        int32_t* cellX = Scratch<int32_t, 0>(n);
+        int32_t* cellY = Scratch<int32_t, 1>(n);
+        int32_t* cellZ = Scratch<int32_t, 2>(n);
+        T* fracX = Scratch<T, 0>(n);
+        T* fracY = Scratch<T, 1>(n);
+        T* fracZ = Scratch<T, 2>(n);
+        SplitCoords(xs, cellX, fracX, n);
+        SplitCoords(ys, cellY, fracY, n);
+        SplitCoords(zs, cellZ, fracZ, n);
+
+        for (size_t i = 0; i < n; ++i)
+            out[i] = NoiseInCell(cellX[i], cellY[i], cellZ[i],
+                                 fracX[i], fracY[i], fracZ[i]);
+    }
+
+    /**
+     * @brief Evaluates out[i] = Noise(x0 + i*dx, y, z) for count samples,
+     *  expanded and evaluated by NoiseN
+     */
+    void NoiseRow(T y, T z, T x0, T dx, size_t count, T* out) const
+    {
+        T* xs = Scratch<T, 0>(count);
+        T* ys = Scratch<T, 1>(count);
+        T* zs = Scratch<T, 2>(count);
+        for (size_t i = 0; i < count; ++i)
+            xs[i] = x0 + (T)i * dx;
+        std::fill_n(ys, count, y);
+        std::fill_n(zs, count, z);
+        NoiseN(xs, ys, zs, out, count);
+    }
+
+    /** @brief Evaluates out[i] = Noise(x0 + i*dx, y) for count samples */
+    void NoiseRow(T y, T x0, T dx, size_t count, T* out) const
+    {
+        T* xs = Scratch<T, 0>(count);
+        T* ys = Scratch<T, 1>(count);
+        for (size_t i = 0; i < count; ++i)
+            xs[i] = x0 + (T)i * dx;
+        std::fill_n(ys, count, y);
+        NoiseN(xs, ys, out, count);
+    }
+
+    PerlinSIMD::ISA GetISA() const { return m_ISA; }
+    /** @brief Instruction sets without a kernel fall back to the scalar path */
+    void SetISA(PerlinSIMD::ISA isa) { m_ISA = isa; }
+
+    /**
+     * @return Cellular 2D noise value along with its partial derivatives,
+     *  x: value, y: d/dx, z: d/dy. The distance field is continuous but only
+     *  piecewise smooth, the derivatives jump across the Voronoi edges.
+     */
+    glm::vec<3, T> NoiseDeriv(T x, T y) const
+    {
+        const T kFloorX = glm::floor(x);
+        const T kFloorY = glm::floor(y);
+        const int32_t X = (int32_t)kFloorX & 255;
+        const int32_t Y = (int32_t)kFloorY & 255;
+        x -= kFloorX;
+        y -= kFloorY;
+
+        // Distances along with their gradients w.r.t. the sample position
+        glm::vec<3, T> f1(FAR, 0, 0);
+        glm::vec<3, T> f2(FAR, 0, 0);
+        for (int32_t j = -1; j <= 1; ++j)
+            for (int32_t i = -1; i <= 1; ++i)
+            {
+                const uint32_t kHash = Hash((X + i) & 255, (Y + j) & 255);
+                const glm::vec<2, T> d(((T)i + Jitter(kHash, 0)) - x,
+                                       ((T)j + Jitter(kHash, 10)) - y);
+                const glm::vec<2, T> kGrad = -DistanceGrad(d);
+                const glm::vec<3, T> kDist(Distance(d.x, d.y), kGrad.x, kGrad.y);
+
+                if (kDist.x < f1.x)
+                    { f2 = f1; f1 = kDist; }
+                else if (kDist.x < f2.x)
+                    f2 = kDist;
+            }
+
+        return FinishDeriv(f1, f2);
+    }
+
+    /** @return Cellular 3D noise value and derivatives, x: value, yzw: d/dx, d/dy, d/dz */
+    glm::vec<4, T> NoiseDeriv(T x, T y, T z) const
+    {
+        const T kFloorX = glm::floor(x);
+        const T kFloorY = glm::floor(y);
+        const T kFloorZ = glm::floor(z);
+        const int32_t X = (int32_t)kFloorX & 255;
+        const int32_t Y = (int32_t)kFloorY & 255;
+        const int32_t Z = (int32_t)kFloorZ & 255;
+        x -= kFloorX;
+        y -= kFloorY;
+        z -= kFloorZ;
+
+        glm::vec<4, T> f1(FAR, 0, 0, 0);
+        glm::vec<4, T> f2(FAR, 0, 0, 0);
+        for (int32_t k = -1; k <= 1; ++k)
+            for (int32_t j = -1; j <= 1; ++j)
+                for (int32_t i = -1; i <= 1; ++i)
+                {
+                    const uint32_t kHash = Hash((X + i) & 255, (Y + j) & 255,
+                                                (Z + k) & 255);
+                    const glm::vec<3, T> d(((T)i + Jitter(kHash, 0)) - x,
+                                           ((T)j + Jitter(kHash, 10)) - y,
+                                           ((T)k + Jitter(kHash, 20)) - z);
+                    const glm::vec<3, T> kGrad = -DistanceGrad(d);
+                    const glm::vec<4, T> kDist(Distance(d.x, d.y, d.z),
+                                               kGrad.x, kGrad.y, kGrad.z);
+
+                    if (kDist.x < f1.x)
+                        { f2 = f1; f1 = kDist; }
+                    else if (kDist.x < f2.x)
+                        f2 = kDist;
+                }
+
+        return FinishDeriv(f1, f2);
+    }
+
+private:
+    /** @brief Per thread scratch of the row and split paths, see GetScratchBuffer */
+    template <typename U, uint32_t Slot>
+    static U* Scratch(size_t n) { return GetScratchBuffer<U, WorleyNoise, Slot>(n); }
+
+    /** @brief Splits n lattice coordinates into wrapped cells and fractions */
+    void SplitCoords(const double* coords, int32_t* cells, T* fracs, size_t n) const
+    {
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (PerlinSIMD::SplitCoords(m_ISA, coords, cells, fracs, n))
+                return;
+        }
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double kFloor = std::floor(coords[i]);
+            cells[i] = static_cast<int32_t>(static_cast<int64_t>(kFloor) & 255);
+            fracs[i] = static_cast<T>(coords[i] - kFloor);
+        }
+    }
+
+    static uint32_t Mix(uint32_t h)
+    {
+        h *= WorleySIMD::HASH_MIX_0;
+        h ^= h >> 15;
+        h *= WorleySIMD::HASH_MIX_1;
+        return h ^ (h >> 12);
+    }
+
+    uint32_t Hash(uint32_t X, uint32_t Y) const
+    {
+        return Mix(m_HashSeed ^ (X * WorleySIMD::HASH_PRIME_X) ^ (Y * WorleySIMD::HASH_PRIME_Y));
+    }
+
+    uint32_t Hash(uint32_t X, uint32_t Y, uint32_t Z) const
+    {
+        return Mix(m_HashSeed ^ (X * WorleySIMD::HASH_PRIME_X) ^
+                   (Y * WorleySIMD::HASH_PRIME_Y) ^ (Z * WorleySIMD::HASH_PRIME_Z));
+    }
+
+    /** @return Position of the feature point within its cell, 10 bits of the hash */
+    static T Jitter(uint32_t hash, uint32_t shift)
+    {
+        return (T)(int32_t)((hash >> shift) & 1023) * (T)WorleySIMD::JITTER_SCALE +
+               (T)WorleySIMD::JITTER_BIAS;
+    }
+
+    /** @return Distance, squared for the Euclidean one */
+    T Distance(T dx, T dy) const
+    {
+        switch (m_Distance)
+        {
+        case CellDistance::Manhattan: return std::abs(dx) + std::abs(dy);
+        case CellDistance::Chebyshev: return glm::max(std::abs(dx), std::abs(dy));
+        default:                      return dx * dx + dy * dy;
+        }
+    }
+
+    T Distance(T dx, T dy, T dz) const
+    {
+        switch (m_Distance)
+        {
+        case CellDistance::Manhattan: return std::abs(dx) + std::abs(dy) + std::abs(dz);
+        case CellDistance::Chebyshev:
+            return glm::max(glm::max(std::abs(dx), std::abs(dy)), std::abs(dz));
+        default:                      return dx * dx + dy * dy + dz * dz;
+        }
+    }
+
+    /** @return Gradient of the distance w.r.t. the offset d, squared for Euclidean */
+    template <glm::length_t L>
+    glm::vec<L, T> DistanceGrad(const glm::vec<L, T>& d) const
+    {
+        switch (m_Distance)
+        {
+        case CellDistance::Manhattan:
+            return glm::sign(d);
+        case CellDistance::Chebyshev:
+        {
+            // Sign of the dominant axis only
+            glm::vec<L, T> grad(0);
+            glm::length_t axis = 0;
+            for (glm::length_t a = 1; a < L; ++a)
+                if (std::abs(d[a]) > std::abs(d[axis]))
+                    axis = a;
+            grad[axis] = glm::sign(d[axis]);
+            return grad;
+        }
+        default:
+            return (T)2 * d;
+        }
+    }
+
+    /** @brief Maps the distances to the cell function, clamped to 1, in [-1,1] */
+    T Finish(T f1, T f2) const
+    {
+        if (m_Distance == CellDistance::Euclidean)
+        {
+            f1 = std::sqrt(f1);
+            f2 = std::sqrt(f2);
+        }
+
+        const T kValue = m_Function == CellFunction::F1 ? f1
+                       : m_Function == CellFunction::F2 ? f2
+                       : f2 - f1;
+        return glm::min(kValue, (T)1) * (T)2 - (T)1;
+    }
+
+    /** @brief Derivative variant of Finish, x: distance, yz(w): its gradient */
+    template <typename Vec>
+    Vec FinishDeriv(Vec f1, Vec f2) const
+    {
+        if (m_Distance == CellDistance::Euclidean)
+        {
+            f1 = SqrtDeriv(f1);
+            f2 = SqrtDeriv(f2);
+        }
+
+        const Vec kValue = m_Function == CellFunction::F1 ? f1
+                         : m_Function == CellFunction::F2 ? f2
+                         : f2 - f1;
+        Vec result = kValue * (T)2;
+        if (kValue.x >= (T)1)
+            result = Vec(0);
+        result.x = glm::min(kValue.x, (T)1) * (T)2 - (T)1;
+        return result;
+    }
+
+    /** @return Square root of the squared distance, d sqrt(s) = ds / (2 sqrt(s)) */
+    template <typename Vec>
+    static Vec SqrtDeriv(const Vec& squared)
+    {
+        const T kDist = std::sqrt(squared.x);
+        Vec result = squared / ((T)2 * glm::max(kDist, (T)1e-6));
+        result.x = kDist;
+        return result;
+    }
+
+private:
+    static constexpr T FAR = (T)16;     ///< Larger than any distance in the neighbourhood
+
+    int32_t m_Seed{ 0 };
+    uint32_t m_HashSeed{ 0 };
+    CellFunction m_Function{ CellFunction::F1 };
+    CellDistance m_Distance{ CellDistance::Euclidean };
+
+    PerlinSIMD::ISA m_ISA{ PerlinSIMD::GetBestISA() };
+};
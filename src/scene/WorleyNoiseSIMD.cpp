@@ -0,0 +1,430 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "WorleyNoiseSIMD.h"
+
+#include <algorithm>
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+    #define WORLEY_SIMD_X86
+    #include <immintrin.h>
+#endif
+
+// Must match WorleyNoise<float>, larger than any distance in the neighbourhood
+#define WORLEY_FAR 16.0f
+
+#ifdef WORLEY_SIMD_X86
+
+#define TARGET_AVX2   __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+
+using WorleySIMD::CellFunction;
+using WorleySIMD::CellDistance;
+
+/**
+ * The kernels are instantiated per distance metric, the cell function only
+ *  selects the final value. Each kernel mirrors WorleyNoise::NoiseInCell,
+ *  the neighbours are visited in the same order.
+ */
+
+// =============================================================================
+// AVX2, 8 samples
+
+/** @brief Hash of the cells whose coordinates are premultiplied by the primes */
+TARGET_AVX2 static inline __m256i Hash8(__m256i seed, __m256i hx, __m256i hy)
+{
+    __m256i h = _mm256_xor_si256(_mm256_xor_si256(seed, hx), hy);
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(WorleySIMD::HASH_MIX_0)));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(WorleySIMD::HASH_MIX_1)));
+    return _mm256_xor_si256(h, _mm256_srli_epi32(h, 12));
+}
+
+/** @return Position of the feature point within its cell on one axis */
+template <int Shift>
+TARGET_AVX2 static inline __m256 Jitter8(__m256i hash)
+{
+    const __m256i kBits = _mm256_and_si256(_mm256_srli_epi32(hash, Shift),
+                                           _mm256_set1_epi32(1023));
+    return _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(kBits),
+                                       _mm256_set1_ps(WorleySIMD::JITTER_SCALE)),
+                         _mm256_set1_ps(WorleySIMD::JITTER_BIAS));
+}
+
+/** @return Distance, squared for the Euclidean one */
+template <CellDistance Distance>
+TARGET_AVX2 static inline __m256 Distance8(__m256 dx, __m256 dy)
+{
+    if constexpr (Distance == CellDistance::Euclidean)
+        return _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+
+    const __m256 kAbsMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 kAbsX = _mm256_and_ps(dx, kAbsMask);
+    const __m256 kAbsY = _mm256_and_ps(dy, kAbsMask);
+    if constexpr (Distance == CellDistance::Manhattan)
+        return _mm256_add_ps(kAbsX, kAbsY);
+    return _mm256_max_ps(kAbsX, kAbsY);
+}
+
+template <CellDistance Distance>
+TARGET_AVX2 static inline __m256 Noise2D8Cell(__m256i seed, CellFunction function,
+                                              __m256i X, __m256i Y,
+                                              __m256 x, __m256 y)
+{
+    const __m256i kMask = _mm256_set1_epi32(255);
+
+    // Premultiplied coordinates of the neighbouring columns and rows
+    __m256i hx[3], hy[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        const __m256i kOffset = _mm256_set1_epi32(i - 1);
+        hx[i] = _mm256_mullo_epi32(_mm256_and_si256(_mm256_add_epi32(X, kOffset), kMask),
+                                   _mm256_set1_epi32(static_cast<int>(WorleySIMD::HASH_PRIME_X)));
+        hy[i] = _mm256_mullo_epi32(_mm256_and_si256(_mm256_add_epi32(Y, kOffset), kMask),
+                                   _mm256_set1_epi32(static_cast<int>(WorleySIMD::HASH_PRIME_Y)));
+    }
+
+    __m256 f1 = _mm256_set1_ps(WORLEY_FAR);
+    __m256 f2 = _mm256_set1_ps(WORLEY_FAR);
+    for (int j = 0; j < 3; ++j)
+        for (int i = 0; i < 3; ++i)
+        {
+            const __m256i kHash = Hash8(seed, hx[i], hy[j]);
+            const __m256 dx = _mm256_sub_ps(
+                _mm256_add_ps(_mm256_set1_ps((float)(i - 1)), Jitter8<0>(kHash)), x);
+            const __m256 dy = _mm256_sub_ps(
+                _mm256_add_ps(_mm256_set1_ps((float)(j - 1)), Jitter8<10>(kHash)), y);
+            const __m256 d = Distance8<Distance>(dx, dy);
+
+            f2 = _mm256_min_ps(f2, _mm256_max_ps(f1, d));
+            f1 = _mm256_min_ps(f1, d);
+        }
+
+    if constexpr (Distance == CellDistance::Euclidean)
+    {
+        f1 = _mm256_sqrt_ps(f1);
+        f2 = _mm256_sqrt_ps(f2);
+    }
+
+    const __m256 kValue = function == CellFunction::F1 ? f1
+                        : function == CellFunction::F2 ? f2
+                        : _mm256_sub_ps(f2, f1);
+    return _mm256_sub_ps(_mm256_mul_ps(_mm256_min_ps(kValue, _mm256_set1_ps(1.f)),
+                                       _mm256_set1_ps(2.f)),
+                         _mm256_set1_ps(1.f));
+}
+
+template <CellDistance Distance>
+TARGET_AVX2 static void Noise2D_AVX2(uint32_t seed, CellFunction function,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    const __m256i kSeed = _mm256_set1_epi32(static_cast<int>(seed));
+    const __m256i kMask = _mm256_set1_epi32(255);
+    for (size_t i = 0; i < n; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        const __m256 kFloorX = _mm256_floor_ps(x);
+        const __m256 kFloorY = _mm256_floor_ps(y);
+        const __m256i X = _mm256_and_si256(_mm256_cvttps_epi32(kFloorX), kMask);
+        const __m256i Y = _mm256_and_si256(_mm256_cvttps_epi32(kFloorY), kMask);
+        x = _mm256_sub_ps(x, kFloorX);
+        y = _mm256_sub_ps(y, kFloorY);
+
+        _mm256_storeu_ps(out + i, Noise2D8Cell<Distance>(kSeed, function, X, Y, x, y));
+    }
+}
+
+template <CellDistance Distance>
+TARGET_AVX2 static void Noise2DSplit_AVX2(uint32_t seed, CellFunction function,
+    const int32_t* cellXs, const int32_t* cellYs,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    const __m256i kSeed = _mm256_set1_epi32(static_cast<int>(seed));
+    for (size_t i = 0; i < n; i += 8)
+    {
+        _mm256_storeu_ps(out + i, Noise2D8Cell<Distance>(
+            kSeed, function,
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cellXs + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cellYs + i)),
+            _mm256_loadu_ps(xs + i),
+            _mm256_loadu_ps(ys + i)));
+    }
+}
+
+// =============================================================================
+// AVX-512, 16 samples
+
+TARGET_AVX512 static inline __m512i Hash16(__m512i seed, __m512i hx, __m512i hy)
+{
+    __m512i h = _mm512_xor_si512(_mm512_xor_si512(seed, hx), hy);
+    h = _mm512_mullo_epi32(h, _mm512_set1_epi32(static_cast<int>(WorleySIMD::HASH_MIX_0)));
+    h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 15));
+    h = _mm512_mullo_epi32(h, _mm512_set1_epi32(static_cast<int>(WorleySIMD::HASH_MIX_1)));
+    return _mm512_xor_si512(h, _mm512_srli_epi32(h, 12));
+}
+
+template <int Shift>
+TARGET_AVX512 static inline __m512 Jitter16(__m512i hash)
+{
+    const __m512i kBits = _mm512_and_si512(_mm512_srli_epi32(hash, Shift),
+                                           _mm512_set1_epi32(1023));
+    return _mm512_add_ps(_mm512_mul_ps(_mm512_cvtepi32_ps(kBits),
+                                       _mm512_set1_ps(WorleySIMD::JITTER_SCALE)),
+                         _mm512_set1_ps(WorleySIMD::JITTER_BIAS));
+}
+
+template <CellDistance Distance>
+TARGET_AVX512 static inline __m512 Distance16(__m512 dx, __m512 dy)
+{
+    if constexpr (Distance == CellDistance::Euclidean)
+        return _mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy));
+
+    // AVX-512F has no float and, the sign is cleared on the integer view
+    const __m512i kAbsMask = _mm512_set1_epi32(0x7fffffff);
+    const __m512 kAbsX = _mm512_castsi512_ps(
+        _mm512_and_si512(_mm512_castps_si512(dx), kAbsMask));
+    const __m512 kAbsY = _mm512_castsi512_ps(
+        _mm512_and_si512(_mm512_castps_si512(dy), kAbsMask));
+    if constexpr (Distance == CellDistance::Manhattan)
+        return _mm512_add_ps(kAbsX, kAbsY);
+    return _mm512_max_ps(kAbsX, kAbsY);
+}
+
+template <CellDistance Distance>
+TARGET_AVX512 static inline __m512 Noise2D16Cell(__m512i seed, CellFunction function,
+                                                 __m512i X, __m512i Y,
+                                                 __m512 x, __m512 y)
+{
+    const __m512i kMask = _mm512_set1_epi32(255);
+
+    __m512i hx[3], hy[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        const __m512i kOffset = _mm512_set1_epi32(i - 1);
+        hx[i] = _mm512_mullo_epi32(_mm512_and_si512(_mm512_add_epi32(X, kOffset), kMask),
+                                   _mm512_set1_epi32(static_cast<int>(WorleySIMD::HASH_PRIME_X)));
+        hy[i] = _mm512_mullo_epi32(_mm512_and_si512(_mm512_add_epi32(Y, kOffset), kMask),
+                                   _mm512_set1_epi32(static_cast<int>(WorleySIMD::HASH_PRIME_Y)));
+    }
+
+    __m512 f1 = _mm512_set1_ps(WORLEY_FAR);
+    __m512 f2 = _mm512_set1_ps(WORLEY_FAR);
+    for (int j = 0; j < 3; ++j)
+        for (int i = 0; i < 3; ++i)
+        {
+            const __m512i kHash = Hash16(seed, hx[i], hy[j]);
+            const __m512 dx = _mm512_sub_ps(
+                _mm512_add_ps(_mm512_set1_ps((float)(i - 1)), Jitter16<0>(kHash)), x);
+            const __m512 dy = _mm512_sub_ps(
+                _mm512_add_ps(_mm512_set1_ps((float)(j - 1)), Jitter16<10>(kHash)), y);
+            const __m512 d = Distance16<Distance>(dx, dy);
+
+            f2 = _mm512_min_ps(f2, _mm512_max_ps(f1, d));
+            f1 = _mm512_min_ps(f1, d);
+        }
+
+    if constexpr (Distance == CellDistance::Euclidean)
+    {
+        f1 = _mm512_sqrt_ps(f1);
+        f2 = _mm512_sqrt_ps(f2);
+    }
+
+    const __m512 kValue = function == CellFunction::F1 ? f1
+                        : function == CellFunction::F2 ? f2
+                        : _mm512_sub_ps(f2, f1);
+    return _mm512_sub_ps(_mm512_mul_ps(_mm512_min_ps(kValue, _mm512_set1_ps(1.f)),
+                                       _mm512_set1_ps(2.f)),
+                         _mm512_set1_ps(1.f));
+}
+
+template <CellDistance Distance>
+TARGET_AVX512 static void Noise2D_AVX512(uint32_t seed, CellFunction function,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    const __m512i kSeed = _mm512_set1_epi32(static_cast<int>(seed));
+    const __m512i kMask = _mm512_set1_epi32(255);
+    for (size_t i = 0; i < n; i += 16)
+    {
+        __m512 x = _mm512_loadu_ps(xs + i);
+        __m512 y = _mm512_loadu_ps(ys + i);
+        const __m512 kFloorX = _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF);
+        const __m512 kFloorY = _mm512_roundscale_ps(y, _MM_FROUND_TO_NEG_INF);
+        const __m512i X = _mm512_and_si512(_mm512_cvttps_epi32(kFloorX), kMask);
+        const __m512i Y = _mm512_and_si512(_mm512_cvttps_epi32(kFloorY), kMask);
+        x = _mm512_sub_ps(x, kFloorX);
+        y = _mm512_sub_ps(y, kFloorY);
+
+        _mm512_storeu_ps(out + i, Noise2D16Cell<Distance>(kSeed, function, X, Y, x, y));
+    }
+}
+
+template <CellDistance Distance>
+TARGET_AVX512 static void Noise2DSplit_AVX512(uint32_t seed, CellFunction function,
+    const int32_t* cellXs, const int32_t* cellYs,
+    const float* xs, const float* ys, float* out, size_t n)
+{
+    const __m512i kSeed = _mm512_set1_epi32(static_cast<int>(seed));
+    for (size_t i = 0; i < n; i += 16)
+    {
+        _mm512_storeu_ps(out + i, Noise2D16Cell<Distance>(
+            kSeed, function,
+            _mm512_loadu_si512(cellXs + i),
+            _mm512_loadu_si512(cellYs + i),
+            _mm512_loadu_ps(xs + i),
+            _mm512_loadu_ps(ys + i)));
+    }
+}
+
+#endif // WORLEY_SIMD_X86
+
+// =============================================================================
+
+namespace WorleySIMD
+{
+
+using Kernel2D = void (*)(uint32_t, CellFunction, const float*, const float*,
+                          float*, size_t);
+
+#ifdef WORLEY_SIMD_X86
+/** @return Kernel of the instruction set instantiated for the distance */
+static Kernel2D SelectKernel2D(PerlinSIMD::ISA isa, CellDistance distance)
+{
+    using PerlinSIMD::ISA;
+    switch (isa)
+    {
+        case ISA::AVX2:
+            switch (distance)
+            {
+                case CellDistance::Manhattan: return Noise2D_AVX2<CellDistance::Manhattan>;
+                case CellDistance::Chebyshev: return Noise2D_AVX2<CellDistance::Chebyshev>;
+                default:                      return Noise2D_AVX2<CellDistance::Euclidean>;
+            }
+        case ISA::AVX512:
+            switch (distance)
+            {
+                case CellDistance::Manhattan: return Noise2D_AVX512<CellDistance::Manhattan>;
+                case CellDistance::Chebyshev: return Noise2D_AVX512<CellDistance::Chebyshev>;
+                default:                      return Noise2D_AVX512<CellDistance::Euclidean>;
+            }
+        default:
+            return nullptr;
+    }
+}
+#endif
+
+bool Noise2D(PerlinSIMD::ISA isa,
+             uint32_t seed, CellFunction function, CellDistance distance,
+             const float* xs, const float* ys,
+             float* out, size_t n)
+{
+#ifdef WORLEY_SIMD_X86
+    using PerlinSIMD::ISA;
+    if (isa == ISA::Scalar || isa > PerlinSIMD::GetBestISA())
+        return false;
+
+    const Kernel2D kernel = SelectKernel2D(isa, distance);
+    if (!kernel)
+        return false;
+
+    // Whole blocks of lanes, the tail goes through a zero padded block
+    const uint32_t kLanes = PerlinSIMD::GetLaneCount(isa);
+    const size_t kBlocked = n - n % kLanes;
+    if (kBlocked > 0)
+        kernel(seed, function, xs, ys, out, kBlocked);
+
+    const size_t kTail = n - kBlocked;
+    if (kTail == 0)
+        return true;
+
+    constexpr uint32_t kMaxLanes = 16;
+    float x[kMaxLanes]{}, y[kMaxLanes]{}, result[kMaxLanes];
+
+    std::copy_n(xs + kBlocked, kTail, x);
+    std::copy_n(ys + kBlocked, kTail, y);
+
+    kernel(seed, function, x, y, result, kLanes);
+
+    std::copy_n(result, kTail, out + kBlocked);
+    return true;
+#else
+    return false;
+#endif
+}
+
+using Kernel2DSplit = void (*)(uint32_t, CellFunction,
+                               const int32_t*, const int32_t*,
+                               const float*, const float*, float*, size_t);
+
+#ifdef WORLEY_SIMD_X86
+static Kernel2DSplit SelectKernel2DSplit(PerlinSIMD::ISA isa, CellDistance distance)
+{
+    using PerlinSIMD::ISA;
+    switch (isa)
+    {
+        case ISA::AVX2:
+            switch (distance)
+            {
+                case CellDistance::Manhattan: return Noise2DSplit_AVX2<CellDistance::Manhattan>;
+                case CellDistance::Chebyshev: return Noise2DSplit_AVX2<CellDistance::Chebyshev>;
+                default:                      return Noise2DSplit_AVX2<CellDistance::Euclidean>;
+            }
+        case ISA::AVX512:
+            switch (distance)
+            {
+                case CellDistance::Manhattan: return Noise2DSplit_AVX512<CellDistance::Manhattan>;
+                case CellDistance::Chebyshev: return Noise2DSplit_AVX512<CellDistance::Chebyshev>;
+                default:                      return Noise2DSplit_AVX512<CellDistance::Euclidean>;
+            }
+        default:
+            return nullptr;
+    }
+}
+#endif
+
+bool Noise2DSplit(PerlinSIMD::ISA isa,
+                  uint32_t seed, CellFunction function, CellDistance distance,
+                  const int32_t* cellXs, const int32_t* cellYs,
+                  const float* xs, const float* ys,
+                  float* out, size_t n)
+{
+#ifdef WORLEY_SIMD_X86
+    using PerlinSIMD::ISA;
+    if (isa == ISA::Scalar || isa > PerlinSIMD::GetBestISA())
+        return false;
+
+    const Kernel2DSplit kernel = SelectKernel2DSplit(isa, distance);
+    if (!kernel)
+        return false;
+
+    const uint32_t kLanes = PerlinSIMD::GetLaneCount(isa);
+    const size_t kBlocked = n - n % kLanes;
+    if (kBlocked > 0)
+        kernel(seed, function, cellXs, cellYs, xs, ys, out, kBlocked);
+
+    const size_t kTail = n - kBlocked;
+    if (kTail == 0)
+        return true;
+
+    constexpr uint32_t kMaxLanes = 16;
+    int32_t cellX[kMaxLanes]{}, cellY[kMaxLanes]{};
+    float x[kMaxLanes]{}, y[kMaxLanes]{}, result[kMaxLanes];
+
+    std::copy_n(cellXs + kBlocked, kTail, cellX);
+    std::copy_n(cellYs + kBlocked, kTail, cellY);
+    std::copy_n(xs + kBlocked, kTail, x);
+    std::copy_n(ys + kBlocked, kTail, y);
+
+    kernel(seed, function, cellX, cellY, x, y, result, kLanes);
+
+    std::copy_n(result, kTail, out + kBlocked);
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace WorleySIMD
@@ -0,0 +1,74 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "PerlinNoiseSIMD.h"
+
+
+/**
+ * @brief Vectorized batch kernel of the 2D cellular noise over 8 (AVX2) or
+ *  16 (AVX-512) samples. The feature points of the 3x3 neighbourhood are
+ *  hashed with integer arithmetic, no table lookups, and the operations mirror
+ *  WorleyNoise<float>::NoiseInCell, see PerlinSIMD for the error bound.
+ */
+namespace WorleySIMD
+{
+    /** @brief Value computed from the distances to the nearest feature points */
+    enum class CellFunction
+    {
+        F1 = 0,         ///< Distance to the nearest point
+        F2,             ///< Distance to the second nearest point
+        F2MinusF1,      ///< Cell borders, zero on the Voronoi edges
+    };
+
+    enum class CellDistance
+    {
+        Euclidean = 0,
+        Manhattan,
+        Chebyshev,
+    };
+
+    // Hash of a lattice cell, the primes decorrelate the axes, the
+    //  multiply-xorshift rounds mix the bits, shared with WorleyNoise
+    constexpr uint32_t HASH_PRIME_X = 0x8da6b343u;
+    constexpr uint32_t HASH_PRIME_Y = 0xd8163841u;
+    constexpr uint32_t HASH_PRIME_Z = 0xcb1ab31fu;
+    constexpr uint32_t HASH_MIX_0 = 0x27d4eb2du;
+    constexpr uint32_t HASH_MIX_1 = 0x2c1b3c6du;
+
+    /**
+     * @brief Feature points are jittered within the central 80 % of the cell,
+     *  so the 3x3 neighbourhood contains the nearest points except in rare
+     *  configurations, 10 bits of the hash per axis
+     */
+    constexpr float JITTER = 0.8f;
+    constexpr float JITTER_SCALE = JITTER / 1024.0f;
+    constexpr float JITTER_BIAS = (1.0f - JITTER) / 2.0f;
+
+    /**
+     * @brief Evaluates 2D cellular noise for n samples
+     * @param seed Hash seed, see WorleyNoise
+     * @return False if the instruction set has no kernel or is not available
+     */
+    bool Noise2D(PerlinSIMD::ISA isa,
+                 uint32_t seed, CellFunction function, CellDistance distance,
+                 const float* xs, const float* ys,
+                 float* out, size_t n);
+
+    /**
+     * @brief Evaluates 2D cellular noise for n samples given as lattice cells,
+     *  wrapped to [0,255] by the caller, and in-cell fractions in [0,1]
+     */
+    bool Noise2DSplit(PerlinSIMD::ISA isa,
+                      uint32_t seed, CellFunction function, CellDistance distance,
+                      const int32_t* cellXs, const int32_t* cellYs,
+                      const float* xs, const float* ys,
+                      float* out, size_t n);
+
+} // namespace WorleySIMD
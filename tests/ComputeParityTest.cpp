@@ -0,0 +1,136 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ *
+ *  The compute shader noise read back from NoiseComputeBackend against
+ *  FractalNoise<float>::NoiseN at the same integer positions. Runs in a
+ *  hidden window, on a software implementation like Mesa llvmpipe on
+ *  machines without a GPU, and is skipped without an OpenGL 4.5 context.
+ */
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <SGL/SGL.h>
+#include <GLFW/glfw3.h>
+
+#include "scene/NoiseCompute.h"
+#include "TestCheck.h"
+
+
+/**
+ * @brief Largest difference allowed, the shader evaluates the same float
+ *  operations, but the driver may contract them into FMA or reorder them.
+ *  About 16 steps of a 16-bit height.
+ */
+static constexpr float s_kMaxError = 2.5e-4f;
+
+struct ComputeCase
+{
+    const char* name;
+    uint32_t width, height;
+    int32_t seed;
+    uint32_t octaves;
+    float scale;
+    glm::vec2 offset;
+    float gain, lacunarity;
+    float precision, targetSpacing;
+};
+
+/** @brief Sizes that are not multiples of the group size and culled octaves */
+static const ComputeCase s_kCases[] = {
+    { "one octave", 100, 60, 1, 1, 37.0f, { 0.0f, 0.0f }, 0.5f, 2.0f, 0.0f, 0.0f },
+    { "eight octaves", 257, 129, 5, 8, 150.0f, { 0.0f, 0.0f }, 0.5f, 2.0f, 0.0f, 0.0f },
+    { "offset", 64, 64, 123456, 6, 90.0f, { -1234.0f, 5678.0f }, 0.45f, 2.1f, 0.0f, 0.0f },
+    { "culled", 200, 90, 7, 16, 60.0f, { 17.0f, -3.0f }, 0.5f, 2.0f,
+      1.0f / 65535.0f, 1.5f },
+};
+
+/** @return Largest difference of the case between the GPU and the CPU */
+static float CompareCase(NoiseComputeBackend& backend, const ComputeCase& kCase)
+{
+    FractalNoise<float> noise((PerlinNoise<float>(kCase.seed)));
+    noise.SetSeed(kCase.seed);
+    noise.basis = NoiseBasis::Perlin;
+    noise.octaveCount = kCase.octaves;
+    noise.scale = kCase.scale;
+    noise.offset = glm::vec3(kCase.offset, 0.0f);
+    noise.gain = kCase.gain;
+    noise.lacunarity = kCase.lacunarity;
+    noise.precision = kCase.precision;
+    noise.targetSpacing = kCase.targetSpacing;
+
+    std::string reason;
+    TEST_CHECK(NoiseComputeBackend::Supports(noise, reason), "%s: %s", kCase.name,
+               reason.c_str());
+
+    const size_t kCount = static_cast<size_t>(kCase.width) * kCase.height;
+    std::vector<float> gpu(kCount, -1.0f);
+    backend.Dispatch(noise, kCase.width, kCase.height, 0);
+    backend.ReadBack(gpu.data(), kCount);
+
+    std::vector<float> xs(kCase.width), ys(kCase.width), cpu(kCase.width);
+    for (uint32_t x = 0; x < kCase.width; ++x)
+        xs[x] = static_cast<float>(x);
+
+    float error = 0.0f;
+    for (uint32_t y = 0; y < kCase.height; ++y)
+    {
+        std::fill(ys.begin(), ys.end(), static_cast<float>(y));
+        noise.NoiseN(xs.data(), ys.data(), cpu.data(), kCase.width);
+
+        const float* kRow = &gpu[static_cast<size_t>(y) * kCase.width];
+        for (uint32_t x = 0; x < kCase.width; ++x)
+            error = std::max(error, std::abs(kRow[x] - cpu[x]));
+    }
+    return error;
+}
+
+int main()
+{
+    if (!glfwInit())
+    {
+        std::printf("Skipped, GLFW cannot be initialized\n");
+        return TEST_SKIPPED;
+    }
+
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    GLFWwindow* window = glfwCreateWindow(64, 64, "ComputeParityTest", nullptr, nullptr);
+    if (!window)
+    {
+        std::printf("Skipped, no OpenGL 4.5 context\n");
+        glfwTerminate();
+        return TEST_SKIPPED;
+    }
+    glfwMakeContextCurrent(window);
+    gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
+    std::printf("Renderer: %s\n", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+
+    {
+        NoiseComputeBackend backend;
+        std::string error;
+        const bool kReady = backend.Init(sgl::LoadTextFile(SHADERS_DIR "/FractalNoise.comp"),
+                                         error);
+        TEST_CHECK(kReady, "%s", error.c_str());
+
+        if (kReady)
+        {
+            for (const ComputeCase& kCase : s_kCases)
+            {
+                const float kError = CompareCase(backend, kCase);
+                TEST_CHECK(kError <= s_kMaxError, "%s, %ux%u: error %g, bound %g",
+                           kCase.name, kCase.width, kCase.height, kError, s_kMaxError);
+                std::printf("%s, %ux%u: max error %g\n", kCase.name, kCase.width,
+                            kCase.height, kError);
+            }
+        }
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return GetTestResult();
+}
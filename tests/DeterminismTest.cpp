@@ -0,0 +1,148 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ *
+ *  The CPU generation of the noise map is bitwise identical for every tile
+ *  size and worker count: the hashes of the values and of the channels and
+ *  the value range equal those of the serial whole map generation. The test
+ *  owns its process, it resizes the shared job system between the runs.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include <glm/glm.hpp>
+
+#include "JobSystem.h"
+#include "scene/ProceduralTexture2D.h"
+#include "TestCheck.h"
+
+
+using EvaluationMode = ProceduralTexture2D::EvaluationMode;
+using LayerCacheMode = ProceduralTexture2D::LayerCacheMode;
+using NoiseDimension = ProceduralTexture2D::NoiseDimension;
+
+struct DeterminismCase
+{
+    const char* name;
+    EvaluationMode evaluationMode;
+    NoiseBasis basis;
+    NoiseDimension dimension;
+    LayerCacheMode layerCacheMode;
+    bool periodic;
+    bool gradients;
+    bool channels;
+};
+
+static const DeterminismCase s_kCases[] = {
+    { "per sample", EvaluationMode::PerSample, NoiseBasis::Perlin, NoiseDimension::Noise2D,
+      LayerCacheMode::Off, false, false, false },
+    { "batch", EvaluationMode::Batch, NoiseBasis::Perlin, NoiseDimension::Noise2D,
+      LayerCacheMode::Off, false, false, false },
+    { "row", EvaluationMode::Row, NoiseBasis::Perlin, NoiseDimension::Noise2D,
+      LayerCacheMode::Off, false, false, false },
+    { "split", EvaluationMode::Split, NoiseBasis::Perlin, NoiseDimension::Noise2D,
+      LayerCacheMode::Off, false, false, false },
+    { "simplex", EvaluationMode::Batch, NoiseBasis::Simplex, NoiseDimension::Noise2D,
+      LayerCacheMode::Off, false, false, false },
+    { "worley 3D", EvaluationMode::Batch, NoiseBasis::Worley, NoiseDimension::Noise3D,
+      LayerCacheMode::Off, false, false, false },
+    { "float layer cache", EvaluationMode::Batch, NoiseBasis::Perlin, NoiseDimension::Noise2D,
+      LayerCacheMode::Float, false, false, false },
+    { "16-bit layer cache", EvaluationMode::Batch, NoiseBasis::Perlin, NoiseDimension::Noise2D,
+      LayerCacheMode::Quantized16, false, false, false },
+    { "periodic", EvaluationMode::Batch, NoiseBasis::Perlin, NoiseDimension::Noise2D,
+      LayerCacheMode::Off, true, false, false },
+    { "gradients", EvaluationMode::Batch, NoiseBasis::Perlin, NoiseDimension::Noise2D,
+      LayerCacheMode::Off, false, true, false },
+    { "channels", EvaluationMode::Batch, NoiseBasis::Perlin, NoiseDimension::Noise2D,
+      LayerCacheMode::Off, false, false, true },
+};
+
+static constexpr uint32_t s_kWidth = 301;
+static constexpr uint32_t s_kHeight = 173;
+
+/** @brief Single columns, odd sizes, the defaults and the whole map as one tile */
+static const glm::uvec2 s_kTileSizes[] = { { 1, 64 }, { 37, 5 }, { 256, 16 }, { 0, 0 },
+                                           { s_kWidth, s_kHeight } };
+
+struct MapHash
+{
+    uint64_t values;
+    uint64_t channels;
+    float min, max;
+
+    bool operator==(const MapHash& other) const {
+        return values == other.values && channels == other.channels &&
+               min == other.min && max == other.max;
+    }
+};
+
+/** @return FNV-1a hash of the bits, as ProceduralTexture2D::GetValueHash */
+static uint64_t HashValues(const std::vector<float>& values)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (const float kValue : values)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &kValue, sizeof(bits));
+        for (uint32_t i = 0; i < sizeof(bits); ++i)
+        {
+            hash ^= (bits >> (i * 8)) & 0xFF;
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+/** @brief A new map per run, the caches of a previous run are not reused */
+static MapHash GenerateMap(const DeterminismCase& kCase, const glm::uvec2& tileSize)
+{
+    ProceduralTexture2D map(s_kWidth, s_kHeight);
+    map.SetSeed(5);
+    map.SetScale(70.0f);
+    map.SetOctaves(7);
+    map.SetNoiseBasis(kCase.basis);
+    map.SetNoiseDimension(kCase.dimension);
+    map.SetEvaluationMode(kCase.evaluationMode);
+    map.SetLayerCacheMode(kCase.layerCacheMode);
+    map.SetPeriodic(kCase.periodic);
+    map.SetGenerateGradients(kCase.gradients);
+    map.SetGenerateChannels(kCase.channels);
+    map.SetTileSize(tileSize);
+    map.GenerateValues();
+
+    return { map.GetValueHash(), HashValues(map.GetChannelValues()),
+             map.GetMinValue(), map.GetMaxValue() };
+}
+
+int main()
+{
+    // More workers than cores, so that the tiles interleave on any machine
+    const uint32_t kWorkerCounts[] = { 0, 1, std::max(JobSystem::GetDefaultWorkerCount(), 4U) };
+
+    for (const DeterminismCase& kCase : s_kCases)
+    {
+        JobSystem::Get().SetWorkerCount(0);
+        const MapHash kReference = GenerateMap(kCase, glm::uvec2(s_kWidth, s_kHeight));
+
+        for (const uint32_t kWorkers : kWorkerCounts)
+        {
+            JobSystem::Get().SetWorkerCount(kWorkers);
+            for (const glm::uvec2& kTileSize : s_kTileSizes)
+            {
+                const MapHash kHash = GenerateMap(kCase, kTileSize);
+                TEST_CHECK(kHash == kReference,
+                           "%s, %u workers, tiles %ux%u: hash %016llx, reference %016llx",
+                           kCase.name, kWorkers, kTileSize.x, kTileSize.y,
+                           static_cast<unsigned long long>(kHash.values),
+                           static_cast<unsigned long long>(kReference.values));
+            }
+        }
+        std::printf("%s: hash %016llx\n", kCase.name,
+                    static_cast<unsigned long long>(kReference.values));
+    }
+
+    JobSystem::Get().SetWorkerCount(0);
+    return GetTestResult();
+}
@@ -0,0 +1,64 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ *
+ *  The normals gathered per vertex by the rows across the workers are
+ *  bitwise identical to those summed serially over the triangle list, see
+ *  Terrain::CheckNormals, for the inner vertices and the border rows and
+ *  columns. Needs no OpenGL context, the mesh is not uploaded.
+ */
+
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "JobSystem.h"
+#include "scene/ProceduralTexture2D.h"
+#include "scene/Terrain.h"
+#include "TestCheck.h"
+
+
+/**
+ * @brief Grids of borders only, of a single inner row or column, odd sizes
+ *  and sizes beyond a vector of the widest instruction set
+ */
+static const glm::uvec2 s_kSizes[] = { { 2, 2 }, { 3, 3 }, { 2, 9 }, { 9, 2 }, { 3, 17 },
+                                       { 17, 3 }, { 65, 33 }, { 301, 173 }, { 256, 256 } };
+
+/** @brief One task per row and the default grain */
+static const uint32_t s_kVerticesPerTask[] = { 1, 65536 };
+
+int main()
+{
+    // More workers than cores, so that the rows interleave on any machine
+    const uint32_t kWorkerCounts[] = { 0, std::max(JobSystem::GetDefaultWorkerCount(), 4U) };
+
+    for (const uint32_t kWorkers : kWorkerCounts)
+    {
+        JobSystem::Get().SetWorkerCount(kWorkers);
+        for (const glm::uvec2& kSize : s_kSizes)
+            for (const bool kPeriodic : { false, true })
+            {
+                ProceduralTexture2D map(kSize.x, kSize.y);
+                map.SetSeed(5);
+                map.SetScale(20.0f);
+                map.SetOctaves(6);
+                map.SetPeriodic(kPeriodic);
+                map.GenerateValues();
+
+                Terrain terrain(kSize, map.GetValues());
+                terrain.SetPeriodic(kPeriodic);
+                for (const uint32_t kVertices : s_kVerticesPerTask)
+                {
+                    terrain.SetVerticesPerTask(kVertices);
+                    terrain.GenerateMesh();
+                    TEST_CHECK(terrain.CheckNormals(),
+                               "%ux%u, periodic %d, %u workers, %u vertices per task",
+                               kSize.x, kSize.y, kPeriodic, kWorkers, kVertices);
+                }
+            }
+    }
+
+    JobSystem::Get().SetWorkerCount(0);
+    return GetTestResult();
+}
@@ -0,0 +1,96 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ *
+ *  The batch noise of every instruction set the CPU supports against the
+ *  scalar PerlinNoise<float>::Noise, within PERLIN_SIMD_MAX_ERROR.
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "scene/PerlinNoise.h"
+#include "TestCheck.h"
+
+
+// Below, at and above the lane counts, for the tails of the kernels
+static const size_t s_kLengths[] = { 0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33,
+                                     47, 63, 64, 65, 100, 1023, 4099 };
+static constexpr float s_kSentinel = 1234.5f;
+
+/** @brief Both signs, whole numbers on the cell borders and large offsets */
+static std::vector<float> GenerateCoords(std::default_random_engine& engine, size_t n)
+{
+    std::uniform_real_distribution<float> small(-300.0f, 300.0f);
+    std::uniform_real_distribution<float> large(-70000.0f, 70000.0f);
+    std::vector<float> coords(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        switch (i % 4)
+        {
+            case 0: coords[i] = small(engine); break;
+            case 1: coords[i] = std::floor(small(engine)); break;
+            case 2: coords[i] = large(engine); break;
+            default: coords[i] = small(engine) * 0.01f; break;
+        }
+    }
+    return coords;
+}
+
+/** @return Largest difference, the writes past n fail the check */
+static float CheckBatch(const PerlinNoise<float>& noise, size_t n, bool is3D,
+                        std::default_random_engine& engine)
+{
+    const std::vector<float> kXs = GenerateCoords(engine, n);
+    const std::vector<float> kYs = GenerateCoords(engine, n);
+    const std::vector<float> kZs = GenerateCoords(engine, n);
+
+    std::vector<float> out(n + 1, s_kSentinel);
+    if (is3D)
+        noise.NoiseN(kXs.data(), kYs.data(), kZs.data(), out.data(), n);
+    else
+        noise.NoiseN(kXs.data(), kYs.data(), out.data(), n);
+    TEST_CHECK(out[n] == s_kSentinel, "%s, %zu samples, wrote past the end",
+               PerlinSIMD::GetISAName(noise.GetISA()), n);
+
+    float error = 0.0f;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const float kScalar = is3D ? noise.Noise(kXs[i], kYs[i], kZs[i])
+                                   : noise.Noise(kXs[i], kYs[i]);
+        error = std::max(error, std::abs(out[i] - kScalar));
+    }
+    return error;
+}
+
+int main()
+{
+    std::default_random_engine engine(7);
+
+    const int kBest = static_cast<int>(PerlinSIMD::GetBestISA());
+    for (int isa = static_cast<int>(PerlinSIMD::ISA::Scalar); isa <= kBest; ++isa)
+    {
+        const PerlinSIMD::ISA kISA = static_cast<PerlinSIMD::ISA>(isa);
+        for (const int32_t kSeed : { 1, 5, 123456 })
+        {
+            PerlinNoise<float> noise(kSeed);
+            noise.SetISA(kISA);
+
+            float error = 0.0f;
+            for (const size_t kLength : s_kLengths)
+                for (const bool kIs3D : { false, true })
+                {
+                    const float kError = CheckBatch(noise, kLength, kIs3D, engine);
+                    TEST_CHECK(kError <= PerlinSIMD::PERLIN_SIMD_MAX_ERROR,
+                               "%s, seed %d, %zu samples, %s: error %g",
+                               PerlinSIMD::GetISAName(kISA), kSeed, kLength,
+                               kIs3D ? "3D" : "2D", kError);
+                    error = std::max(error, kError);
+                }
+            std::printf("%s, seed %d: max error %g, bound %g\n", PerlinSIMD::GetISAName(kISA),
+                        kSeed, error, PerlinSIMD::PERLIN_SIMD_MAX_ERROR);
+        }
+    }
+    return GetTestResult();
+}
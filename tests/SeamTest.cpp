@@ -0,0 +1,68 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ *
+ *  Periodic noise maps with the default period repeat their first row and
+ *  column at the opposite edges exactly, GetSeamError is 0.
+ */
+
+#include <glm/glm.hpp>
+
+#include "scene/ProceduralTexture2D.h"
+#include "TestCheck.h"
+
+
+static const char* s_kBasisNames[] = { "Perlin", "Simplex", "Worley" };
+
+/** @return Seam error of a map of the size and settings */
+static float GenerateSeamError(const glm::uvec2& size, NoiseBasis basis, bool periodic,
+                               int octaves, float scale, const glm::vec3& offset,
+                               const glm::uvec2& tileSize)
+{
+    ProceduralTexture2D map(size.x, size.y);
+    map.SetSeed(5);
+    map.SetNoiseBasis(basis);
+    map.SetOctaves(octaves);
+    map.SetScale(scale);
+    map.SetOffset(offset);
+    map.SetTileSize(tileSize);
+    map.SetPeriodic(periodic);
+    map.GenerateValues();
+    return map.GetSeamError();
+}
+
+int main()
+{
+    // Odd sizes and scales that do not divide the period, tiles of whole
+    //  rows and tiles that split the rows
+    const glm::uvec2 kSizes[] = { { 2, 2 }, { 65, 33 }, { 256, 256 }, { 301, 173 } };
+    const glm::uvec2 kTileSizes[] = { { 0, 0 }, { 37, 5 } };
+    const glm::vec3 kOffsets[] = { glm::vec3(0.0f), glm::vec3(1234.5f, -77.25f, 0.0f) };
+
+    for (const NoiseBasis kBasis : { NoiseBasis::Perlin, NoiseBasis::Simplex,
+                                     NoiseBasis::Worley })
+        for (const glm::uvec2& kSize : kSizes)
+            for (const glm::uvec2& kTileSize : kTileSizes)
+                for (const glm::vec3& kOffset : kOffsets)
+                    for (const int kOctaves : { 1, 6 })
+                        for (const float kScale : { 17.3f, 90.0f })
+                        {
+                            const float kError = GenerateSeamError(kSize, kBasis, true,
+                                                                   kOctaves, kScale, kOffset,
+                                                                   kTileSize);
+                            TEST_CHECK(kError == 0.0f,
+                                       "%s, %ux%u, tiles %ux%u, offset %g, %d octaves, "
+                                       "scale %g: seam error %g",
+                                       s_kBasisNames[static_cast<int>(kBasis)],
+                                       kSize.x, kSize.y, kTileSize.x, kTileSize.y,
+                                       kOffset.x, kOctaves, kScale, kError);
+                        }
+
+    // The check can fail, the edges of a plain map differ
+    const float kPlainError = GenerateSeamError(glm::uvec2(256, 256), NoiseBasis::Perlin,
+                                                false, 6, 90.0f, glm::vec3(0.0f),
+                                                glm::uvec2(0, 0));
+    TEST_CHECK(kPlainError > 0.0f, "non-periodic map: seam error %g", kPlainError);
+
+    return GetTestResult();
+}
@@ -0,0 +1,41 @@
+/**
+ *  Copyright (c) 2022 ProceduralTerrain authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdio>
+
+
+/** @brief Exit code of a test ctest reports as skipped */
+constexpr int TEST_SKIPPED = 77;
+
+/** @return Checks failed so far, the exit code of the test */
+inline int& GetFailedCheckCount()
+{
+    static int s_Count = 0;
+    return s_Count;
+}
+
+/** @brief Reports the condition if false, the test goes on */
+#define TEST_CHECK(condition, ...)                                          \
+    do                                                                      \
+    {                                                                       \
+        if (!(condition))                                                   \
+        {                                                                   \
+            std::fprintf(stderr, "%s:%d: %s failed: ", __FILE__, __LINE__,  \
+                         #condition);                                       \
+            std::fprintf(stderr, __VA_ARGS__);                              \
+            std::fprintf(stderr, "\n");                                     \
+            ++GetFailedCheckCount();                                        \
+        }                                                                   \
+    } while (0)
+
+/** @return Exit code of the test */
+inline int GetTestResult()
+{
+    if (GetFailedCheckCount() == 0)
+        std::printf("All checks passed\n");
+    return GetFailedCheckCount() == 0 ? 0 : 1;
+}